@@ -0,0 +1,76 @@
+//Buffer library by Huynh Hoang Kha
+//Coroutine pipelines benchmark: many producer -> QueueArrayBuffer -> consumer pairs on one EventLoop thread
+//The queues are small, so producers and consumers keep suspending on each other instead of spinning.
+//A plain enQueue/deQueue loop over one queue gives the cost without coroutines. Every consumer checks its sum.
+//Usage: AsyncQueueBenchmark [pipelines] [valuesPerPipeline] [queueCapacity]
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include "../Buffer/AsyncQueueBuffer.h"
+using namespace std;
+
+#ifdef BUFFER_HAS_COROUTINES
+static BufferTask produce(QueueArrayBuffer& queue, int count) {
+	for (int i = 0; i < count; i++) co_await queue.enQueueAsync<int>(i);
+}
+
+static BufferTask consume(QueueArrayBuffer& queue, int count, long long* sum) {
+	for (int i = 0; i < count; i++) *sum += co_await queue.deQueueAsync<int>();
+}
+
+static void report(const char* mode, chrono::steady_clock::time_point start, long long values) {
+	double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+	printf("%-22s %10.3f %12.2f\n", mode, seconds * 1e3, values / seconds / 1e6);
+}
+
+int main(int argc, char** argv) {
+	int pipelines = argc > 1 ? atoi(argv[1]) : 10000;
+	int count = argc > 2 ? atoi(argv[2]) : 1000;
+	int capacity = argc > 3 ? atoi(argv[3]) : 64;
+	if (pipelines < 1) pipelines = 1;
+	if (capacity < (int)sizeof(int)) capacity = sizeof(int);
+	long long total = (long long)pipelines * count, expected = (long long)count * (count - 1) / 2;
+	printf("%d pipelines of %d ints, queues of %d bytes\n", pipelines, count, capacity);
+	printf("%-22s %10s %12s\n", "mode", "ms", "Mvalues/s");
+
+	QueueArrayBuffer plain(capacity, HOST_ENDIAN);
+	long long plainSum = 0;
+	int value = 0;
+	auto start = chrono::steady_clock::now();
+	for (long long i = 0; i < total; i++) {
+		plain.enQueueInt((int)(i % count));
+		plain.deQueueInt(&value);
+		plainSum += value;
+	}
+	report("plain loop", start, total);
+	if (plainSum != expected * pipelines) {
+		printf("plain loop: wrong sum\n");
+		return 1;
+	}
+
+	EventLoop loop;
+	vector<QueueArrayBuffer> queues;
+	queues.reserve(pipelines);
+	for (int p = 0; p < pipelines; p++) queues.emplace_back(capacity, HOST_ENDIAN);
+	vector<long long> sums(pipelines, 0);
+	start = chrono::steady_clock::now();
+	for (int p = 0; p < pipelines; p++) {
+		loop.spawn(consume(queues[p], count, &sums[p]));
+		loop.spawn(produce(queues[p], count));
+	}
+	loop.run();
+	report("coroutine pipelines", start, total);
+	for (int p = 0; p < pipelines; p++) {
+		if (sums[p] == expected) continue;
+		printf("pipeline %d: wrong sum %lld instead of %lld\n", p, sums[p], expected);
+		return 1;
+	}
+	return 0;
+}
+#else
+int main() {
+	printf("AsyncQueueBenchmark needs a C++20 compiler with coroutines on Linux\n");
+	return 0;
+}
+#endif
@@ -0,0 +1,63 @@
+//Buffer library by Huynh Hoang Kha
+//Column decode benchmark: read every int and every double stored in an ArrayBuffer
+//getInt/getDouble one value at a time against getInts/getDoubles with each byte swap implementation
+//Every mode checks the values it reads back.
+//Usage: BatchedAccessBenchmark [values] [rounds]
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include "../Buffer/Buffer.h"
+using namespace std;
+
+static void check(bool ok, const char* mode) {
+	if (ok) return;
+	printf("%s: wrong value read back\n", mode);
+	exit(1);
+}
+
+static void report(const char* mode, chrono::steady_clock::time_point start, long long values, int valueSize) {
+	double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+	printf("%-22s %10.3f %12.1f\n", mode, seconds * 1e9 / values, values * valueSize / seconds / (1024.0 * 1024.0));
+}
+
+template <typename T>
+static void runColumn(const char* name, int count, int rounds) {
+	vector<T> values(count), output(count);
+	for (int i = 0; i < count; i++) values[i] = (T)(i * 2654435761u % 1000003) / (T)3;
+	//LITTLE_ENDIAN buffers store big endian data, so every read is a byte swap
+	vector<uint8_t> storage(count * sizeof(T));
+	ArrayBuffer buffer(storage.data(), (int)storage.size(), (int)storage.size(), LITTLE_ENDIAN, BORROW_MEMORY);
+	check(buffer.writePrimities(0, values.data(), count), name);
+	long long total = (long long)count * rounds;
+	char mode[64];
+
+	auto start = chrono::steady_clock::now();
+	for (int r = 0; r < rounds; r++) {
+		for (int i = 0; i < count; i++) check(buffer.getPrimity(i * (int)sizeof(T), &output[i]), name);
+		check(output == values, name);
+	}
+	snprintf(mode, sizeof(mode), "%s one by one", name);
+	report(mode, start, total, sizeof(T));
+
+	const char* implementationNames[] = { "scalar", "ssse3", "avx2" };
+	for (int implementation = SCALAR_BYTE_SWAP; implementation <= AVX2_BYTE_SWAP; implementation++) {
+		if (!setByteSwapImplementation((ByteSwapImplementation)implementation)) continue;
+		start = chrono::steady_clock::now();
+		for (int r = 0; r < rounds; r++) {
+			check(buffer.getPrimities(0, output.data(), count), name);
+			check(output == values, name);
+		}
+		snprintf(mode, sizeof(mode), "%s batch %s", name, implementationNames[implementation]);
+		report(mode, start, total, sizeof(T));
+	}
+}
+
+int main(int argc, char** argv) {
+	int count = argc > 1 ? atoi(argv[1]) : 1 << 20;
+	int rounds = argc > 2 ? atoi(argv[2]) : 50;
+	printf("%-22s %10s %12s\n", "mode", "ns/value", "MB/s");
+	runColumn<int>("int", count, rounds);
+	runColumn<double>("double", count, rounds);
+	return 0;
+}
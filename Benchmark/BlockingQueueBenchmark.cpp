@@ -0,0 +1,88 @@
+//Buffer library by Huynh Hoang Kha
+//Blocking pipeline benchmark: one producer thread and one consumer thread moving longs
+//A QueueArrayBuffer behind a mutex and a condition variable notified on every enQueue, against
+//BlockingQueueArrayBuffer waking on every value and with batched wake-ups.
+//Context switches come from getrusage, both threads together. The consumer checks the sum in every mode.
+//Usage: BlockingQueueBenchmark [values] [batch] [capacity]
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <sys/resource.h>
+#include <thread>
+#include "../Buffer/BlockingQueueBuffer.h"
+using namespace std;
+
+struct ConditionQueue {
+	QueueArrayBuffer queue;
+	mutex lock;
+	condition_variable dataReady, spaceReady;
+	long long notifications;
+	ConditionQueue(int capacity) :queue(capacity, HOST_ENDIAN), notifications(0) {};
+	void enQueueLongWait(long dataIn) {
+		unique_lock<mutex> guard(lock);
+		spaceReady.wait(guard, [this, dataIn]() { return queue.enQueueLong(dataIn); });
+		notifications++;
+		dataReady.notify_one();
+	};
+	void deQueueLongWait(long* dataOut) {
+		unique_lock<mutex> guard(lock);
+		dataReady.wait(guard, [this, dataOut]() { return queue.deQueueLong(dataOut); });
+		notifications++;
+		spaceReady.notify_one();
+	};
+	void flush() {};	//Every enQueue already notified
+};
+
+static long long contextSwitches() {
+	rusage usage;
+	getrusage(RUSAGE_SELF, &usage);
+	return usage.ru_nvcsw + usage.ru_nivcsw;
+}
+
+//Run the pipeline and print its line, 'wakes' returns the wake-ups (or notifications) the queue made
+template <typename Q, typename F>
+static void runPipeline(const char* mode, Q& queue, long count, F wakes) {
+	long long sum = 0, switches = contextSwitches();
+	auto start = chrono::steady_clock::now();
+	thread consumer([&queue, &sum, count]() {
+		long value = 0;
+		for (long i = 0; i < count; i++) {
+			queue.deQueueLongWait(&value);
+			sum += value;
+		}
+	});
+	for (long i = 0; i < count; i++) queue.enQueueLongWait(i);
+	queue.flush();	//The last values may be less than a batch
+	consumer.join();
+	double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+	switches = contextSwitches() - switches;
+	if (sum != (long long)count * (count - 1) / 2) {
+		printf("%s: wrong sum\n", mode);
+		exit(1);
+	}
+	printf("%-20s %10.3f %12.2f %14.2f %14.2f\n", mode, seconds * 1e3, count / seconds / 1e6, switches * 1000.0 / count, wakes() * 1000.0 / count);
+}
+
+int main(int argc, char** argv) {
+	long count = argc > 1 ? atol(argv[1]) : 2000000;
+	int batch = argc > 2 ? atoi(argv[2]) : 64;
+	int capacity = argc > 3 ? atoi(argv[3]) : 4096;
+	printf("%ld longs, queue of %d bytes, batch of %d values\n", count, capacity, batch);
+	printf("%-20s %10s %12s %14s %14s\n", "mode", "ms", "Mvalues/s", "switches/1000", "wakes/1000");
+	{
+		ConditionQueue queue(capacity);
+		runPipeline("condition variable", queue, count, [&queue]() { return queue.notifications; });
+	}
+	{
+		BlockingQueueArrayBuffer queue(capacity, HOST_ENDIAN);
+		runPipeline("futex, every value", queue, count, [&queue]() { return queue.getWakeCount(); });
+	}
+	{
+		BlockingQueueArrayBuffer queue(capacity, HOST_ENDIAN);
+		queue.setWakeBatch(capacity, batch);
+		runPipeline("futex, batched", queue, count, [&queue]() { return queue.getWakeCount(); });
+	}
+	return 0;
+}
@@ -0,0 +1,305 @@
+//Buffer library by Huynh Hoang Kha
+//Microbenchmark suite: typed push/pop/top, enQueue/deQueue, getPrimity/writePrimity, getString/getSegments and the constructors,
+//over several sizes and both endian modes (LITTLE_ENDIAN buffers byte swap every value, BIG_ENDIAN ones copy it as it is).
+//Reports ns/op, MB/s and heap allocations/op. A run can be saved as a baseline and later runs compared against it.
+//Usage: BufferBenchmark [--filter text] [--min-time ms] [--save file] [--compare file] [--threshold percent]
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <map>
+#include <new>
+#include <string>
+#include <vector>
+#include "../Buffer/Buffer.h"
+using namespace std;
+
+#pragma region Allocation counting
+static atomic<long long> allocationCount(0);
+
+void* operator new(size_t size) {
+	allocationCount.fetch_add(1, memory_order_relaxed);
+	void* memory = malloc(size ? size : 1);
+	if (memory == NULL) throw bad_alloc();
+	return memory;
+}
+void* operator new[](size_t size) { return operator new(size); }
+void operator delete(void* memory) noexcept { free(memory); }
+void operator delete[](void* memory) noexcept { free(memory); }
+void operator delete(void* memory, size_t) noexcept { free(memory); }
+void operator delete[](void* memory, size_t) noexcept { free(memory); }
+#pragma endregion Allocation counting
+
+#pragma region Benchmark cases
+//A case runs 'rounds' rounds of its loop and returns the number of operations done
+struct BenchmarkCase {
+	string name;
+	int bytesPerOperation;
+	function<long long(long long rounds)> run;
+};
+
+struct BenchmarkResult {
+	double nanosecondsPerOperation;
+	double megabytesPerSecond;
+	double allocationsPerOperation;
+};
+
+static volatile long long sink;		//Keeps the compiler from dropping the measured work
+
+#define OPERATIONS_PER_ROUND 256
+
+static const char* endianName(Endian endian) { return endian == BIG_ENDIAN ? "big" : "little"; }
+
+static string caseName(const char* operation, const char* type, Endian endian) {
+	return string(operation) + "/" + type + "/" + endianName(endian);
+}
+
+template <typename T>
+static void addTypedCases(vector<BenchmarkCase>& cases, const char* type, Endian endian) {
+	cases.push_back({ caseName("stack.push+pop", type, endian), (int)sizeof(T), [endian](long long rounds) {
+		StackArrayBuffer stack(OPERATIONS_PER_ROUND * sizeof(T), endian);
+		long long checksum = 0;
+		for (long long r = 0; r < rounds; r++) {
+			for (int i = 0; i < OPERATIONS_PER_ROUND; i++) stack.push((T)i);
+			T value = T();
+			for (int i = 0; i < OPERATIONS_PER_ROUND; i++) {
+				stack.pop(&value);
+				checksum += (long long)value;
+			}
+		}
+		sink = checksum;
+		return rounds * OPERATIONS_PER_ROUND * 2;
+	} });
+	cases.push_back({ caseName("stack.top", type, endian), (int)sizeof(T), [endian](long long rounds) {
+		StackArrayBuffer stack(sizeof(T), endian);
+		stack.push((T)1);
+		long long checksum = 0;
+		T value = T();
+		for (long long r = 0; r < rounds * OPERATIONS_PER_ROUND; r++) {
+			stack.top(&value);
+			checksum += (long long)value;
+		}
+		sink = checksum;
+		return rounds * OPERATIONS_PER_ROUND;
+	} });
+	cases.push_back({ caseName("queue.enQueue+deQueue", type, endian), (int)sizeof(T), [endian](long long rounds) {
+		//A capacity that is not a multiple of sizeof(T) makes some values cross the wrap point
+		QueueArrayBuffer queue(OPERATIONS_PER_ROUND * sizeof(T) + 3, endian);
+		long long checksum = 0;
+		for (long long r = 0; r < rounds; r++) {
+			for (int i = 0; i < OPERATIONS_PER_ROUND; i++) queue.enQueue((T)i);
+			T value = T();
+			for (int i = 0; i < OPERATIONS_PER_ROUND; i++) {
+				queue.deQueue(&value);
+				checksum += (long long)value;
+			}
+		}
+		sink = checksum;
+		return rounds * OPERATIONS_PER_ROUND * 2;
+	} });
+	cases.push_back({ caseName("array.writePrimity", type, endian), (int)sizeof(T), [endian](long long rounds) {
+		ArrayBuffer buffer(OPERATIONS_PER_ROUND * sizeof(T), endian);
+		for (long long r = 0; r < rounds; r++)
+			for (int i = 0; i < OPERATIONS_PER_ROUND; i++) buffer.writePrimity(i * (int)sizeof(T), (T)(r + i));
+		return rounds * OPERATIONS_PER_ROUND;
+	} });
+	cases.push_back({ caseName("array.getPrimity", type, endian), (int)sizeof(T), [endian](long long rounds) {
+		ArrayBuffer buffer(OPERATIONS_PER_ROUND * sizeof(T), endian);
+		for (int i = 0; i < OPERATIONS_PER_ROUND; i++) buffer.writePrimity(i * (int)sizeof(T), (T)i);
+		long long checksum = 0;
+		T value = T();
+		for (long long r = 0; r < rounds; r++)
+			for (int i = 0; i < OPERATIONS_PER_ROUND; i++) {
+				buffer.getPrimity(i * (int)sizeof(T), &value);
+				checksum += (long long)value;
+			}
+		sink = checksum;
+		return rounds * OPERATIONS_PER_ROUND;
+	} });
+}
+
+static void addSizedCases(vector<BenchmarkCase>& cases, int size) {
+	string suffix = "/" + to_string(size);
+	cases.push_back({ "array.getString" + suffix, size, [size](long long rounds) {
+		ArrayBuffer buffer(string(size, 'x'), LITTLE_ENDIAN);
+		long long checksum = 0;
+		for (long long r = 0; r < rounds; r++) checksum += buffer.getString().size();
+		sink = checksum;
+		return rounds;
+	} });
+	cases.push_back({ "queue.getString" + suffix, size, [size](long long rounds) {
+		//Start the content in the middle of the ring so getString has to join the two parts
+		QueueArrayBuffer queue(size, LITTLE_ENDIAN);
+		char byte;
+		for (int i = 0; i < size / 2; i++) queue.enQueueChar('x');
+		for (int i = 0; i < size / 2; i++) queue.deQueueChar(&byte);
+		for (int i = 0; i < size; i++) queue.enQueueChar('x');
+		long long checksum = 0;
+		for (long long r = 0; r < rounds; r++) checksum += queue.getString().size();
+		sink = checksum;
+		return rounds;
+	} });
+	cases.push_back({ "queue.getSegments" + suffix, size, [size](long long rounds) {
+		//Same wrapped content, looked at in place
+		QueueArrayBuffer queue(size, LITTLE_ENDIAN);
+		char byte;
+		for (int i = 0; i < size / 2; i++) queue.enQueueChar('x');
+		for (int i = 0; i < size / 2; i++) queue.deQueueChar(&byte);
+		for (int i = 0; i < size; i++) queue.enQueueChar('x');
+		long long checksum = 0;
+		for (long long r = 0; r < rounds; r++) {
+			BufferSegments segments = queue.getSegments();
+			checksum += segments.first.data[0] + segments.second.data[0] + segments.size();
+		}
+		sink = checksum;
+		return rounds;
+	} });
+	cases.push_back({ "construct.capacity" + suffix, size, [size](long long rounds) {
+		long long checksum = 0;
+		for (long long r = 0; r < rounds; r++) {
+			StackArrayBuffer stack(size, LITTLE_ENDIAN);
+			checksum += stack.getCapacity();
+		}
+		sink = checksum;
+		return rounds;
+	} });
+	cases.push_back({ "construct.memory" + suffix, size, [size](long long rounds) {
+		vector<uint8_t> memory(size, 1);
+		long long checksum = 0;
+		for (long long r = 0; r < rounds; r++) {
+			QueueArrayBuffer queue(memory.data(), size, size, LITTLE_ENDIAN);
+			checksum += queue.getSize();
+		}
+		sink = checksum;
+		return rounds;
+	} });
+	cases.push_back({ "construct.string" + suffix, size, [size](long long rounds) {
+		string content(size, 'x');
+		long long checksum = 0;
+		for (long long r = 0; r < rounds; r++) {
+			QueueArrayBuffer queue(content, LITTLE_ENDIAN);
+			checksum += queue.getSize();
+		}
+		sink = checksum;
+		return rounds;
+	} });
+}
+
+static vector<BenchmarkCase> makeCases() {
+	vector<BenchmarkCase> cases;
+	Endian endians[] = { LITTLE_ENDIAN, BIG_ENDIAN };
+	for (Endian endian : endians) {
+		addTypedCases<char>(cases, "char", endian);
+		addTypedCases<int>(cases, "int", endian);
+		addTypedCases<float>(cases, "float", endian);
+		addTypedCases<long>(cases, "long", endian);
+		addTypedCases<double>(cases, "double", endian);
+	}
+	int sizes[] = { 64, 4096, 65536 };
+	for (int size : sizes) addSizedCases(cases, size);
+	return cases;
+}
+#pragma endregion Benchmark cases
+
+#pragma region Runner
+//Double the number of rounds until one run lasts 'minimumMilliseconds', then keep the best of three runs
+static BenchmarkResult measure(BenchmarkCase& benchmarkCase, double minimumMilliseconds) {
+	long long rounds = 1;
+	double seconds = 0;
+	while (true) {
+		auto start = chrono::steady_clock::now();
+		benchmarkCase.run(rounds);
+		seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+		if (seconds * 1000 >= minimumMilliseconds || rounds >= (1LL << 40)) break;
+		rounds *= 2;
+	}
+	BenchmarkResult best = { 0, 0, 0 };
+	for (int attempt = 0; attempt < 3; attempt++) {
+		long long allocationsBefore = allocationCount.load();
+		auto start = chrono::steady_clock::now();
+		long long operations = benchmarkCase.run(rounds);
+		seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+		double nanoseconds = seconds * 1e9 / operations;
+		if (attempt == 0 || nanoseconds < best.nanosecondsPerOperation) {
+			best.nanosecondsPerOperation = nanoseconds;
+			best.megabytesPerSecond = (double)operations * benchmarkCase.bytesPerOperation / seconds / (1024.0 * 1024.0);
+			best.allocationsPerOperation = (double)(allocationCount.load() - allocationsBefore) / operations;
+		}
+	}
+	return best;
+}
+
+static map<string, double> loadBaseline(const char* path) {
+	map<string, double> baseline;
+	FILE* file = fopen(path, "r");
+	if (file == NULL) {
+		printf("Cannot open baseline %s\n", path);
+		exit(2);
+	}
+	char name[256];
+	double nanoseconds;
+	while (fscanf(file, "%255s %lf", name, &nanoseconds) == 2) baseline[name] = nanoseconds;
+	fclose(file);
+	return baseline;
+}
+
+int main(int argc, char** argv) {
+	const char* filter = NULL;
+	const char* savePath = NULL;
+	const char* comparePath = NULL;
+	double minimumMilliseconds = 50, thresholdPercent = 10;
+	for (int i = 1; i < argc; i++) {
+		string argument = argv[i];
+		if (i + 1 >= argc) {
+			printf("Missing value after %s\n", argv[i]);
+			return 2;
+		}
+		if (argument == "--filter") filter = argv[++i];
+		else if (argument == "--min-time") minimumMilliseconds = atof(argv[++i]);
+		else if (argument == "--save") savePath = argv[++i];
+		else if (argument == "--compare") comparePath = argv[++i];
+		else if (argument == "--threshold") thresholdPercent = atof(argv[++i]);
+		else {
+			printf("Unknown option %s\n", argv[i]);
+			return 2;
+		}
+	}
+	map<string, double> baseline;
+	if (comparePath != NULL) baseline = loadBaseline(comparePath);
+	FILE* saveFile = NULL;
+	if (savePath != NULL && (saveFile = fopen(savePath, "w")) == NULL) {
+		printf("Cannot write baseline %s\n", savePath);
+		return 2;
+	}
+
+	vector<BenchmarkCase> cases = makeCases();
+	int regressions = 0;
+	printf("%-36s %10s %12s %10s", "benchmark", "ns/op", "MB/s", "allocs/op");
+	if (comparePath != NULL) printf(" %10s", "vs base");
+	printf("\n");
+	for (BenchmarkCase& benchmarkCase : cases) {
+		if (filter != NULL && benchmarkCase.name.find(filter) == string::npos) continue;
+		BenchmarkResult result = measure(benchmarkCase, minimumMilliseconds);
+		printf("%-36s %10.2f %12.1f %10.3f", benchmarkCase.name.c_str(), result.nanosecondsPerOperation, result.megabytesPerSecond, result.allocationsPerOperation);
+		if (comparePath != NULL) {
+			auto entry = baseline.find(benchmarkCase.name);
+			if (entry == baseline.end()) printf(" %10s", "new");
+			else {
+				double change = (result.nanosecondsPerOperation / entry->second - 1) * 100;
+				bool regressed = change > thresholdPercent;
+				if (regressed) regressions++;
+				printf(" %+9.1f%%%s", change, regressed ? "  REGRESSION" : "");
+			}
+		}
+		printf("\n");
+		if (saveFile != NULL) fprintf(saveFile, "%s %.4f\n", benchmarkCase.name.c_str(), result.nanosecondsPerOperation);
+	}
+	if (saveFile != NULL) fclose(saveFile);
+	if (regressions > 0) {
+		printf("%d benchmark(s) slower than the baseline by more than %.1f%%\n", regressions, thresholdPercent);
+		return 1;
+	}
+	return 0;
+}
+#pragma endregion Runner
@@ -0,0 +1,159 @@
+//Buffer library by Huynh Hoang Kha
+//Byte scan benchmark: splitting "\r\n" terminated text lines out of a QueueArrayBuffer that wraps around
+//deQueueChar into a scratch string until '\n' against find('\n'), findAny("\r\n") and find("\r\n", 2) followed by one deQueueBlock,
+//for each scan implementation the CPU supports, then text arriving in small pieces: find from the start every time against findNext.
+//Every mode checks the number of lines and the CRC32C of the lines it took out.
+//Usage: ByteScanBenchmark [megabytes] [rounds]
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include "../Buffer/Buffer.h"
+using namespace std;
+
+#define QUEUE_CAPACITY 65536
+#define SMALL_PIECE 64	//Bytes stored at a time in the streaming modes
+
+struct Totals {
+	long long lines;
+	uint32_t crc;
+};
+
+//Lines of printable text of 'minLength' to 'maxLength' characters, each followed by "\r\n"
+static string makeText(int bytes, int minLength, int maxLength, Totals* expected) {
+	string text;
+	text.reserve(bytes + maxLength + 2);
+	uint64_t state = 88172645463325252ULL;
+	expected->lines = 0;
+	while ((int)text.size() < bytes) {
+		state ^= state << 13; state ^= state >> 7; state ^= state << 17;
+		int length = minLength + (int)(state % (maxLength - minLength + 1));
+		for (int i = 0; i < length; i++) {
+			state ^= state << 13; state ^= state >> 7; state ^= state << 17;
+			text += (char)(' ' + state % 95);
+		}
+		text += "\r\n";
+		expected->lines++;
+	}
+	expected->crc = crc32c(text.data(), (int)text.size());
+	return text;
+}
+
+static void check(const Totals& totals, const Totals& expected, const char* mode) {
+	if (totals.lines == expected.lines && totals.crc == expected.crc) return;
+	printf("%s: wrong lines taken out (%lld lines, expected %lld)\n", mode, totals.lines, expected.lines);
+	exit(1);
+}
+
+static void report(const char* mode, chrono::steady_clock::time_point start, long long bytes) {
+	double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+	printf("%-24s %10.1f\n", mode, bytes / seconds / 1e6);
+}
+
+//Store the next 'piece' bytes of the text (less if the queue is full), return the new position in the text
+static size_t feed(QueueArrayBuffer& queue, const string& text, size_t position, int piece) {
+	int room = queue.getCapacity() - queue.getSize();
+	int bytes = (int)min(text.size() - position, (size_t)min(piece, room));
+	queue.enQueueBlock(text.data() + position, bytes);
+	return position + bytes;
+}
+
+//The current way: one deQueueChar per byte into a scratch string
+static Totals parseByteByByte(QueueArrayBuffer& queue, const string& text, int piece) {
+	Totals totals = { 0, 0 };
+	string line;
+	for (size_t position = 0; position < text.size();) {
+		position = feed(queue, text, position, piece);
+		char c;
+		while (queue.deQueueChar(&c)) {
+			line += c;
+			if (c != '\n') continue;
+			totals.lines++;
+			totals.crc = crc32c(line.data(), (int)line.size(), totals.crc);
+			line.clear();
+		}
+	}
+	return totals;
+}
+
+//'lineEnd' returns the length of the first complete line in the queue, -1 if there is none yet
+template <typename F>
+static Totals parseLines(QueueArrayBuffer& queue, const string& text, int piece, vector<uint8_t>& line, F lineEnd) {
+	Totals totals = { 0, 0 };
+	for (size_t position = 0; position < text.size();) {
+		position = feed(queue, text, position, piece);
+		for (int length = lineEnd(); length > 0; length = lineEnd()) {
+			queue.deQueueBlock(line.data(), length);
+			totals.lines++;
+			totals.crc = crc32c(line.data(), length, totals.crc);
+		}
+	}
+	return totals;
+}
+
+int main(int argc, char** argv) {
+	int megabytes = argc > 1 ? atoi(argv[1]) : 64;
+	int rounds = argc > 2 ? atoi(argv[2]) : 3;
+	Totals expected, expectedLong;
+	string text = makeText(megabytes << 20, 10, 150, &expected);
+	string longText = makeText(megabytes << 18, 1000, 8000, &expectedLong);
+	QueueArrayBuffer queue(QUEUE_CAPACITY, LITTLE_ENDIAN);
+	vector<uint8_t> line(QUEUE_CAPACITY);
+	const char* lineEnd = "\r\n";
+	long long bytes = (long long)text.size() * rounds;
+	printf("%lld lines of 10 to 150 characters, %d MB\n", expected.lines, megabytes);
+	printf("%-24s %10s\n", "mode", "MB/s");
+
+	auto start = chrono::steady_clock::now();
+	for (int r = 0; r < rounds; r++) check(parseByteByByte(queue, text, QUEUE_CAPACITY), expected, "deQueueChar");
+	report("deQueueChar", start, bytes);
+
+	const ByteScanImplementation implementations[] = { SCALAR_BYTE_SCAN, SSE2_BYTE_SCAN, AVX2_BYTE_SCAN };
+	const char* names[] = { "scalar", "sse2", "avx2" };
+	ByteScanImplementation best = getByteScanImplementation();
+	char mode[64];
+	for (int k = 0; k < 3; k++) {
+		if (!setByteScanImplementation(implementations[k])) continue;
+		snprintf(mode, sizeof(mode), "%s find('\\n')", names[k]);
+		start = chrono::steady_clock::now();
+		for (int r = 0; r < rounds; r++) {
+			check(parseLines(queue, text, QUEUE_CAPACITY, line, [&]() { return queue.find('\n') + 1; }), expected, mode);
+		}
+		report(mode, start, bytes);
+		snprintf(mode, sizeof(mode), "%s findAny(\"\\r\\n\")", names[k]);
+		start = chrono::steady_clock::now();
+		for (int r = 0; r < rounds; r++) {
+			check(parseLines(queue, text, QUEUE_CAPACITY, line, [&]() { int found = queue.findAny(lineEnd, 2); return found < 0 ? -1 : found + 2; }), expected, mode);
+		}
+		report(mode, start, bytes);
+		snprintf(mode, sizeof(mode), "%s find(\"\\r\\n\")", names[k]);
+		start = chrono::steady_clock::now();
+		for (int r = 0; r < rounds; r++) {
+			check(parseLines(queue, text, QUEUE_CAPACITY, line, [&]() { int found = queue.find(lineEnd, 2); return found < 0 ? -1 : found + 2; }), expected, mode);
+		}
+		report(mode, start, bytes);
+	}
+	setByteScanImplementation(best);
+
+	//Lines much longer than the pieces: without a cursor every piece rescans the whole partial line
+	bytes = (long long)longText.size() * rounds;
+	printf("\n%lld lines of 1000 to 8000 characters stored %d bytes at a time, %d MB\n", expectedLong.lines, SMALL_PIECE, megabytes / 4);
+	printf("%-24s %10s\n", "mode", "MB/s");
+	start = chrono::steady_clock::now();
+	for (int r = 0; r < rounds; r++) check(parseByteByByte(queue, longText, SMALL_PIECE), expectedLong, "deQueueChar");
+	report("deQueueChar", start, bytes);
+	start = chrono::steady_clock::now();
+	for (int r = 0; r < rounds; r++) {
+		check(parseLines(queue, longText, SMALL_PIECE, line, [&]() { int found = queue.find(lineEnd, 2); return found < 0 ? -1 : found + 2; }), expectedLong, "find(\"\\r\\n\")");
+	}
+	report("find(\"\\r\\n\")", start, bytes);
+	start = chrono::steady_clock::now();
+	for (int r = 0; r < rounds; r++) {
+		ScanCursor cursor;
+		check(parseLines(queue, longText, SMALL_PIECE, line, [&]() { int found = queue.findNext(lineEnd, 2, &cursor); return found < 0 ? -1 : found + 2; }), expectedLong, "findNext(\"\\r\\n\")");
+	}
+	report("findNext(\"\\r\\n\")", start, bytes);
+	return 0;
+}
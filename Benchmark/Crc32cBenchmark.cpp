@@ -0,0 +1,70 @@
+//Buffer library by Huynh Hoang Kha
+//Checksum benchmark: CRC32C of the messages going through a wrapped QueueArrayBuffer
+//getString() then crc32c against the in-place getCrc32c() with each implementation, and the running checksum of enQueueBlock
+//Every mode checks its checksum against the one computed on the source data.
+//Usage: Crc32cBenchmark [message bytes] [rounds]
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include "../Buffer/Buffer.h"
+using namespace std;
+
+static void check(bool ok, const char* mode) {
+	if (ok) return;
+	printf("%s: wrong checksum\n", mode);
+	exit(1);
+}
+
+static void report(const char* mode, chrono::steady_clock::time_point start, long long bytes) {
+	double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+	printf("%-24s %12.1f\n", mode, bytes / seconds / (1024.0 * 1024.0));
+}
+
+int main(int argc, char** argv) {
+	int messageSize = argc > 1 ? atoi(argv[1]) : 1 << 16;
+	int rounds = argc > 2 ? atoi(argv[2]) : 2000;
+	vector<uint8_t> message(messageSize), sink(messageSize);
+	for (int i = 0; i < messageSize; i++) message[i] = (uint8_t)(i * 2654435761u >> 13);
+	//A third of the message before the wrap point, the rest after it
+	QueueArrayBuffer queue(messageSize, BIG_ENDIAN);
+	queue.enQueueBlock(message.data(), messageSize / 3 * 2);
+	queue.deQueueBlock(sink.data(), messageSize / 3 * 2);
+	queue.enQueueBlock(message.data(), messageSize);
+	const uint32_t expected = crc32c(message.data(), messageSize);
+	long long total = (long long)messageSize * rounds;
+	printf("%-24s %12s\n", "mode", "MB/s");
+
+	const char* implementationNames[] = { "software", "sse4.2" };
+	char mode[64];
+	for (int implementation = SOFTWARE_CRC32C; implementation <= SSE42_CRC32C; implementation++) {
+		if (!setCrc32cImplementation((Crc32cImplementation)implementation)) continue;
+		auto start = chrono::steady_clock::now();
+		for (int r = 0; r < rounds; r++) {
+			string copy = queue.getString();
+			check(crc32c(copy.data(), (int)copy.size()) == expected, "getString");
+		}
+		snprintf(mode, sizeof(mode), "getString+crc %s", implementationNames[implementation]);
+		report(mode, start, total);
+
+		start = chrono::steady_clock::now();
+		for (int r = 0; r < rounds; r++) check(queue.getCrc32c() == expected, "getCrc32c");
+		snprintf(mode, sizeof(mode), "getCrc32c %s", implementationNames[implementation]);
+		report(mode, start, total);
+
+		//enQueue with the running checksum on, against the same loop with it off
+		QueueArrayBuffer stream(messageSize, BIG_ENDIAN);
+		for (int checksum = 0; checksum <= 1; checksum++) {
+			stream.setRunningChecksum(checksum == 1);
+			start = chrono::steady_clock::now();
+			for (int r = 0; r < rounds; r++) {
+				stream.resetRunningChecksum();
+				check(stream.enQueueBlock(message.data(), messageSize) && stream.deQueueBlock(sink.data(), messageSize), "enQueueBlock");
+				check(!checksum || stream.getRunningChecksum() == expected, "running checksum");
+			}
+			snprintf(mode, sizeof(mode), "enQueue+deQueue %s%s", checksum ? "crc " : "", checksum ? implementationNames[implementation] : "");
+			report(mode, start, total);
+		}
+	}
+	return 0;
+}
@@ -0,0 +1,65 @@
+//Buffer library by Huynh Hoang Kha
+//Scaling benchmark: N producers and N consumers sharing one queue of ints
+//MPMCQueueArrayBuffer against a QueueArrayBuffer guarded by one global mutex
+//Usage: MPMCQueueBenchmark [maxThreads] [valuesPerProducer]
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "../Buffer/MPMCQueueBuffer.h"
+using namespace std;
+
+#define QUEUE_CAPACITY 4096
+
+struct LockedQueue {
+	QueueArrayBuffer queue;
+	mutex lock;
+	LockedQueue() :queue(QUEUE_CAPACITY * sizeof(int), LITTLE_ENDIAN) {};
+	bool enQueueInt(int dataIn) { lock_guard<mutex> guard(lock); return queue.enQueueInt(dataIn); };
+	bool deQueueInt(int* dataOut) { lock_guard<mutex> guard(lock); return queue.deQueueInt(dataOut); };
+};
+
+//Run 'threads' producers and 'threads' consumers, return millions of values moved per second
+template <typename Q>
+double runScaling(Q& queue, int threads, int valuesPerProducer) {
+	vector<thread> workers;
+	vector<long long> checksums(threads, 0);
+	auto start = chrono::steady_clock::now();
+	for (int p = 0; p < threads; p++) workers.emplace_back([&queue, p, valuesPerProducer]() {
+		for (int i = 0; i < valuesPerProducer; i++) while (!queue.enQueueInt(p * valuesPerProducer + i)) this_thread::yield();
+	});
+	for (int c = 0; c < threads; c++) workers.emplace_back([&queue, &checksums, c, valuesPerProducer]() {
+		int value;
+		for (int i = 0; i < valuesPerProducer; i++) {
+			while (!queue.deQueueInt(&value)) this_thread::yield();
+			checksums[c] += value;
+		}
+	});
+	for (auto& worker : workers) worker.join();
+	double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+	long long total = (long long)threads * valuesPerProducer, expected = total * (total - 1) / 2, sum = 0;
+	for (long long checksum : checksums) sum += checksum;
+	if (sum != expected) {
+		printf("Checksum mismatch: %lld != %lld\n", sum, expected);
+		exit(1);
+	}
+	return total / seconds / 1e6;
+}
+
+int main(int argc, char** argv) {
+	int maxThreads = argc > 1 ? atoi(argv[1]) : (int)thread::hardware_concurrency();
+	int valuesPerProducer = argc > 2 ? atoi(argv[2]) : 1000000;
+	if (maxThreads < 1) maxThreads = 1;
+	printf("%-10s %16s %16s\n", "threads", "mpmc Mops/s", "mutex Mops/s");
+	for (int threads = 1; threads <= maxThreads; threads *= 2) {
+		MPMCQueueArrayBuffer mpmc(QUEUE_CAPACITY, LITTLE_ENDIAN);
+		LockedQueue locked;
+		double mpmcRate = runScaling(mpmc, threads, valuesPerProducer);
+		double lockedRate = runScaling(locked, threads, valuesPerProducer);
+		printf("%-10d %16.2f %16.2f\n", threads, mpmcRate, lockedRate);
+		if (threads < maxThreads && threads * 2 > maxThreads) threads = maxThreads / 2;
+	}
+	return 0;
+}
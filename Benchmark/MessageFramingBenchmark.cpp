@@ -0,0 +1,97 @@
+//Buffer library by Huynh Hoang Kha
+//Message framing benchmark: variable-length messages through a QueueArrayBuffer
+//A length with enQueueInt and the payload byte by byte, against enQueueMessage with deQueueMessage (copy)
+//and deQueueMessages (in place, in batches), with both header kinds. Every mode checks the CRC32C of the bytes it reads back.
+//Usage: MessageFramingBenchmark [messages] [maxPayload] [batch]
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include "../Buffer/Buffer.h"
+using namespace std;
+
+#define QUEUE_CAPACITY (64 * 1024)
+
+static void report(const char* mode, chrono::steady_clock::time_point start, long long messages, long long bytes, uint32_t crc, uint32_t expected) {
+	double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+	if (crc != expected) {
+		printf("%s: wrong bytes read back\n", mode);
+		exit(1);
+	}
+	printf("%-26s %10.2f %12.1f %10.1f\n", mode, seconds * 1e9 / messages, messages / seconds / 1e6, bytes / seconds / (1024.0 * 1024.0));
+}
+
+int main(int argc, char** argv) {
+	int messages = argc > 1 ? atoi(argv[1]) : 2000000;
+	int maxPayload = argc > 2 ? atoi(argv[2]) : 256;
+	int batch = argc > 3 ? atoi(argv[3]) : 32;
+	if (maxPayload < 1 || maxPayload > QUEUE_CAPACITY / 4) maxPayload = 256;
+	if (batch < 1) batch = 1;
+	//A pool of payloads of random lengths, the messages cycle through it
+	vector<uint8_t> pool(1 << 20);
+	for (size_t i = 0; i < pool.size(); i++) pool[i] = (uint8_t)(i * 2654435761u >> 13);
+	vector<int> lengths(4096), offsets(4096);
+	for (int i = 0; i < 4096; i++) {
+		lengths[i] = 1 + (int)((i * 40503u + 17) % (unsigned)maxPayload);
+		offsets[i] = (int)((i * 7919u) % (unsigned)(pool.size() - maxPayload));
+	}
+	uint32_t expected = 0;
+	long long bytes = 0;
+	for (int m = 0; m < messages; m++) {
+		expected = crc32c(pool.data() + offsets[m & 4095], lengths[m & 4095], expected);
+		bytes += lengths[m & 4095];
+	}
+	printf("%d messages of 1 to %d bytes, batches of %d\n", messages, maxPayload, batch);
+	printf("%-26s %10s %12s %10s\n", "mode", "ns/msg", "Mmsg/s", "MB/s");
+	vector<uint8_t> message(maxPayload);
+
+	//Enough messages to half fill the queue go in, then they all come out: the frames keep crossing the wrap point
+	QueueArrayBuffer manual(QUEUE_CAPACITY, LITTLE_ENDIAN);
+	uint32_t crc = 0;
+	auto start = chrono::steady_clock::now();
+	for (int m = 0; m < messages; m += batch) {
+		int end = m + batch < messages ? m + batch : messages;
+		for (int i = m; i < end; i++) {
+			manual.enQueueInt(lengths[i & 4095]);
+			for (int b = 0; b < lengths[i & 4095]; b++) manual.enQueueChar((char)pool[offsets[i & 4095] + b]);
+		}
+		for (int i = m; i < end; i++) {
+			int length = 0;
+			manual.deQueueInt(&length);
+			for (int b = 0; b < length; b++) manual.deQueueChar((char*)&message[b]);
+			crc = crc32c(message.data(), length, crc);
+		}
+	}
+	report("enQueueInt + bytes", start, messages, bytes, crc, expected);
+
+	const char* headerNames[] = { "fixed", "varint" };
+	for (int header = FIXED_32_HEADER; header <= VARINT_HEADER; header++) {
+		QueueArrayBuffer queue(QUEUE_CAPACITY, LITTLE_ENDIAN);
+		queue.setMessageHeader((MessageHeader)header);
+		char mode[64];
+		crc = 0;
+		start = chrono::steady_clock::now();
+		for (int m = 0; m < messages; m += batch) {
+			int end = m + batch < messages ? m + batch : messages;
+			for (int i = m; i < end; i++) queue.enQueueMessage(pool.data() + offsets[i & 4095], lengths[i & 4095]);
+			int length = 0;
+			for (int i = m; i < end; i++) {
+				queue.deQueueMessage(message.data(), maxPayload, &length);
+				crc = crc32c(message.data(), length, crc);
+			}
+		}
+		snprintf(mode, sizeof(mode), "deQueueMessage %s", headerNames[header]);
+		report(mode, start, messages, bytes, crc, expected);
+
+		crc = 0;
+		start = chrono::steady_clock::now();
+		for (int m = 0; m < messages; m += batch) {
+			int end = m + batch < messages ? m + batch : messages;
+			for (int i = m; i < end; i++) queue.enQueueMessage(pool.data() + offsets[i & 4095], lengths[i & 4095]);
+			queue.deQueueMessages([&crc](BufferSegments payload) { crc = crc32c(payload, crc); }, end - m);
+		}
+		snprintf(mode, sizeof(mode), "deQueueMessages %s", headerNames[header]);
+		report(mode, start, messages, bytes, crc, expected);
+	}
+	return 0;
+}
@@ -0,0 +1,84 @@
+//Buffer library by Huynh Hoang Kha
+//Journal benchmark: enQueue/deQueue of int messages with no journal, then recorded by a QueueJournal at several group commit sizes,
+//plus snapshot and recovery times. After the run the queue is recovered from the files and checked against the live one.
+//Usage: QueueJournalBenchmark [directory] [messages]
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <unistd.h>
+#include "../Buffer/QueueJournal.h"
+using namespace std;
+
+static double secondsSince(chrono::steady_clock::time_point start) {
+	return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
+
+//Keep about 1000 ints in the queue while 'messages' of them go through
+static double run(QueueArrayBuffer& queue, QueueJournal* journal, int messages) {
+	int value;
+	auto start = chrono::steady_clock::now();
+	for (int i = 0; i < messages; i++) {
+		if (!queue.enQueueInt(i)) exit(1);
+		if (i >= 1000 && (!queue.deQueueInt(&value) || value != i - 1000)) {
+			printf("Wrong value dequeued\n");
+			exit(1);
+		}
+	}
+	if (journal != NULL && !journal->commit()) exit(1);
+	return secondsSince(start);
+}
+
+int main(int argc, char** argv) {
+	string basePath = string(argc > 1 ? argv[1] : ".") + "/QueueJournalBenchmark";
+	int messages = argc > 2 ? atoi(argv[2]) : 2000000;
+	string journalPath = basePath + ".journal", snapshotPath = basePath + ".snapshot";
+	printf("%-28s %10s\n", "mode", "ns/message");
+	{
+		QueueArrayBuffer queue(1 << 16, LITTLE_ENDIAN);
+		printf("%-28s %10.2f\n", "no journal", run(queue, NULL, messages) * 1e9 / messages);
+	}
+	int groupCommitSizes[] = { 1 << 12, 1 << 16, 1 << 20 };
+	for (int groupCommitBytes : groupCommitSizes) {
+		unlink(journalPath.c_str());
+		unlink(snapshotPath.c_str());
+		QueueArrayBuffer queue(1 << 16, LITTLE_ENDIAN);
+		QueueJournal journal(basePath.c_str(), groupCommitBytes);
+		if (!journal.recover(&queue)) {
+			printf("Cannot open the journal in %s\n", basePath.c_str());
+			return 1;
+		}
+		double seconds = run(queue, &journal, messages);
+		char mode[64];
+		snprintf(mode, sizeof(mode), "journal, commit every %dK", groupCommitBytes >> 10);
+		printf("%-28s %10.2f\n", mode, seconds * 1e9 / messages);
+	}
+	//The last journal holds the whole run: time a snapshot, then recovery from the snapshot plus a short journal tail
+	QueueArrayBuffer queue(1 << 16, LITTLE_ENDIAN);
+	QueueJournal journal(basePath.c_str());
+	auto start = chrono::steady_clock::now();
+	if (!journal.recover(&queue)) exit(1);
+	printf("%-28s %10.3f ms\n", "recover from journal", secondsSince(start) * 1e3);
+	start = chrono::steady_clock::now();
+	if (!journal.snapshot()) exit(1);
+	printf("%-28s %10.3f ms\n", "snapshot", secondsSince(start) * 1e3);
+	int value;
+	for (int i = 0; i < 100000; i++) {
+		if (!queue.enQueueInt(i) || !queue.deQueueInt(&value)) exit(1);
+	}
+	if (!journal.commit()) exit(1);
+	QueueArrayBuffer recovered(1, LITTLE_ENDIAN);
+	QueueJournal recoveredJournal(basePath.c_str());
+	journal.detach();
+	start = chrono::steady_clock::now();
+	if (!recoveredJournal.recover(&recovered)) exit(1);
+	printf("%-28s %10.3f ms\n", "recover from snapshot", secondsSince(start) * 1e3);
+	if (recovered.getString() != queue.getString()) {
+		printf("Recovered queue differs from the live one\n");
+		return 1;
+	}
+	recoveredJournal.detach();
+	unlink(journalPath.c_str());
+	unlink(snapshotPath.c_str());
+	return 0;
+}
@@ -0,0 +1,107 @@
+//Buffer library by Huynh Hoang Kha
+//Proxy benchmark: bytes flow source -> socketpair -> QueueArrayBuffer -> socketpair -> sink
+//"copy" mode is the old path (read() into a scratch array, enQueue byte by byte, drain through getString())
+//"readv" mode uses QueueArrayBuffer::readFrom/writeTo. The sink checks every byte it receives.
+//Usage: QueueStreamingBenchmark [megabytes] [queueCapacity]
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <sys/socket.h>
+#include <unistd.h>
+#include "../Buffer/Buffer.h"
+using namespace std;
+
+static uint8_t patternByte(long long position) { return (uint8_t)(position * 31 % 251); }
+
+static void runSource(int fd, long long totalBytes) {
+	uint8_t chunk[65536];
+	for (long long sent = 0; sent < totalBytes;) {
+		int length = (int)(totalBytes - sent < (long long)sizeof(chunk) ? totalBytes - sent : sizeof(chunk));
+		for (int i = 0; i < length; i++) chunk[i] = patternByte(sent + i);
+		for (int done = 0; done < length;) {
+			ssize_t written = write(fd, chunk + done, length - done);
+			if (written <= 0) exit(1);
+			done += (int)written;
+		}
+		sent += length;
+	}
+	shutdown(fd, SHUT_WR);
+}
+
+static void runSink(int fd, long long totalBytes) {
+	uint8_t chunk[65536];
+	long long received = 0;
+	ssize_t length;
+	while ((length = read(fd, chunk, sizeof(chunk))) > 0) {
+		for (int i = 0; i < length; i++) if (chunk[i] != patternByte(received + i)) {
+			printf("Corrupted byte at %lld\n", received + i);
+			exit(1);
+		}
+		received += length;
+	}
+	if (received != totalBytes) {
+		printf("Received %lld bytes instead of %lld\n", received, totalBytes);
+		exit(1);
+	}
+}
+
+//Forward everything from 'in' to 'out' through the queue
+static void proxyCopy(QueueArrayBuffer& queue, int in, int out) {
+	uint8_t scratch[65536];
+	bool endOfInput = false;
+	while (!endOfInput || !queue.isEmpty()) {
+		int freeBytes = queue.getCapacity() - queue.getSize();
+		if (!endOfInput && freeBytes > 0) {
+			ssize_t length = read(in, scratch, freeBytes < (int)sizeof(scratch) ? freeBytes : sizeof(scratch));
+			if (length <= 0) endOfInput = true;
+			for (ssize_t i = 0; i < length; i++) queue.enQueue(scratch[i]);
+		}
+		if (!queue.isEmpty()) {
+			string pending = queue.getString();
+			ssize_t written = write(out, pending.data(), pending.size());
+			if (written < 0) exit(1);
+			for (ssize_t dropped = 0; dropped < written;) {
+				int length = written - dropped < (ssize_t)sizeof(scratch) ? (int)(written - dropped) : (int)sizeof(scratch);
+				queue.deQueueBlock(scratch, length);
+				dropped += length;
+			}
+		}
+	}
+}
+
+static void proxyReadv(QueueArrayBuffer& queue, int in, int out) {
+	bool endOfInput = false;
+	while (!endOfInput || !queue.isEmpty()) {
+		if (!endOfInput && !queue.isFull() && queue.readFrom(in) <= 0) endOfInput = true;
+		if (!queue.isEmpty() && queue.writeTo(out) < 0) exit(1);
+	}
+}
+
+static double runProxy(bool useReadv, long long totalBytes, int queueCapacity) {
+	int upstream[2], downstream[2];
+	if (socketpair(AF_UNIX, SOCK_STREAM, 0, upstream) != 0 || socketpair(AF_UNIX, SOCK_STREAM, 0, downstream) != 0) exit(1);
+	QueueArrayBuffer queue(queueCapacity, LITTLE_ENDIAN);
+	auto start = chrono::steady_clock::now();
+	thread source(runSource, upstream[0], totalBytes);
+	thread sink(runSink, downstream[1], totalBytes);
+	if (useReadv) proxyReadv(queue, upstream[1], downstream[0]);
+	else proxyCopy(queue, upstream[1], downstream[0]);
+	shutdown(downstream[0], SHUT_WR);
+	source.join();
+	sink.join();
+	double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+	close(upstream[0]); close(upstream[1]); close(downstream[0]); close(downstream[1]);
+	return totalBytes / seconds / (1024.0 * 1024.0);
+}
+
+int main(int argc, char** argv) {
+	long long megabytes = argc > 1 ? atoll(argv[1]) : 256;
+	int queueCapacity = argc > 2 ? atoi(argv[2]) : 65536;
+	long long totalBytes = megabytes * 1024 * 1024;
+	printf("%-8s %12s\n", "mode", "MB/s");
+	printf("%-8s %12.1f\n", "copy", runProxy(false, totalBytes, queueCapacity));
+	printf("%-8s %12.1f\n", "readv", runProxy(true, totalBytes, queueCapacity));
+	return 0;
+}
@@ -0,0 +1,92 @@
+//Buffer library by Huynh Hoang Kha
+//Varint benchmark: a telemetry-like stream of mostly small integers through a QueueArrayBuffer and a StackArrayBuffer
+//Fixed-width enQueueLong/pushLong against enQueueVarint/pushVarint, deQueueVarint and the batched deQueueVarints
+//Every mode checks the values it reads back.
+//Usage: VarintBenchmark [values] [rounds]
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include "../Buffer/Buffer.h"
+using namespace std;
+
+//90% of the values below 128, 9% below 2^21, 1% full width
+static vector<uint64_t> makeValues(int count) {
+	vector<uint64_t> values(count);
+	uint64_t state = 88172645463325252ULL;
+	for (int i = 0; i < count; i++) {
+		state ^= state << 13; state ^= state >> 7; state ^= state << 17;
+		int bucket = (int)(state % 100);
+		values[i] = bucket < 90 ? (state >> 8) & 0x7F : (bucket < 99 ? (state >> 8) & 0x1FFFFF : state);
+	}
+	return values;
+}
+
+static void check(bool ok, const char* mode) {
+	if (ok) return;
+	printf("%s: wrong value read back\n", mode);
+	exit(1);
+}
+
+static void report(const char* mode, chrono::steady_clock::time_point start, long long operations, int bytesPerRound) {
+	double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+	printf("%-18s %10.2f %14d\n", mode, seconds * 1e9 / operations, bytesPerRound);
+}
+
+int main(int argc, char** argv) {
+	int count = argc > 1 ? atoi(argv[1]) : 1000000;
+	int rounds = argc > 2 ? atoi(argv[2]) : 20;
+	vector<uint64_t> values = makeValues(count);
+	vector<uint64_t> output(count);
+	long long operations = (long long)count * rounds;
+	QueueArrayBuffer queue(count * VARINT_MAX_BYTES, LITTLE_ENDIAN);
+	StackArrayBuffer stack(count * VARINT_MAX_BYTES, LITTLE_ENDIAN);
+	printf("%-18s %10s %14s\n", "mode", "ns/value", "bytes/round");
+
+	auto start = chrono::steady_clock::now();
+	for (int r = 0; r < rounds; r++) {
+		for (int i = 0; i < count; i++) queue.enQueueLong((long)values[i]);
+		long value;
+		for (int i = 0; i < count; i++) check(queue.deQueueLong(&value) && (uint64_t)value == values[i], "queue long");
+	}
+	report("queue long", start, operations, count * (int)sizeof(long));
+
+	start = chrono::steady_clock::now();
+	int varintBytes = 0;
+	for (int r = 0; r < rounds; r++) {
+		for (int i = 0; i < count; i++) queue.enQueueVarint(values[i]);
+		varintBytes = queue.getSize();
+		uint64_t value;
+		for (int i = 0; i < count; i++) check(queue.deQueueVarint(&value) && value == values[i], "queue varint");
+	}
+	report("queue varint", start, operations, varintBytes);
+
+	start = chrono::steady_clock::now();
+	for (int r = 0; r < rounds; r++) {
+		for (int i = 0; i < count; i++) queue.enQueueVarint(values[i]);
+		for (int done = 0; done < count;) {
+			int moved = queue.deQueueVarints(output.data() + done, count - done);
+			check(moved > 0, "queue varint batch");
+			done += moved;
+		}
+		for (int i = 0; i < count; i++) check(output[i] == values[i], "queue varint batch");
+	}
+	report("queue varint batch", start, operations, varintBytes);
+
+	start = chrono::steady_clock::now();
+	for (int r = 0; r < rounds; r++) {
+		for (int i = 0; i < count; i++) stack.pushLong((long)values[i]);
+		long value;
+		for (int i = count - 1; i >= 0; i--) check(stack.popLong(&value) && (uint64_t)value == values[i], "stack long");
+	}
+	report("stack long", start, operations, count * (int)sizeof(long));
+
+	start = chrono::steady_clock::now();
+	for (int r = 0; r < rounds; r++) {
+		for (int i = 0; i < count; i++) stack.pushVarint(values[i]);
+		uint64_t value;
+		for (int i = count - 1; i >= 0; i--) check(stack.popVarint(&value) && value == values[i], "stack varint");
+	}
+	report("stack varint", start, operations, varintBytes);
+	return 0;
+}
@@ -0,0 +1,61 @@
+//Buffer library by Huynh Hoang Kha
+//Load balancing benchmark: a binary tree of tasks spawned from a single root on a TaskScheduler
+//With stealing the idle workers take the oldest (biggest) subtrees from the busy ones, without it the worker
+//that got the root runs the whole tree. Both modes check that every leaf ran once.
+//Usage: WorkStealingBenchmark [workers] [depth] [leafWork]
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include "../Buffer/WorkStealingBuffer.h"
+using namespace std;
+
+//Some arithmetic the compiler can not drop, standing for the real work of a leaf
+static long long leafValue(long long seed, int leafWork) {
+	unsigned long long value = (unsigned long long)seed;
+	for (int i = 0; i < leafWork; i++) value = value * 6364136223846793005ULL + 1442695040888963407ULL;
+	return (long long)(value >> 33);
+}
+
+static void runTree(int workers, int depth, int leafWork, bool stealing) {
+	atomic<long long> leaves(0), total(0);
+	TaskScheduler* scheduler = NULL;
+	//A task is a node: the high bits hold its number in the tree, the low 8 bits the depth left under it
+	TaskScheduler pool([&](long task) {
+		long node = task >> 8, below = task & 0xFF;
+		if (below == 0) {
+			total.fetch_add(leafValue(node, leafWork), memory_order_relaxed);
+			leaves.fetch_add(1, memory_order_relaxed);
+			return;
+		}
+		scheduler->spawn(((2 * node) << 8) | (below - 1));
+		scheduler->spawn(((2 * node + 1) << 8) | (below - 1));
+	}, workers, stealing);
+	scheduler = &pool;
+	auto start = chrono::steady_clock::now();
+	pool.spawn((1L << 8) | depth);
+	pool.wait();
+	double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+	long long expectedTotal = 0;
+	for (long node = 1L << depth; node < 2L << depth; node++) expectedTotal += leafValue(node, leafWork);
+	if (leaves.load() != (1LL << depth) || total.load() != expectedTotal) {
+		printf("%s: %lld leaves ran instead of %lld\n", stealing ? "stealing" : "no stealing", leaves.load(), 1LL << depth);
+		exit(1);
+	}
+	printf("%-12s %10.3f %12.2f   executed/stolen:", stealing ? "stealing" : "no stealing", seconds * 1e3, (2LL << depth) / seconds / 1e6);
+	for (int w = 0; w < pool.getWorkerCount(); w++) printf(" %lld/%lld", pool.getExecutedTasks(w), pool.getStolenTasks(w));
+	printf("\n");
+}
+
+int main(int argc, char** argv) {
+	int workers = argc > 1 ? atoi(argv[1]) : (int)thread::hardware_concurrency();
+	int depth = argc > 2 ? atoi(argv[2]) : 18;
+	int leafWork = argc > 3 ? atoi(argv[3]) : 2000;
+	if (workers < 1) workers = 1;
+	if (depth < 0 || depth > 40) depth = 18;
+	printf("%d workers, %lld leaves of %d steps\n", workers, 1LL << depth, leafWork);
+	printf("%-12s %10s %12s\n", "mode", "ms", "Mtasks/s");
+	runTree(workers, depth, leafWork, false);
+	runTree(workers, depth, leafWork, true);
+	return 0;
+}
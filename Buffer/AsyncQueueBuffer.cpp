@@ -0,0 +1,248 @@
+//Buffer library by Huynh Hoang Kha
+//C++20 coroutine awaitable enQueue/deQueue on QueueArrayBuffer and the single-threaded event loop (epoll/eventfd) that runs them
+#include "AsyncQueueBuffer.h"
+
+#ifdef BUFFER_HAS_COROUTINES
+#include <algorithm>
+#include <cerrno>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#define EVENT_LOOP_MAX_EVENTS 64
+
+static thread_local EventLoop* currentLoop = NULL;
+
+#pragma region BufferTask implementation
+//------------------------------------------------------------------------------------------------------------
+//Section: BufferTask implementation
+void BufferTask::promise_type::unhandled_exception() {
+	if (this->loop != NULL && !this->loop->failure) this->loop->failure = std::current_exception();
+}
+
+BufferTask::promise_type::~promise_type() {
+	if (this->loop != NULL) this->loop->liveTasks--;
+}
+//Endsection: BufferTask implementation
+#pragma endregion BufferTask implementation
+
+#pragma region EventLoop implementation
+//------------------------------------------------------------------------------------------------------------
+//Section: EventLoop implementation
+EventLoop::EventLoop() :stopping(false), liveTasks(0), watchedDescriptors(0) {
+	this->epollDescriptor = epoll_create1(EPOLL_CLOEXEC);
+	this->wakeDescriptor = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	//The eventfd is the only descriptor registered with a NULL pointer, the others carry the waiting coroutine
+	epoll_event event;
+	event.events = EPOLLIN;
+	event.data.ptr = NULL;
+	if (this->epollDescriptor < 0 || this->wakeDescriptor < 0 || epoll_ctl(this->epollDescriptor, EPOLL_CTL_ADD, this->wakeDescriptor, &event) != 0) {
+		if (this->epollDescriptor >= 0) close(this->epollDescriptor);
+		if (this->wakeDescriptor >= 0) close(this->wakeDescriptor);
+		BufferException bE(EVENT_LOOP_FAILED);
+		throw bE;
+	}
+}
+
+EventLoop::~EventLoop() {
+	for (std::coroutine_handle<> handle : this->posted) this->ready.push_back(handle);
+	for (std::coroutine_handle<> handle : this->ready) handle.destroy();
+	close(this->epollDescriptor);
+	close(this->wakeDescriptor);
+}
+
+EventLoop * EventLoop::current() {
+	return currentLoop;
+}
+
+void EventLoop::spawn(BufferTask task) {
+	std::coroutine_handle<BufferTask::promise_type> handle = task.handle;
+	task.handle = NULL;
+	handle.promise().loop = this;
+	this->liveTasks++;
+	this->ready.push_back(handle);
+}
+
+void EventLoop::schedule(std::coroutine_handle<> handle) {
+	this->ready.push_back(handle);
+}
+
+void EventLoop::post(std::coroutine_handle<> handle) {
+	{
+		std::lock_guard<std::mutex> guard(this->postedLock);
+		this->posted.push_back(handle);
+	}
+	this->wake();
+}
+
+void EventLoop::stop() {
+	this->stopping.store(true, std::memory_order_release);
+	this->wake();
+}
+
+void EventLoop::wake() {
+	uint64_t one = 1;
+	while (write(this->wakeDescriptor, &one, sizeof(one)) < 0 && errno == EINTR);
+}
+
+void EventLoop::forget(QueueWaitList * list) {
+	this->toPump.erase(std::remove(this->toPump.begin(), this->toPump.end(), list), this->toPump.end());
+}
+
+void EventLoop::poll(int timeoutMilliseconds) {
+	epoll_event events[EVENT_LOOP_MAX_EVENTS];
+	int count = epoll_wait(this->epollDescriptor, events, EVENT_LOOP_MAX_EVENTS, timeoutMilliseconds);
+	for (int i = 0; i < count; i++) {
+		if (events[i].data.ptr == NULL) {
+			uint64_t wakeUps;
+			while (read(this->wakeDescriptor, &wakeUps, sizeof(wakeUps)) < 0 && errno == EINTR);
+			continue;
+		}
+		this->watchedDescriptors--;
+		this->ready.push_back(std::coroutine_handle<>::from_address(events[i].data.ptr));
+	}
+	std::lock_guard<std::mutex> guard(this->postedLock);
+	for (std::coroutine_handle<> handle : this->posted) this->ready.push_back(handle);
+	this->posted.clear();
+}
+
+void EventLoop::run() {
+	EventLoop* previous = currentLoop;
+	currentLoop = this;
+	while (!this->stopping.load(std::memory_order_acquire) && !this->failure) {
+		//One round: resume what was ready when it started, each coroutine runs until its next co_await.
+		//The queues it touched hand their data/space to their waiters right after, which become ready for the next round.
+		size_t round = this->ready.size();
+		for (size_t i = 0; i < round && !this->failure; i++) {
+			std::coroutine_handle<> handle = this->ready.front();
+			this->ready.pop_front();
+			handle.resume();
+			while (!this->toPump.empty()) {
+				QueueWaitList* list = this->toPump.back();
+				this->toPump.pop_back();
+				list->pump();
+			}
+		}
+		if (this->failure || (this->ready.empty() && this->liveTasks == 0)) break;
+		//Only sleep when nothing is ready
+		this->poll(this->ready.empty() ? -1 : 0);
+	}
+	currentLoop = previous;
+	this->stopping.store(false, std::memory_order_relaxed);
+	if (this->failure) {
+		std::exception_ptr failure = this->failure;
+		this->failure = NULL;
+		std::rethrow_exception(failure);
+	}
+}
+
+DescriptorAwaiter EventLoop::readable(int fileDescriptor) {
+	return DescriptorAwaiter(this, fileDescriptor, EPOLLIN | EPOLLRDHUP);
+}
+
+DescriptorAwaiter EventLoop::writable(int fileDescriptor) {
+	return DescriptorAwaiter(this, fileDescriptor, EPOLLOUT);
+}
+//Endsection: EventLoop implementation
+#pragma endregion EventLoop implementation
+
+#pragma region DescriptorAwaiter implementation
+//------------------------------------------------------------------------------------------------------------
+//Section: DescriptorAwaiter implementation
+//One-shot registration: the descriptor stays in the epoll set, disarmed, after it fired, so the next wait re-arms it with MOD
+bool DescriptorAwaiter::await_suspend(std::coroutine_handle<> handle) {
+	epoll_event event;
+	event.events = this->events | EPOLLONESHOT;
+	event.data.ptr = handle.address();
+	if (epoll_ctl(this->loop->epollDescriptor, EPOLL_CTL_MOD, this->fileDescriptor, &event) != 0) {
+		if (errno != ENOENT || epoll_ctl(this->loop->epollDescriptor, EPOLL_CTL_ADD, this->fileDescriptor, &event) != 0) return false;
+	}
+	this->watched = true;
+	this->loop->watchedDescriptors++;
+	return true;
+}
+//Endsection: DescriptorAwaiter implementation
+#pragma endregion DescriptorAwaiter implementation
+
+#pragma region QueueWaitList implementation
+//------------------------------------------------------------------------------------------------------------
+//Section: QueueWaitList implementation
+QueueWaitList::~QueueWaitList() {
+	if (this->pumpPending && this->loop != NULL) this->loop->forget(this);
+}
+
+void QueueWaitList::append(QueueWaiter ** list, QueueWaiter * waiter) {
+	waiter->next = NULL;
+	if (list[1] != NULL) list[1]->next = waiter;
+	else list[0] = waiter;
+	list[1] = waiter;
+}
+
+//Called from inside every enQueue/deQueue of the queue: only note that the waiters have to be looked at
+void QueueWaitList::notify() {
+	if (this->pumpPending || (this->readers[0] == NULL && this->writers[0] == NULL)) return;
+	this->pumpPending = true;
+	this->loop->pumpLater(this);
+}
+
+bool QueueWaitList::serve(QueueWaiter ** list) {
+	bool served = false;
+	while (list[0] != NULL && list[0]->attempt(*this->queue, list[0])) {
+		QueueWaiter* waiter = list[0];
+		list[0] = waiter->next;
+		if (list[0] == NULL) list[1] = NULL;
+		this->loop->schedule(waiter->handle);
+		served = true;
+	}
+	return served;
+}
+
+//A deQueue done for a reader makes space for the writers and the other way round, go on until neither can move
+void QueueWaitList::pump() {
+	bool progress;
+	do {
+		progress = this->serve(this->readers);
+		progress = this->serve(this->writers) || progress;
+	} while (progress);
+	this->pumpPending = false;
+}
+
+void QueueWaitList::check(QueueArrayBuffer & queue, int bytes, bool reader) {
+#ifndef BUFFER_COMPILE_TIME_ENDIAN
+	if (queue.endian == NOT_SET) {
+		BufferException bE(NOT_SET_ENDIAN);
+		throw bE;
+	}
+#endif
+	if (bytes > queue.capacity && !queue.growable) {
+		if (reader) {
+			BufferException bE(NOT_ENOUGH_DATA_TO_DEQUEUE);
+			throw bE;
+		}
+		BufferException bE(NOT_ENOUGH_SPACE_TO_PUSH);
+		throw bE;
+	}
+	QueueWaitList* list = of(queue);
+	if (currentLoop == NULL || (list != NULL && list->loop != currentLoop && (list->hasReaders() || list->hasWriters()))) {
+		BufferException bE(NOT_IN_EVENT_LOOP);
+		throw bE;
+	}
+}
+
+void QueueWaitList::wait(QueueArrayBuffer & queue, QueueWaiter * waiter, bool reader) {
+	QueueWaitList* list = of(queue);
+	if (list == NULL) {
+		while (list == NULL) list = new QueueWaitList(&queue);
+		queue.waiters = list;
+	}
+	if (list->loop != currentLoop) {
+		//Nobody waits on the queue (see check()), it moves to the loop of this coroutine
+		if (list->pumpPending && list->loop != NULL) list->loop->forget(list);
+		list->pumpPending = false;
+		list->loop = currentLoop;
+	}
+	append(reader ? list->readers : list->writers, waiter);
+}
+//Endsection: QueueWaitList implementation
+#pragma endregion QueueWaitList implementation
+#endif
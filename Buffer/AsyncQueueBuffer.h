@@ -0,0 +1,181 @@
+//Buffer library by Huynh Hoang Kha
+//C++20 coroutine awaitable enQueue/deQueue on QueueArrayBuffer and the single-threaded event loop (epoll/eventfd) that runs them
+#pragma once
+#ifndef _ASYNC_QUEUE_BUFFER_H_
+#define _ASYNC_QUEUE_BUFFER_H_
+#include "Buffer.h"
+
+#ifdef BUFFER_HAS_COROUTINES
+#include <atomic>
+#include <coroutine>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <vector>
+
+/*
+Coroutines run on an EventLoop, one thread: 'co_await queue.deQueueAsync<T>()' gives the first-joined T at once when
+the queue has it, otherwise the coroutine is suspended until an enQueue (by any coroutine of the loop or by plain
+code running on the loop thread) stores enough bytes. 'co_await queue.enQueueAsync(value)' waits for space the same way.
+Nothing spins: the queue tells its wait list when data is stored or taken, and the loop hands the data/space to the
+waiters in the order they started waiting before resuming them. When no coroutine is ready the loop sleeps in
+epoll_wait, on the descriptors awaited with readable()/writable() and on an eventfd that post() and stop() use
+to wake it up from other threads.
+
+QueueArrayBuffer is not thread safe: every coroutine and every piece of code touching a queue that coroutines wait on
+must run on the same loop thread. A queue must outlive the coroutines waiting on it, and must stay where it is
+(not moved) while they wait.
+*/
+class EventLoop;
+
+//Fire-and-forget coroutine: create it by calling a coroutine function returning BufferTask, start it with EventLoop::spawn()
+class BufferTask {
+public:
+	struct promise_type {
+		EventLoop* loop = NULL;
+		BufferTask get_return_object() { return BufferTask(std::coroutine_handle<promise_type>::from_promise(*this)); };
+		std::suspend_always initial_suspend() noexcept { return {}; };	//Started by spawn()
+		std::suspend_never final_suspend() noexcept { return {}; };		//The frame frees itself when the coroutine returns
+		void return_void() {};
+		void unhandled_exception();										//run() rethrows it
+		~promise_type();
+	};
+	explicit BufferTask(std::coroutine_handle<promise_type> handle) :handle(handle) {};
+	BufferTask(BufferTask&& obj) noexcept :handle(obj.handle) { obj.handle = NULL; };
+	BufferTask(const BufferTask&) = delete;
+	BufferTask& operator=(const BufferTask&) = delete;
+	~BufferTask() { if (this->handle) this->handle.destroy(); };	//Never spawned
+private:
+	friend class EventLoop;
+	std::coroutine_handle<promise_type> handle;
+};
+
+//Awaits an epoll event on a descriptor, co_await returns false if the descriptor can not be watched (errno is set)
+class DescriptorAwaiter {
+	EventLoop* loop;
+	int fileDescriptor;
+	uint32_t events;
+	bool watched;
+public:
+	DescriptorAwaiter(EventLoop* loop, int fileDescriptor, uint32_t events) :loop(loop), fileDescriptor(fileDescriptor), events(events), watched(false) {};
+	bool await_ready() { return false; };
+	bool await_suspend(std::coroutine_handle<> handle);
+	bool await_resume() { return this->watched; };
+};
+
+class EventLoop {
+	int epollDescriptor, wakeDescriptor;
+	std::deque<std::coroutine_handle<>> ready;		//Coroutines to resume, loop thread only
+	std::vector<QueueWaitList*> toPump;				//Wait lists of the queues that changed since they were last looked at
+	std::mutex postedLock;
+	std::vector<std::coroutine_handle<>> posted;	//Coroutines handed over by other threads
+	std::atomic<bool> stopping;
+	int liveTasks;									//Spawned coroutines that have not returned yet
+	int watchedDescriptors;							//Coroutines waiting in epoll
+	std::exception_ptr failure;
+	friend class BufferTask;
+	friend class QueueWaitList;
+	friend class DescriptorAwaiter;
+	void wake();									//Make epoll_wait return
+	void poll(int timeoutMilliseconds);				//Move the coroutines whose descriptors are ready (and the posted ones) to 'ready'
+	void pumpLater(QueueWaitList* list) { this->toPump.push_back(list); };
+	void forget(QueueWaitList* list);
+public:
+	EventLoop();		//Throw EVENT_LOOP_FAILED if the descriptors can not be created
+	~EventLoop();		//Coroutines ready to run are destroyed, the ones still waiting are never resumed
+	EventLoop(const EventLoop&) = delete;
+	EventLoop& operator=(const EventLoop&) = delete;
+	void spawn(BufferTask task);						//Start a coroutine on the next run() round, loop thread (or before run())
+	void schedule(std::coroutine_handle<> handle);		//Resume a suspended coroutine on the next round, loop thread only
+	void post(std::coroutine_handle<> handle);			//Same from any thread, wakes the loop up
+	void run();		//Run until every spawned coroutine has returned or stop() is called, rethrow the first exception a coroutine let out
+	void stop();	//Make run() return after the current round, from any thread
+	int getLiveTasks() { return this->liveTasks; };
+	DescriptorAwaiter readable(int fileDescriptor);		//co_await suspends until the descriptor has data (or hangs up)
+	DescriptorAwaiter writable(int fileDescriptor);		//co_await suspends until the descriptor accepts data
+	static EventLoop* current();						//The loop running on the calling thread, NULL outside run()
+};
+
+//A coroutine waiting on a queue, the queue's wait list calls 'attempt' when there may be enough data/space for it
+struct QueueWaiter {
+	std::coroutine_handle<> handle;
+	bool (*attempt)(QueueArrayBuffer& queue, QueueWaiter* waiter);	//Do the operation if possible, return false if it has to wait again
+	QueueWaiter* next;
+};
+
+//Waiters of one queue, created by the first coroutine that has to wait on it and deleted with the queue
+class QueueWaitList :public QueueWaiters {
+	QueueArrayBuffer* queue;
+	EventLoop* loop;
+	QueueWaiter* readers[2];	//First and last coroutine waiting for data
+	QueueWaiter* writers[2];	//First and last coroutine waiting for space
+	bool pumpPending;			//In the loop's 'toPump' list, or being pumped
+	static void append(QueueWaiter** list, QueueWaiter* waiter);
+	bool serve(QueueWaiter** list);	//Complete and schedule waiters from the head of the list, return true if one was
+public:
+	QueueWaitList(QueueArrayBuffer* queue) :queue(queue), loop(NULL), readers{ NULL, NULL }, writers{ NULL, NULL }, pumpPending(false) {};
+	~QueueWaitList();
+	void notify() override;
+	void pump();	//Hand data/space to the waiters until none can go on, called by the loop
+	bool hasReaders() { return this->readers[0] != NULL; };
+	bool hasWriters() { return this->writers[0] != NULL; };
+	static void wait(QueueArrayBuffer& queue, QueueWaiter* waiter, bool reader);	//Queue a suspended waiter on the queue's list, for the current loop
+	static QueueWaitList* of(QueueArrayBuffer& queue) { return static_cast<QueueWaitList*>(queue.waiters); };
+	static void check(QueueArrayBuffer& queue, int bytes, bool reader);	//Throw if a waiter for this operation could never be resumed
+};
+
+template <typename T>
+class QueueDeQueueAwaiter :private QueueWaiter {
+	QueueArrayBuffer& queue;
+	T value;
+	static bool attemptDeQueue(QueueArrayBuffer& queue, QueueWaiter* waiter) { return queue.deQueue(&static_cast<QueueDeQueueAwaiter*>(waiter)->value); };
+public:
+	QueueDeQueueAwaiter(QueueArrayBuffer& queue) :queue(queue) {};
+	//Newcomers do not overtake the coroutines already waiting for data
+	bool await_ready() {
+		QueueWaitList* list = QueueWaitList::of(this->queue);
+		if ((list == NULL || !list->hasReaders()) && this->queue.deQueue(&this->value)) return true;
+		QueueWaitList::check(this->queue, sizeof(T), true);
+		return false;
+	};
+	void await_suspend(std::coroutine_handle<> handle) {
+		this->handle = handle;
+		this->attempt = attemptDeQueue;
+		QueueWaitList::wait(this->queue, this, true);
+	};
+	T await_resume() { return this->value; };
+};
+
+template <typename T>
+class QueueEnQueueAwaiter :private QueueWaiter {
+	QueueArrayBuffer& queue;
+	T value;
+	static bool attemptEnQueue(QueueArrayBuffer& queue, QueueWaiter* waiter) { return queue.enQueue(static_cast<QueueEnQueueAwaiter*>(waiter)->value); };
+public:
+	QueueEnQueueAwaiter(QueueArrayBuffer& queue, T value) :queue(queue), value(value) {};
+	//Newcomers do not overtake the coroutines already waiting for space
+	bool await_ready() {
+		QueueWaitList* list = QueueWaitList::of(this->queue);
+		if ((list == NULL || !list->hasWriters()) && this->queue.enQueue(this->value)) return true;
+		QueueWaitList::check(this->queue, sizeof(T), false);
+		return false;
+	};
+	void await_suspend(std::coroutine_handle<> handle) {
+		this->handle = handle;
+		this->attempt = attemptEnQueue;
+		QueueWaitList::wait(this->queue, this, false);
+	};
+	void await_resume() {};
+};
+
+template<typename T>
+inline QueueDeQueueAwaiter<T> QueueArrayBuffer::deQueueAsync() {
+	return QueueDeQueueAwaiter<T>(*this);
+}
+
+template<typename T>
+inline QueueEnQueueAwaiter<T> QueueArrayBuffer::enQueueAsync(T input) {
+	return QueueEnQueueAwaiter<T>(*this, input);
+}
+#endif
+#endif // !_ASYNC_QUEUE_BUFFER_H_
@@ -0,0 +1,161 @@
+//Buffer library by Huynh Hoang Kha
+//This implement a blocking single-producer/single-consumer queue buffer
+#include <climits>
+#include <thread>
+#include "BlockingQueueBuffer.h"
+
+#ifdef __linux__
+#include <cerrno>
+#include <ctime>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#include <immintrin.h>
+#define CPU_RELAX() _mm_pause()
+#else
+#define CPU_RELAX() this_thread::yield()
+#endif
+
+#pragma region BlockingQueueArrayBuffer implementation
+//------------------------------------------------------------------------------------------------------------
+//Section: BlockingQueueArrayBuffer implementation
+BlockingQueueArrayBuffer::BlockingQueueArrayBuffer(int capacity, Endian systemEndian) :queue(capacity, systemEndian) {
+	this->endian = systemEndian;
+	this->spinCount = BLOCKING_QUEUE_SPIN_COUNT;
+	this->wakeBytes = INT_MAX;
+	this->wakeItems = 1;
+	this->dataSignal.store(0, memory_order_relaxed);
+	this->sleepingConsumers.store(0, memory_order_relaxed);
+	this->pendingBytes = 0;
+	this->pendingItems = 0;
+	this->spaceSignal.store(0, memory_order_relaxed);
+	this->sleepingProducers.store(0, memory_order_relaxed);
+	this->sleeps.store(0, memory_order_relaxed);
+	this->wakeCalls.store(0, memory_order_relaxed);
+}
+
+void BlockingQueueArrayBuffer::setWakeBatch(int bytes, int items) {
+	this->wakeBytes = bytes < 1 ? 1 : bytes;
+	this->wakeItems = items < 1 ? 1 : items;
+}
+
+//The fence orders the data just published before the look at the consumer's flag, the consumer raises the flag
+//before its last look at the data: one of the two sees the other, so a wake can not be missed
+void BlockingQueueArrayBuffer::flush() {
+	if (this->pendingItems == 0) return;
+	this->pendingBytes = 0;
+	this->pendingItems = 0;
+	atomic_thread_fence(memory_order_seq_cst);
+	//Clearing the flag makes sure one sleep costs one wake, however many values come before the consumer runs again
+	if (this->sleepingConsumers.load(memory_order_relaxed) == 0 || this->sleepingConsumers.exchange(0, memory_order_relaxed) == 0) return;
+	this->dataSignal.fetch_add(1, memory_order_release);
+	this->unpark(this->dataSignal);
+}
+
+//Same handshake for the producer waiting for space, without batching: it waits only when the ring is full
+void BlockingQueueArrayBuffer::taken() {
+	atomic_thread_fence(memory_order_seq_cst);
+	if (this->sleepingProducers.load(memory_order_relaxed) == 0 || this->sleepingProducers.exchange(0, memory_order_relaxed) == 0) return;
+	this->spaceSignal.fetch_add(1, memory_order_release);
+	this->unpark(this->spaceSignal);
+}
+
+bool BlockingQueueArrayBuffer::enQueueBlock(const void * memPtr, int blockSize) {
+	if (!this->queue.enQueueBlock(memPtr, blockSize)) return false;
+	this->stored(blockSize);
+	return true;
+}
+
+bool BlockingQueueArrayBuffer::deQueueBlock(void * memPtr, int blockSize) {
+	if (!this->queue.deQueueBlock(memPtr, blockSize)) return false;
+	this->taken();
+	return true;
+}
+
+bool BlockingQueueArrayBuffer::enQueueBlockWait(const void * memPtr, int blockSize, int timeoutMilliseconds) {
+	return this->waitFor(false, (void*)memPtr, blockSize, timeoutMilliseconds);
+}
+
+bool BlockingQueueArrayBuffer::deQueueBlockWait(void * memPtr, int blockSize, int timeoutMilliseconds) {
+	return this->waitFor(true, memPtr, blockSize, timeoutMilliseconds);
+}
+
+bool BlockingQueueArrayBuffer::attempt(bool consumer, void * memPtr, int blockSize) {
+	return consumer ? this->deQueueBlock(memPtr, blockSize) : this->enQueueBlock(memPtr, blockSize);
+}
+
+bool BlockingQueueArrayBuffer::waitFor(bool consumer, void * memPtr, int blockSize, int timeoutMilliseconds) {
+	if (this->attempt(consumer, memPtr, blockSize)) return true;
+	if (blockSize < 0 || blockSize > this->queue.getCapacity()) return false;	//Would never fit
+	//The consumer may be asleep waiting for a batch that can not fill up before it makes room
+	if (!consumer) this->flush();
+	for (int i = 0; i < this->spinCount; i++) {
+		CPU_RELAX();
+		if (this->attempt(consumer, memPtr, blockSize)) return true;
+	}
+	if (timeoutMilliseconds == 0) return false;
+	chrono::steady_clock::time_point deadline = chrono::steady_clock::now() + chrono::milliseconds(timeoutMilliseconds);
+	atomic<uint32_t>& signal = consumer ? this->dataSignal : this->spaceSignal;
+	atomic<int>& sleeping = consumer ? this->sleepingConsumers : this->sleepingProducers;
+	for (;;) {
+		//Read the signal before the last look at the queue: a wake after that look changes it and the sleep returns at once
+		uint32_t expected = signal.load(memory_order_acquire);
+		sleeping.store(1, memory_order_relaxed);
+		atomic_thread_fence(memory_order_seq_cst);
+		bool done = this->attempt(consumer, memPtr, blockSize);
+		bool inTime = true;
+		if (!done) {
+			this->sleeps.fetch_add(1, memory_order_relaxed);
+			inTime = this->park(signal, expected, timeoutMilliseconds < 0 ? NULL : &deadline);
+		}
+		sleeping.store(0, memory_order_relaxed);
+		if (done) return true;
+		if (!inTime) return this->attempt(consumer, memPtr, blockSize);
+		if (this->attempt(consumer, memPtr, blockSize)) return true;
+	}
+}
+
+#ifdef __linux__
+static_assert(sizeof(atomic<uint32_t>) == sizeof(uint32_t), "The futex word must be a plain 32-bit integer");
+
+bool BlockingQueueArrayBuffer::park(atomic<uint32_t>& signal, uint32_t expected, const chrono::steady_clock::time_point * deadline) {
+	timespec timeout;
+	if (deadline != NULL) {
+		long long nanoseconds = chrono::duration_cast<chrono::nanoseconds>(*deadline - chrono::steady_clock::now()).count();
+		if (nanoseconds <= 0) return false;
+		timeout.tv_sec = (time_t)(nanoseconds / 1000000000);
+		timeout.tv_nsec = (long)(nanoseconds % 1000000000);
+	}
+	//Returns at once (EAGAIN) if the signal already changed, EINTR and spurious wake-ups are left to the caller's loop
+	syscall(SYS_futex, (uint32_t*)&signal, FUTEX_WAIT_PRIVATE, expected, deadline != NULL ? &timeout : NULL, NULL, 0);
+	return deadline == NULL || chrono::steady_clock::now() < *deadline;
+}
+
+void BlockingQueueArrayBuffer::unpark(atomic<uint32_t>& signal) {
+	this->wakeCalls.fetch_add(1, memory_order_relaxed);
+	syscall(SYS_futex, (uint32_t*)&signal, FUTEX_WAKE_PRIVATE, INT_MAX, NULL, NULL, 0);
+}
+#else
+bool BlockingQueueArrayBuffer::park(atomic<uint32_t>& signal, uint32_t expected, const chrono::steady_clock::time_point * deadline) {
+	unique_lock<mutex> guard(this->parkLock);
+	while (signal.load(memory_order_acquire) == expected) {
+		if (deadline == NULL) this->parked.wait(guard);
+		else if (this->parked.wait_until(guard, *deadline) == cv_status::timeout) return signal.load(memory_order_acquire) != expected;
+	}
+	return true;
+}
+
+//Taking the lock after the signal changed makes sure a sleeper is either woken or sees the new value
+void BlockingQueueArrayBuffer::unpark(atomic<uint32_t>& signal) {
+	this->wakeCalls.fetch_add(1, memory_order_relaxed);
+	{
+		lock_guard<mutex> guard(this->parkLock);
+	}
+	this->parked.notify_all();
+}
+#endif
+//Endsection: BlockingQueueArrayBuffer implementation
+#pragma endregion BlockingQueueArrayBuffer implementation
@@ -0,0 +1,149 @@
+//Buffer library by Huynh Hoang Kha
+//This implement a blocking single-producer/single-consumer queue buffer
+//Waiting calls spin briefly, then sleep on a futex (Linux) or a condition variable (other systems)
+#pragma once
+#ifndef _BLOCKING_QUEUE_BUFFER_H_
+#define _BLOCKING_QUEUE_BUFFER_H_
+#include <atomic>
+#include <chrono>
+#ifndef __linux__
+#include <condition_variable>
+#include <mutex>
+#endif
+#include "SPSCQueueBuffer.h"
+
+#define BLOCKING_QUEUE_SPIN_COUNT 128	//Default number of retries before a waiting call goes to sleep
+
+#pragma region BlockingQueueArrayBuffer
+/*
+An SPSCQueueArrayBuffer with waiting versions of enQueue/deQueue for thread pipelines: exactly one producer thread
+calls the enQueue methods and flush(), exactly one consumer thread calls the deQueue methods.
+
+- deQueue...Wait/enQueue...Wait retry 'spinCount' times, then sleep until the other side signals or the timeout
+  passes (timeoutMilliseconds < 0 waits forever, 0 never sleeps). They return false only on timeout.
+- A side only makes the wake system call when the other side has announced it is sleeping, so a busy pipeline makes
+  no system call at all.
+- setWakeBatch(bytes, items): a sleeping consumer is woken once the producer has stored that many bytes or values
+  since the last wake (1 value by default). The producer wakes it earlier when it has to wait for space itself and on
+  flush(): call flush() at the end of a burst, or the consumer sleeps until the batch fills up or its timeout passes.
+*/
+class BlockingQueueArrayBuffer :public Queue<uint8_t>, public CacheAligned {
+	SPSCQueueArrayBuffer queue;
+	Endian endian;
+	int spinCount;
+	int wakeBytes, wakeItems;
+	//Producer side: what it stored since it last signaled, and the word the consumer sleeps on
+	alignas(BUFFER_CACHE_LINE_SIZE) atomic<uint32_t> dataSignal;	//Incremented by each wake, the consumer sleeps while it does not change
+	atomic<int> sleepingConsumers;		//1 while the consumer sleeps or is about to, cleared by the wake
+	int pendingBytes, pendingItems;
+	//Consumer side: the word the producer sleeps on
+	alignas(BUFFER_CACHE_LINE_SIZE) atomic<uint32_t> spaceSignal;
+	atomic<int> sleepingProducers;		//1 while the producer sleeps or is about to, cleared by the wake
+	alignas(BUFFER_CACHE_LINE_SIZE) atomic<long long> sleeps;		//Times a waiting call went to sleep
+	atomic<long long> wakeCalls;									//Wake system calls made
+#ifndef __linux__
+	mutex parkLock;
+	condition_variable parked;
+#endif
+	void stored(int bytes) {
+		this->pendingBytes += bytes;
+		if (++this->pendingItems >= this->wakeItems || this->pendingBytes >= this->wakeBytes) this->flush();
+	};
+	void taken();
+	bool attempt(bool consumer, void* memPtr, int blockSize);
+	bool waitFor(bool consumer, void* memPtr, int blockSize, int timeoutMilliseconds);
+	bool park(atomic<uint32_t>& signal, uint32_t expected, const chrono::steady_clock::time_point* deadline);	//Return false once the deadline has passed
+	void unpark(atomic<uint32_t>& signal);
+public:
+	//Construct this BlockingQueueArrayBuffer with the size 'capacity'
+	BlockingQueueArrayBuffer(int capacity, Endian systemEndian);
+	BlockingQueueArrayBuffer(const BlockingQueueArrayBuffer&) = delete;
+	BlockingQueueArrayBuffer& operator=(const BlockingQueueArrayBuffer&) = delete;
+	int getCapacity() { return this->queue.getCapacity(); };	//Return buffer's capacity
+	int getSize() { return this->queue.getSize(); };			//Return number of bytes stored in the buffer, see SPSCQueueArrayBuffer
+	bool isEmpty() { return this->queue.isEmpty(); };
+	bool isFull() { return this->queue.isFull(); };
+	//Tuning, before the threads start
+	void setSpinCount(int spinCount) { this->spinCount = spinCount < 0 ? 0 : spinCount; };
+	void setWakeBatch(int bytes, int items);		//Wake a sleeping consumer after 'bytes' bytes or 'items' values, whichever comes first
+	void flush();									//Producer: wake a sleeping consumer now if anything was stored since the last wake
+	long long getSleepCount() { return this->sleeps.load(memory_order_relaxed); };		//Times a waiting call slept, both sides
+	long long getWakeCount() { return this->wakeCalls.load(memory_order_relaxed); };	//Wake system calls made, both sides
+	//Block methods, called by the producer (enQueue...) or the consumer (deQueue...) only
+	bool enQueueBlock(const void* memPtr, int blockSize);	//Copy 'blockSize' bytes from memPtr to the end of the queue, return false if there is not enough space
+	bool deQueueBlock(void* memPtr, int blockSize);			//Move the 'blockSize' first-joined bytes out of the queue into memPtr, return false if there is not enough data
+	bool enQueueBlockWait(const void* memPtr, int blockSize, int timeoutMilliseconds = -1);	//Wait for space, return false on timeout or if the block is bigger than the queue
+	bool deQueueBlockWait(void* memPtr, int blockSize, int timeoutMilliseconds = -1);		//Wait for the data, return false on timeout or if the block is bigger than the queue
+	//Templates for all queue's methods
+	template <typename T> bool enQueue(T input);
+	template <typename T> bool deQueue(T* output);
+	template <typename T> bool enQueueWait(T input, int timeoutMilliseconds = -1);
+	template <typename T> bool deQueueWait(T* output, int timeoutMilliseconds = -1);
+	//Methods must be implemented to complete the Queue<uint8_t> interface
+	bool enQueue(uint8_t dataIn) { return this->enQueue<uint8_t>(dataIn); };			//Push a byte to the queue, return true if insertion was OK
+	bool deQueue(uint8_t* dataOut) { return this->deQueue<uint8_t>(dataOut); };		//Return the first-joined byte in the queue and then remove it from the queue
+	//Queue methods for char
+	bool enQueueChar(char dataIn) { return this->enQueue(dataIn); };		//Push a char to the queue, return true if insertion was OK
+	bool deQueueChar(char* dataOut) { return this->deQueue(dataOut); };		//Return the first-joined char in the queue and then remove it from the queue
+	bool enQueueCharWait(char dataIn, int timeoutMilliseconds = -1) { return this->enQueueWait(dataIn, timeoutMilliseconds); };
+	bool deQueueCharWait(char* dataOut, int timeoutMilliseconds = -1) { return this->deQueueWait(dataOut, timeoutMilliseconds); };
+	//Queue methods for int
+	bool enQueueInt(int dataIn) { return this->enQueue(dataIn); };			//Push an int to the queue, return true if insertion was OK
+	bool deQueueInt(int* dataOut) { return this->deQueue(dataOut); };		//Return the first-joined int in the queue and then remove it from the queue
+	bool enQueueIntWait(int dataIn, int timeoutMilliseconds = -1) { return this->enQueueWait(dataIn, timeoutMilliseconds); };
+	bool deQueueIntWait(int* dataOut, int timeoutMilliseconds = -1) { return this->deQueueWait(dataOut, timeoutMilliseconds); };
+	//Queue methods for float
+	bool enQueueFloat(float dataIn) { return this->enQueue(dataIn); };		//Push a float to the queue, return true if insertion was OK
+	bool deQueueFloat(float* dataOut) { return this->deQueue(dataOut); };	//Return the first-joined float in the queue and then remove it from the queue
+	bool enQueueFloatWait(float dataIn, int timeoutMilliseconds = -1) { return this->enQueueWait(dataIn, timeoutMilliseconds); };
+	bool deQueueFloatWait(float* dataOut, int timeoutMilliseconds = -1) { return this->deQueueWait(dataOut, timeoutMilliseconds); };
+	//Queue methods for long
+	bool enQueueLong(long dataIn) { return this->enQueue(dataIn); };		//Push a long to the queue, return true if insertion was OK
+	bool deQueueLong(long* dataOut) { return this->deQueue(dataOut); };		//Return the first-joined long in the queue and then remove it from the queue
+	bool enQueueLongWait(long dataIn, int timeoutMilliseconds = -1) { return this->enQueueWait(dataIn, timeoutMilliseconds); };
+	bool deQueueLongWait(long* dataOut, int timeoutMilliseconds = -1) { return this->deQueueWait(dataOut, timeoutMilliseconds); };
+	//Queue methods for double
+	bool enQueueDouble(double dataIn) { return this->enQueue(dataIn); };	//Push a double to the queue, return true if insertion was OK
+	bool deQueueDouble(double* dataOut) { return this->deQueue(dataOut); };	//Return the first-joined double in the queue and then remove it from the queue
+	bool enQueueDoubleWait(double dataIn, int timeoutMilliseconds = -1) { return this->enQueueWait(dataIn, timeoutMilliseconds); };
+	bool deQueueDoubleWait(double* dataOut, int timeoutMilliseconds = -1) { return this->deQueueWait(dataOut, timeoutMilliseconds); };
+};
+#pragma endregion BlockingQueueArrayBuffer
+
+#pragma region BlockingQueueArrayBuffer templates
+template<typename T>
+inline bool BlockingQueueArrayBuffer::enQueue(T dataIn) {
+	uint8_t bytes[sizeof(T)];
+	if (!encodePrimity(bytes, dataIn, this->endian)) return false;
+	return this->enQueueBlock(bytes, sizeof(T));
+}
+
+template<typename T>
+inline bool BlockingQueueArrayBuffer::deQueue(T* dataOut) {
+#ifndef BUFFER_COMPILE_TIME_ENDIAN
+	if (this->endian == NOT_SET) return false;
+#endif
+	uint8_t bytes[sizeof(T)];
+	if (!this->deQueueBlock(bytes, sizeof(T))) return false;
+	return decodePrimity(bytes, dataOut, this->endian);
+}
+
+template<typename T>
+inline bool BlockingQueueArrayBuffer::enQueueWait(T dataIn, int timeoutMilliseconds) {
+	uint8_t bytes[sizeof(T)];
+	if (!encodePrimity(bytes, dataIn, this->endian)) return false;
+	return this->enQueueBlockWait(bytes, sizeof(T), timeoutMilliseconds);
+}
+
+//Checked first, a queue without endian would make the consumer wait for nothing
+template<typename T>
+inline bool BlockingQueueArrayBuffer::deQueueWait(T* dataOut, int timeoutMilliseconds) {
+#ifndef BUFFER_COMPILE_TIME_ENDIAN
+	if (this->endian == NOT_SET) return false;
+#endif
+	uint8_t bytes[sizeof(T)];
+	if (!this->deQueueBlockWait(bytes, sizeof(T), timeoutMilliseconds)) return false;
+	return decodePrimity(bytes, dataOut, this->endian);
+}
+#pragma endregion BlockingQueueArrayBuffer templates
+#endif // !_BLOCKING_QUEUE_BUFFER_H_
@@ -3,28 +3,60 @@
 //Using linked list and array
 #pragma warning (disable: 4996)
 #pragma warning (disable: 4018) //This warning is in control!
+#include <algorithm>
+#include <climits>
 #include "Buffer.h"
+#include "QueueJournal.h"
+#if defined(__unix__) || defined(__APPLE__)
+#include <cerrno>
+#include <sys/uio.h>
+#endif
 
 #pragma region BufferException implementation
 //------------------------------------------------------------------------------------------------------------
 //Section: BufferException implementation
-BufferException::BufferException(int code, const char* message) {
+BufferException::BufferException(int code, const char* message) noexcept {
 	this->exceptionCode = code;
-	this->msgPtr = NULL;
-	while (this->msgPtr == NULL) this->msgPtr = new char[strlen(message) + 1];
-	strcpy(this->msgPtr, message);
+	this->msgPtr = message;
 }
 
-BufferException::BufferException(const BufferException & obj) {
-	this->exceptionCode = obj.exceptionCode;
-	this->msgPtr = NULL;
-	while (this->msgPtr == NULL) this->msgPtr = new char[strlen(obj.msgPtr) + 1];
-	strcpy(this->msgPtr, obj.msgPtr);
+BufferException::BufferException(ExceptionErrorCode code) noexcept {
+	this->exceptionCode = code;
+	this->msgPtr = getErrorMessage(code);
 }
 
-BufferException::~BufferException() { delete[] this->msgPtr;}
 string BufferException::getMessage() { return string(msgPtr);}
 int BufferException::getCode() { return this->exceptionCode;}
+
+const char* getErrorMessage(ExceptionErrorCode code) noexcept {
+	switch (code) {
+	case EMPTY_INITIALIZATION_STRING: return "Cannot initialize a buffer with a null string";
+	case NEGATIVE_CAPACITY: return "Invalid buffer capacity. It's can not be negative.!";
+	case NEGATIVE_SIZE: return "Invalid buffer size. It's can not be negative.!";
+	case SIZE_BIGGER_THAN_CAPACITY: return "Invalid buffer size. It's can not be lagger than capacity.!";
+	case NEGATIVE_INDEX: return "Index can not be negative.";
+	case OUT_OF_RANGE_INDEX: return "Index out of range.";
+	case NOT_SET_ENDIAN: return "Please set Endian to be BIG_ENDIAN or LITTLE_ENDIAN according to your system.";
+	case POP_FROM_EMPTY_STACK: return "Cannot pop from an empty stack";
+	case ACCESS_TO_EMPTY_STACK: return "Cannot access the top of an empty stack";
+	case PUSH_TO_FULL_STACK: return "Cannot push to a full stack";
+	case NOT_ENOUGH_DATA_TO_POP: return "Data in the stack is not enough to pop";
+	case NOT_ENOUGH_DATA_TO_TOP: return "Data in the stack is not enough to top";
+	case NOT_ENOUGH_SPACE_TO_PUSH: return "Space in the stack is not enough to push";
+	case FILE_OPEN_FAILED: return "Cannot open the file to map.";
+	case FILE_MAP_FAILED: return "Cannot map the file into memory.";
+	case FILE_TOO_LARGE: return "The file is bigger than a buffer can hold, map it through fileOffset/length windows.";
+	case NOT_ENOUGH_DATA_TO_DEQUEUE: return "Data in the queue is not enough to dequeue";
+	case NOT_IN_EVENT_LOOP: return "Coroutines can only wait on a queue from a running EventLoop, the same one for all the waiters of the queue.";
+	case EVENT_LOOP_FAILED: return "Cannot create the epoll/eventfd descriptors of the event loop.";
+	case READ_ONLY_BUFFER: return "The buffer is read-only.";
+	case CAPACITY_TOO_LARGE: return "Invalid buffer capacity. It's can not be rounded up to a power of two that fits in an int.";
+	case INVALID_CHUNK_SIZE: return "Invalid chunk size. It must be positive.!";
+	case NO_EXCEPTION: return "No error.";
+	case UNKNOWN_EXCEPTION: return "Something wrong when calling getPrimity method.";
+	default: return "Unknown buffer error.";
+	}
+}
 //Endsection: BufferException implementation
 #pragma endregion BufferException implementation
 
@@ -49,206 +81,442 @@ bool Buffer::getChar(int index, char *outputChar) { return getByte(index, (uint8
 #pragma region ArrayBuffer implementation
 //------------------------------------------------------------------------------------------------------------
 //Section: ArrayBuffer implementation
+uint8_t * ArrayBuffer::allocateBlock(int capacity, int * blockCapacity, bool * pooled) {
+	*pooled = BufferPool::isEnabled();
+	if (*pooled) return BufferPool::acquire(capacity, blockCapacity);
+	uint8_t* block = NULL;
+	while (block == NULL) block = new uint8_t[capacity];
+	memset((void*)block, '\0', capacity);
+	*blockCapacity = capacity;
+	return block;
+}
+
+void ArrayBuffer::freeBlock(uint8_t * block, int blockCapacity, bool pooled) {
+	if (block == NULL) return;
+	if (pooled) BufferPool::release(block, blockCapacity);
+	else delete[] block;
+}
+
 ArrayBuffer::ArrayBuffer(int capacity, Endian systemEndian) {
 	if (capacity < 0) {
-		BufferException bE(NEGATIVE_CAPACITY, "Invalid buffer capacity. It's can not be negative.!");
+		BufferException bE(NEGATIVE_CAPACITY);
 		throw bE;
 	}
 	this->endian = systemEndian;
-	this->arrayPointer = NULL;
-	while (this->arrayPointer == NULL) this->arrayPointer = new uint8_t[capacity];
+	this->growable = false;
+	this->runningChecksum = false;
+	this->runningCrc = 0;
+	this->readOnly = false;
+	this->borrowed = false;
+	this->arrayPointer = allocateBlock(capacity, &this->blockCapacity, &this->pooled);
 	this->capacity = capacity;
 	this->size = 0;
-	memset((void*)this->arrayPointer, '\0', capacity);
 }
 
-ArrayBuffer::ArrayBuffer(void * memPtr, int capacity, int dataSize, Endian systemEndian) {
+ArrayBuffer::ArrayBuffer(void * memPtr, int capacity, int dataSize, Endian systemEndian, MemoryMode memoryMode) {
 	if (capacity < 0) {
-		BufferException bE(NEGATIVE_CAPACITY, "Invalid buffer capacity. It's can not be negative.!");
+		BufferException bE(NEGATIVE_CAPACITY);
 		throw bE;
 	}
 	if (dataSize < 0){
-		BufferException bE(NEGATIVE_SIZE, "Invalid buffer size. It's can not be negative.!");
+		BufferException bE(NEGATIVE_SIZE);
 		throw bE;
 	}
 	if (dataSize > capacity) {
-		BufferException bE(SIZE_BIGGER_THAN_CAPACITY, "Invalid buffer size. It's can not be lagger than capacity.!");
+		BufferException bE(SIZE_BIGGER_THAN_CAPACITY);
 		throw bE;
 	}
 	this->endian = systemEndian;
-	this->arrayPointer = NULL;
-	while (this->arrayPointer == NULL) this->arrayPointer = new uint8_t[capacity];
+	this->growable = false;
+	this->runningChecksum = false;
+	this->runningCrc = 0;
+	this->readOnly = false;
 	this->capacity = capacity;
 	this->size = dataSize;
-	memset((void*)this->arrayPointer, '\0', capacity);
-	memcpy((void*)this->arrayPointer, memPtr, dataSize);
+	this->borrowed = (memoryMode == BORROW_MEMORY);
+	if (this->borrowed) {
+		this->arrayPointer = (uint8_t*)memPtr;
+		this->blockCapacity = capacity;
+		this->pooled = false;
+	}
+	else {
+		this->arrayPointer = allocateBlock(capacity, &this->blockCapacity, &this->pooled);
+		memcpy((void*)this->arrayPointer, memPtr, dataSize);
+	}
 }
 
 ArrayBuffer::ArrayBuffer(string inputString, Endian systemEndian) {
 	if (inputString.length() == 0) {
-		BufferException bE(EMPTY_INITIALIZATION_STRING, "Cannot initialize a buffer with a null string");
+		BufferException bE(EMPTY_INITIALIZATION_STRING);
 		throw bE;
 	}
 	this->capacity = (this->size = inputString.length());
-	this->arrayPointer = NULL;
-	while (this->arrayPointer == NULL) this->arrayPointer = new uint8_t[this->capacity];
-	for (int i = 0; i < this->size; i++) this->arrayPointer[i] = inputString[i];
+	this->growable = false;
+	this->runningChecksum = false;
+	this->runningCrc = 0;
+	this->readOnly = false;
+	this->borrowed = false;
+	this->arrayPointer = allocateBlock(this->capacity, &this->blockCapacity, &this->pooled);
+	memcpy((void*)this->arrayPointer, inputString.data(), this->size);
 	this->endian = systemEndian;
 }
 
 ArrayBuffer::ArrayBuffer(int capacity, string inputString, Endian systemEndian) {
 	int inputStringLength = inputString.length();
+	this->growable = false;
+	this->runningChecksum = false;
+	this->runningCrc = 0;
+	this->readOnly = false;
+	this->borrowed = false;
 	if (capacity < 0) {
-		BufferException bE(NEGATIVE_CAPACITY, "Invalid buffer capacity. It's can not be negative.!");
+		BufferException bE(NEGATIVE_CAPACITY);
 		throw bE;
 	}
 	if (inputStringLength >= capacity) {
 		this->capacity = capacity;
-		this->arrayPointer = NULL;
-		while (this->arrayPointer == NULL) this->arrayPointer = new uint8_t[capacity];
-		memset((void*)this->arrayPointer, '\0', capacity);
-		for (this->size = 0; this->size + 1 < capacity; this->size++) {
-			this->arrayPointer[this->size] = inputString[this->size];
-		}
+		this->arrayPointer = allocateBlock(capacity, &this->blockCapacity, &this->pooled);
+		this->size = capacity > 0 ? capacity - 1 : 0;
+		memcpy((void*)this->arrayPointer, inputString.data(), this->size);
 	}
 	else {
 		this->size = inputStringLength;
 		this->capacity = capacity;
-		this->arrayPointer = NULL;
-		while (this->arrayPointer == NULL) this->arrayPointer = new uint8_t[capacity];
-		memset((void*)this->arrayPointer, '\0', capacity);
-		for (int i = 0; i < this->size; i++) {
-			this->arrayPointer[i] = inputString[i];
-		}
+		this->arrayPointer = allocateBlock(capacity, &this->blockCapacity, &this->pooled);
+		memcpy((void*)this->arrayPointer, inputString.data(), this->size);
 	}
 	this->endian = systemEndian;
 }
 
+ArrayBuffer::ArrayBuffer(const ArrayBuffer & obj) :Buffer(obj) {
+	this->growable = obj.growable;
+	this->runningChecksum = obj.runningChecksum;
+	this->runningCrc = obj.runningCrc;
+	this->borrowed = false;
+	this->readOnly = false;
+	this->arrayPointer = allocateBlock(this->capacity, &this->blockCapacity, &this->pooled);
+	if (this->capacity > 0) memcpy((void*)this->arrayPointer, (void*)obj.arrayPointer, this->capacity);
+}
+
+ArrayBuffer::ArrayBuffer(ArrayBuffer && obj) noexcept :Buffer(obj) {
+	this->growable = obj.growable;
+	this->runningChecksum = obj.runningChecksum;
+	this->runningCrc = obj.runningCrc;
+	this->arrayPointer = obj.arrayPointer;
+	this->blockCapacity = obj.blockCapacity;
+	this->pooled = obj.pooled;
+	this->borrowed = obj.borrowed;
+	this->readOnly = obj.readOnly;
+	obj.arrayPointer = NULL;
+	obj.blockCapacity = 0;
+	obj.capacity = 0;
+	obj.size = 0;
+}
+
+ArrayBuffer & ArrayBuffer::operator=(const ArrayBuffer & obj) {
+	if (this == &obj) return *this;
+	int newBlockCapacity;
+	bool newPooled;
+	uint8_t* newArray = allocateBlock(obj.capacity, &newBlockCapacity, &newPooled);
+	if (obj.capacity > 0) memcpy((void*)newArray, (void*)obj.arrayPointer, obj.capacity);
+	this->releaseArray();
+	this->arrayPointer = newArray;
+	this->blockCapacity = newBlockCapacity;
+	this->pooled = newPooled;
+	this->borrowed = false;
+	this->readOnly = false;
+	this->capacity = obj.capacity;
+	this->size = obj.size;
+	this->endian = obj.endian;
+	this->growable = obj.growable;
+	this->runningChecksum = obj.runningChecksum;
+	this->runningCrc = obj.runningCrc;
+	return *this;
+}
+
+ArrayBuffer & ArrayBuffer::operator=(ArrayBuffer && obj) noexcept {
+	if (this == &obj) return *this;
+	this->releaseArray();
+	this->arrayPointer = obj.arrayPointer;
+	this->blockCapacity = obj.blockCapacity;
+	this->pooled = obj.pooled;
+	this->borrowed = obj.borrowed;
+	this->readOnly = obj.readOnly;
+	this->capacity = obj.capacity;
+	this->size = obj.size;
+	this->endian = obj.endian;
+	this->growable = obj.growable;
+	this->runningChecksum = obj.runningChecksum;
+	this->runningCrc = obj.runningCrc;
+	obj.arrayPointer = NULL;
+	obj.blockCapacity = 0;
+	obj.capacity = 0;
+	obj.size = 0;
+	return *this;
+}
+
+void ArrayBuffer::releaseArray() {
+	if (!this->borrowed) freeBlock(this->arrayPointer, this->blockCapacity, this->pooled);
+	this->arrayPointer = NULL;
+}
+
 ArrayBuffer::~ArrayBuffer() {
-	if (this->arrayPointer != NULL) {
-		delete[] this->arrayPointer;
-		this->arrayPointer = NULL;
-	}
+	this->releaseArray();
 }
 
 void ArrayBuffer::clean() {
+	if (this->readOnly) {
+		BufferException bE(READ_ONLY_BUFFER);
+		throw bE;
+	}
 	this->size = 0;
-	memset((void*)this->arrayPointer, '\0', this->capacity);
+#ifdef BUFFER_INSTRUMENTATION
+	this->instrumentation.noteClean();
+#endif
+	if (this->arrayPointer != NULL) memset((void*)this->arrayPointer, '\0', this->capacity);
+}
+
+uint32_t ArrayBuffer::getCrc32c() {
+	return crc32c(this->arrayPointer, this->size);
+}
+
+bool ArrayBuffer::getCrc32c(int offset, int size, uint32_t * outputCrc) {
+	if (offset < 0 || size < 0 || offset + size > this->size) return false;
+	*outputCrc = crc32c(this->arrayPointer + offset, size);
+	return true;
+}
+
+int ArrayBuffer::find(uint8_t value, int from) {
+	if (from < 0) from = 0;
+	if (from >= this->size) return -1;
+	int found = scanForByte(this->arrayPointer + from, this->size - from, value);
+	return found < 0 ? -1 : from + found;
+}
+
+int ArrayBuffer::findAny(const void * set, int setSize, int from) {
+	if (from < 0) from = 0;
+	if (from >= this->size) return -1;
+	int found = scanForAny(this->arrayPointer + from, this->size - from, (const uint8_t*)set, setSize);
+	return found < 0 ? -1 : from + found;
+}
+
+//An empty pattern is found right at 'from'
+int ArrayBuffer::find(const void * pattern, int patternSize, int from) {
+	if (from < 0) from = 0;
+	if (from > this->size) return -1;
+	int found = scanForPattern(this->arrayPointer + from, this->size - from, (const uint8_t*)pattern, patternSize);
+	return found < 0 ? -1 : from + found;
+}
+
+BufferStatsSnapshot ArrayBuffer::getStats() {
+#ifdef BUFFER_INSTRUMENTATION
+	return this->instrumentation.snapshot();
+#else
+	BufferStatsSnapshot stats;
+	memset(&stats, 0, sizeof(stats));
+	return stats;
+#endif
+}
+
+void ArrayBuffer::resetStats() {
+#ifdef BUFFER_INSTRUMENTATION
+	this->instrumentation.reset();
+#endif
+}
+
+bool ArrayBuffer::reserve(int newCapacity) {
+	if (newCapacity <= this->capacity) return true;
+	if (newCapacity <= this->blockCapacity) {
+		//The block (from the pool) is already big enough
+		memset((void*)(this->arrayPointer + this->capacity), '\0', newCapacity - this->capacity);
+		this->capacity = newCapacity;
+		return true;
+	}
+	int newBlockCapacity;
+	bool newPooled;
+	uint8_t* newArray = allocateBlock(newCapacity, &newBlockCapacity, &newPooled);
+	//Keep the whole old array: the write methods may have stored data beyond 'size'
+	if (this->capacity > 0) memcpy((void*)newArray, (void*)this->arrayPointer, this->capacity);
+	memset((void*)(newArray + this->capacity), '\0', newCapacity - this->capacity);
+	this->releaseArray();
+	this->arrayPointer = newArray;
+	this->blockCapacity = newBlockCapacity;
+	this->pooled = newPooled;
+	this->borrowed = false;
+	this->capacity = newCapacity;
+	return true;
+}
+
+bool ArrayBuffer::shrinkToFit() {
+	if (this->size == this->capacity) return true;
+	int newBlockCapacity;
+	bool newPooled;
+	uint8_t* newArray = allocateBlock(this->size, &newBlockCapacity, &newPooled);
+	if (this->size > 0) memcpy((void*)newArray, (void*)this->arrayPointer, this->size);
+	this->releaseArray();
+	this->arrayPointer = newArray;
+	this->blockCapacity = newBlockCapacity;
+	this->pooled = newPooled;
+	this->borrowed = false;
+	this->capacity = this->size;
+	return true;
+}
+
+bool ArrayBuffer::grow(int extraBytes) {
+	if (!this->growable || extraBytes > INT_MAX - this->size) return false;
+	int needed = this->size + extraBytes;
+	//Doubling keeps the amortized cost of a push/enQueue constant
+	int newCapacity = this->capacity > INT_MAX / 2 ? INT_MAX : this->capacity * 2;
+	if (newCapacity < needed) newCapacity = needed;
+	return this->reserve(newCapacity);
 }
 
 uint8_t & ArrayBuffer::operator[](int index) {
 	if (index < 0) {
-		BufferException bE(NEGATIVE_INDEX, "Index can not be negative.");
+		BufferException bE(NEGATIVE_INDEX);
 		throw bE;
 	}
 	if (index + 1 > this->size) {
-		BufferException bE(OUT_OF_RANGE_INDEX, "Index out of range.");
+		BufferException bE(OUT_OF_RANGE_INDEX);
 		throw bE;
 	}
 	return this->arrayPointer[index];
 }
 
 string ArrayBuffer::getString() {
-	string result;
-	for (int i = 0; i < this->size; i++) result.push_back((char)this->arrayPointer[i]);
-	return result;
+	return string((const char*)this->arrayPointer, this->size);
 }
 
 int ArrayBuffer::getInt(int offset) {
 	int data = 0;
+#ifndef BUFFER_COMPILE_TIME_ENDIAN
 	if (this->endian == NOT_SET) {
-		BufferException bE(NOT_SET_ENDIAN, "Please set Endian to be BIG_ENDIAN or LITTLE_ENDIAN according to you system.");
+		BufferException bE(NOT_SET_ENDIAN);
 		throw bE;
 	}
+#endif
 	if (offset < 0) {
-		BufferException bE(NEGATIVE_INDEX, "Index can not be negative.");
+		BufferException bE(NEGATIVE_INDEX);
 		throw bE;
 	}
 	if (offset + sizeof(int) > this->size) {
-		BufferException bE(OUT_OF_RANGE_INDEX, "Index out of range.");
+		BufferException bE(OUT_OF_RANGE_INDEX);
 		throw bE;
 	}
 	if (this->getPrimity(offset, &data)) return data;
 	else {
-		BufferException bE(UNKNOWN_EXCEPTION, "Something wrong when calling getPrimity method.");
+		BufferException bE(UNKNOWN_EXCEPTION);
 		throw bE;
 	}
 }
 
 float ArrayBuffer::getFloat(int offset) {
 	float data = 0;
+#ifndef BUFFER_COMPILE_TIME_ENDIAN
 	if (this->endian == NOT_SET) {
-		BufferException bE(NOT_SET_ENDIAN, "Please set Endian to be BIG_ENDIAN or LITTLE_ENDIAN according to you system.");
+		BufferException bE(NOT_SET_ENDIAN);
 		throw bE;
 	}
+#endif
 	if (offset < 0) {
-		BufferException bE(NEGATIVE_INDEX, "Index can not be negative.");
+		BufferException bE(NEGATIVE_INDEX);
 		throw bE;
 	}
 	if (offset + sizeof(float) > this->size) {
-		BufferException bE(OUT_OF_RANGE_INDEX, "Index out of range.");
+		BufferException bE(OUT_OF_RANGE_INDEX);
 		throw bE;
 	}
 	if (this->getPrimity(offset, &data)) return data;
 	else {
-		BufferException bE(UNKNOWN_EXCEPTION, "Something wrong when calling getPrimity method.");
+		BufferException bE(UNKNOWN_EXCEPTION);
 		throw bE;
 	}
 }
 
 long ArrayBuffer::getLong(int offset) {
 	long data = 0;
+#ifndef BUFFER_COMPILE_TIME_ENDIAN
 	if (this->endian == NOT_SET) {
-		BufferException bE(NOT_SET_ENDIAN, "Please set Endian to be BIG_ENDIAN or LITTLE_ENDIAN according to you system.");
+		BufferException bE(NOT_SET_ENDIAN);
 		throw bE;
 	}
+#endif
 	if (offset < 0) {
-		BufferException bE(NEGATIVE_INDEX, "Index can not be negative.");
+		BufferException bE(NEGATIVE_INDEX);
 		throw bE;
 	}
 	if (offset + sizeof(double) > this->size) {
-		BufferException bE(OUT_OF_RANGE_INDEX, "Index out of range.");
+		BufferException bE(OUT_OF_RANGE_INDEX);
 		throw bE;
 	}
 	if (this->getPrimity(offset, &data)) return data;
 	else {
-		BufferException bE(UNKNOWN_EXCEPTION, "Something wrong when calling getPrimity method.");
+		BufferException bE(UNKNOWN_EXCEPTION);
 		throw bE;
 	}
 }
 
 double ArrayBuffer::getDouble(int offset) {
 	double data = 0;
+#ifndef BUFFER_COMPILE_TIME_ENDIAN
 	if (this->endian == NOT_SET) {
-		BufferException bE(NOT_SET_ENDIAN, "Please set Endian to be BIG_ENDIAN or LITTLE_ENDIAN according to you system.");
+		BufferException bE(NOT_SET_ENDIAN);
 		throw bE;
 	}
+#endif
 	if (offset < 0) {
-		BufferException bE(NEGATIVE_INDEX, "Index can not be negative.");
+		BufferException bE(NEGATIVE_INDEX);
 		throw bE;
 	}
 	if (offset + sizeof(double) > this->size) {
-		BufferException bE(OUT_OF_RANGE_INDEX, "Index out of range.");
+		BufferException bE(OUT_OF_RANGE_INDEX);
 		throw bE;
 	}
 	if (this->getPrimity(offset, &data)) return data;
 	else {
-		BufferException bE(UNKNOWN_EXCEPTION, "Something wrong when calling getPrimity method.");
+		BufferException bE(UNKNOWN_EXCEPTION);
 		throw bE;
 	}
 }
 
+BufferResult<uint8_t> ArrayBuffer::tryGetByte(int index) noexcept {
+	BufferResult<uint8_t> result;
+	result.value = 0;
+	if (index < 0) result.code = NEGATIVE_INDEX;
+	else if (index >= this->size) result.code = OUT_OF_RANGE_INDEX;
+	else {
+		result.value = this->arrayPointer[index];
+		result.code = NO_EXCEPTION;
+	}
+	return result;
+}
+
+BufferResult<char> ArrayBuffer::tryGetChar(int index) noexcept {
+	BufferResult<uint8_t> byte = this->tryGetByte(index);
+	BufferResult<char> result;
+	result.value = (char)byte.value;
+	result.code = byte.code;
+	return result;
+}
+
 bool ArrayBuffer::getInt(int offset, int* outputInt) {return this->getPrimity(offset, outputInt);}
 bool ArrayBuffer::getFloat(int offset, float* outputFloat) {return this->getPrimity(offset, outputFloat);}
 bool ArrayBuffer::getLong(int offset, long * outputLong) { return this->getPrimity(offset, outputLong); }
 bool ArrayBuffer::getDouble(int offset, double* outputDouble) {return this->getPrimity(offset, outputDouble);}
 
 bool ArrayBuffer::getMemoryBlock(void * memPtr, int offset, int size) {
-	if (offset < 0 || offset + size > this->size) return false;
-	memcpy(memPtr, (void*)this->arrayPointer, size);
+	if (offset < 0 || size < 0 || offset + size > this->size) return false;
+	memcpy(memPtr, (void*)(this->arrayPointer + offset), size);
 	return true;
 }
 
+BufferSpan ArrayBuffer::getSpan(int offset, int size) {
+	BufferSpan span = { NULL, 0 };
+	if (offset < 0 || size < 0 || offset + size > this->size) return span;
+	span.data = this->arrayPointer + offset;
+	span.size = size;
+	return span;
+}
+
 bool ArrayBuffer::writeInt(int offset, int data) {return this->writePrimity(offset, data);}
 bool ArrayBuffer::writeFloat(int offset, float data) { return this->writePrimity(offset, data); }
 bool ArrayBuffer::writeLong(int offset, long data) { return this->writePrimity(offset, data); }
@@ -259,11 +527,62 @@ bool ArrayBuffer::writeDouble(int offset, double data) { return this->writePrimi
 #pragma region StackArrayBuffer implementation
 //------------------------------------------------------------------------------------------------------------
 //Section: StackArrayBuffer implementation
-StackArrayBuffer::~StackArrayBuffer() {
-	if (this->arrayPointer != NULL) {
-		delete[] this->arrayPointer;
-		this->arrayPointer = NULL;
+//The data array is released by ~ArrayBuffer
+StackArrayBuffer::~StackArrayBuffer() {}
+
+bool StackArrayBuffer::pushVarint(uint64_t input) {
+	int length = varintSize(input);
+	if (!this->makeRoom(length)) {
+		this->noteRejectedInsertion();
+		return false;
+	}
+	//The first (least significant) group goes on top
+	for (uint8_t* position = this->arrayPointer + this->size + length - 1; input >= 0x80; input >>= 7) *position-- = (uint8_t)(input | 0x80);
+	this->arrayPointer[this->size] = (uint8_t)input;
+	this->size += length;
+	this->noteInsertion(length);
+	this->checksumIn(this->arrayPointer + this->size - length, length);
+	return true;
+}
+
+bool StackArrayBuffer::topVarint(uint64_t * output) {
+	uint64_t value = 0;
+	int available = this->size < VARINT_MAX_BYTES ? this->size : VARINT_MAX_BYTES;
+	const uint8_t* position = this->arrayPointer + this->size - 1;
+	for (int i = 0; i < available; i++, position--) {
+		value |= (uint64_t)(*position & 0x7F) << (7 * i);
+		if (*position < 0x80) {
+			*output = value;
+			return true;
+		}
 	}
+	return false;
+}
+
+bool StackArrayBuffer::popVarint(uint64_t * output) {
+	uint64_t value;
+	if (!this->topVarint(&value)) {
+		this->noteRejectedRemoval();
+		return false;
+	}
+	this->size -= varintSize(value);
+	this->noteLifoRemoval(varintSize(value));
+	*output = value;
+	return true;
+}
+
+bool StackArrayBuffer::topZigzag(int64_t * output) {
+	uint64_t value;
+	if (!this->topVarint(&value)) return false;
+	*output = zigzagDecode(value);
+	return true;
+}
+
+bool StackArrayBuffer::popZigzag(int64_t * output) {
+	uint64_t value;
+	if (!this->popVarint(&value)) return false;
+	*output = zigzagDecode(value);
+	return true;
 }
 //Endsection: StackArrayBuffer implementation
 #pragma endregion StackArrayBuffer implementation
@@ -275,39 +594,500 @@ QueueArrayBuffer::QueueArrayBuffer(int capacity, Endian systemEndian)
 : ArrayBuffer(capacity, systemEndian) {
 	this->firstIndex = 0;
 	this->lastIndex = -1;
+	this->capacityMask = maskOf(capacity);
+	this->journal = NULL;
+	this->waiters = NULL;
+	this->messageHeader = FIXED_32_HEADER;
+	this->readPosition = 0;
 }
-QueueArrayBuffer::QueueArrayBuffer(void* memPtr, int capacity, int dataSize, Endian systemEndian) 
-: ArrayBuffer(memPtr, capacity, dataSize, systemEndian) {
+QueueArrayBuffer::QueueArrayBuffer(void* memPtr, int capacity, int dataSize, Endian systemEndian, MemoryMode memoryMode) 
+: ArrayBuffer(memPtr, capacity, dataSize, systemEndian, memoryMode) {
 	this->firstIndex = 0;
-	this->lastIndex = (capacity > dataSize ? dataSize : capacity) - 1;
+	this->lastIndex = this->size - 1;
+	this->capacityMask = maskOf(capacity);
+	this->journal = NULL;
+	this->waiters = NULL;
+	this->messageHeader = FIXED_32_HEADER;
+	this->readPosition = 0;
 }
 QueueArrayBuffer::QueueArrayBuffer(string inputString, Endian systemEndian) 
 : ArrayBuffer(inputString, systemEndian) {
 	this->firstIndex = 0;
-	this->lastIndex = inputString.length() - 1;
+	this->lastIndex = this->size - 1;
+	this->capacityMask = maskOf(this->capacity);
+	this->journal = NULL;
+	this->waiters = NULL;
+	this->messageHeader = FIXED_32_HEADER;
+	this->readPosition = 0;
 }
 QueueArrayBuffer::QueueArrayBuffer(int capacity, string inputString, Endian systemEndian)
 : ArrayBuffer(capacity, inputString, systemEndian) {
 	this->firstIndex = 0;
-	int len = inputString.length();
-	this->lastIndex = (capacity > len ? len : capacity) - 1;
+	this->lastIndex = this->size - 1;
+	this->capacityMask = maskOf(capacity);
+	this->journal = NULL;
+	this->waiters = NULL;
+	this->messageHeader = FIXED_32_HEADER;
+	this->readPosition = 0;
+}
+
+QueueArrayBuffer::QueueArrayBuffer(const QueueArrayBuffer & obj) :ArrayBuffer(obj) {
+	this->firstIndex = obj.firstIndex;
+	this->lastIndex = obj.lastIndex;
+	this->capacityMask = obj.capacityMask;
+	this->journal = NULL;
+	this->waiters = NULL;
+	this->messageHeader = obj.messageHeader;
+	this->readPosition = obj.readPosition;
+}
+
+QueueArrayBuffer::QueueArrayBuffer(QueueArrayBuffer && obj) noexcept :ArrayBuffer(std::move(obj)) {
+	this->firstIndex = obj.firstIndex;
+	this->lastIndex = obj.lastIndex;
+	this->capacityMask = obj.capacityMask;
+	this->journal = NULL;
+	this->waiters = NULL;
+	this->messageHeader = obj.messageHeader;
+	this->readPosition = obj.readPosition;
+	obj.firstIndex = 0;
+	obj.lastIndex = -1;
+	obj.capacityMask = -1;
+}
+
+QueueArrayBuffer & QueueArrayBuffer::operator=(const QueueArrayBuffer & obj) {
+	if (this == &obj) return *this;
+	ArrayBuffer::operator=(obj);
+	this->firstIndex = obj.firstIndex;
+	this->lastIndex = obj.lastIndex;
+	this->capacityMask = obj.capacityMask;
+	this->messageHeader = obj.messageHeader;
+	this->readPosition = obj.readPosition;
+	return *this;
+}
+
+QueueArrayBuffer & QueueArrayBuffer::operator=(QueueArrayBuffer && obj) noexcept {
+	if (this == &obj) return *this;
+	ArrayBuffer::operator=(std::move(obj));
+	this->firstIndex = obj.firstIndex;
+	this->lastIndex = obj.lastIndex;
+	this->capacityMask = obj.capacityMask;
+	this->messageHeader = obj.messageHeader;
+	this->readPosition = obj.readPosition;
+	obj.firstIndex = 0;
+	obj.lastIndex = -1;
+	obj.capacityMask = -1;
+	return *this;
 }
 
+//The data array is released by ~ArrayBuffer
+//A journal still recording the queue commits what it has and lets it go
+//Coroutines still waiting on the queue are never resumed
 QueueArrayBuffer::~QueueArrayBuffer() {
-	if (this->arrayPointer != NULL) {
-		delete[] this->arrayPointer;
-		this->arrayPointer = NULL;
-	}
+#ifdef BUFFER_HAS_JOURNAL
+	if (this->journal != NULL) this->journal->detach();
+#endif
+	delete this->waiters;
 }
 
 string QueueArrayBuffer::getString() {
+	BufferSegments segments = this->getSegments();
 	string result;
-	int tempIdx = this->firstIndex;
-	for (int i = 0; i < this->size; i++) {
-		result.push_back((char)this->arrayPointer[tempIdx]);
-		tempIdx = (tempIdx + 1) % this->capacity;
-	}
+	result.reserve(this->size);
+	result.append((const char*)segments.first.data, segments.first.size);
+	result.append((const char*)segments.second.data, segments.second.size);
 	return result;
 }
+
+BufferSegments QueueArrayBuffer::getSegments() {
+	BufferSegments segments = { { this->arrayPointer + this->firstIndex, 0 }, { NULL, 0 } };
+	int firstPart = this->capacity - this->firstIndex;
+	if (firstPart >= this->size) segments.first.size = this->size;
+	else {
+		segments.first.size = firstPart;
+		segments.second.data = this->arrayPointer;
+		segments.second.size = this->size - firstPart;
+	}
+	return segments;
+}
+
+uint32_t QueueArrayBuffer::getCrc32c() {
+	return crc32c(this->getSegments());
+}
+
+bool QueueArrayBuffer::peekCrc32c(int size, uint32_t * outputCrc) {
+	if (size < 0 || size > this->size) return false;
+	BufferSegments segments = this->getSegments();
+	if (size <= segments.first.size) *outputCrc = crc32c(segments.first.data, size);
+	else *outputCrc = crc32c(segments.second.data, size - segments.first.size, crc32c(segments.first.data, segments.first.size));
+	return true;
+}
+
+//The indexes go back to the start of the array: ArrayBuffer::clean only resets the size
+void QueueArrayBuffer::clean() {
+	this->readPosition += this->size;
+	ArrayBuffer::clean();
+	this->firstIndex = 0;
+	this->lastIndex = -1;
+	if (this->waiters != NULL) this->waiters->notify();
+}
+
+int QueueArrayBuffer::find(uint8_t value, int from) {
+	if (from < 0) from = 0;
+	if (from >= this->size) return -1;
+	BufferSegments segments = this->getSegments();
+	if (from < segments.first.size) {
+		int found = scanForByte(segments.first.data + from, segments.first.size - from, value);
+		if (found >= 0) return from + found;
+		from = segments.first.size;
+	}
+	int found = scanForByte(segments.second.data + (from - segments.first.size), this->size - from, value);
+	return found < 0 ? -1 : from + found;
+}
+
+int QueueArrayBuffer::findAny(const void * set, int setSize, int from) {
+	if (from < 0) from = 0;
+	if (from >= this->size) return -1;
+	BufferSegments segments = this->getSegments();
+	if (from < segments.first.size) {
+		int found = scanForAny(segments.first.data + from, segments.first.size - from, (const uint8_t*)set, setSize);
+		if (found >= 0) return from + found;
+		from = segments.first.size;
+	}
+	int found = scanForAny(segments.second.data + (from - segments.first.size), this->size - from, (const uint8_t*)set, setSize);
+	return found < 0 ? -1 : from + found;
+}
+
+//A match may start in the first segment and end in the second: the patternSize - 1 starts before the wrap point are compared in two parts
+int QueueArrayBuffer::find(const void * pattern, int patternSize, int from) {
+	if (from < 0) from = 0;
+	if (patternSize <= 0) return from <= this->size ? from : -1;
+	if (from + patternSize > this->size) return -1;
+	const uint8_t* bytes = (const uint8_t*)pattern;
+	BufferSegments segments = this->getSegments();
+	int firstSize = segments.first.size;
+	if (from < firstSize) {
+		int found = scanForPattern(segments.first.data + from, firstSize - from, bytes, patternSize);
+		if (found >= 0) return from + found;
+		for (int start = max(from, firstSize - patternSize + 1); start < firstSize; start++) {
+			int head = firstSize - start;
+			if (segments.second.size >= patternSize - head && memcmp(segments.first.data + start, bytes, head) == 0
+				&& memcmp(segments.second.data, bytes + head, patternSize - head) == 0) return start;
+		}
+		from = firstSize;
+	}
+	int found = scanForPattern(segments.second.data + (from - firstSize), this->size - from, bytes, patternSize);
+	return found < 0 ? -1 : from + found;
+}
+
+int QueueArrayBuffer::findNext(uint8_t value, ScanCursor * cursor) {
+	int from = this->resumeOffset(cursor);
+	int found = this->find(value, from);
+	this->keepPlace(cursor, from, found, 0);
+	return found;
+}
+
+int QueueArrayBuffer::findNextAny(const void * set, int setSize, ScanCursor * cursor) {
+	int from = this->resumeOffset(cursor);
+	int found = this->findAny(set, setSize, from);
+	this->keepPlace(cursor, from, found, 0);
+	return found;
+}
+
+int QueueArrayBuffer::findNext(const void * pattern, int patternSize, ScanCursor * cursor) {
+	int from = this->resumeOffset(cursor);
+	int found = this->find(pattern, patternSize, from);
+	this->keepPlace(cursor, from, found, patternSize > 0 ? patternSize - 1 : 0);
+	return found;
+}
+
+void QueueArrayBuffer::forwardStored(int bytes) {
+	if (bytes <= 0) return;
+	int start = this->lastIndex + 1 - bytes;
+	BufferSpan parts[2] = { { this->arrayPointer + start, bytes }, { NULL, 0 } };
+	if (start < 0) {
+		parts[0].data = this->arrayPointer + this->capacity + start;
+		parts[0].size = -start;
+		parts[1].data = this->arrayPointer;
+		parts[1].size = bytes + start;
+	}
+	for (int i = 0; i < 2; i++) {
+		this->checksumIn(parts[i].data, parts[i].size);
+#ifdef BUFFER_HAS_JOURNAL
+		if (this->journal != NULL) this->journal->append(parts[i].data, parts[i].size);
+#endif
+	}
+}
+
+BufferSpan QueueArrayBuffer::linearize() {
+	if (this->size > 0 && this->capacity - this->firstIndex < this->size) {
+		//The array holds [second part][free bytes][first part]: rotating it left by firstIndex gives [first part][second part][free bytes]
+		rotate(this->arrayPointer, this->arrayPointer + this->firstIndex, this->arrayPointer + this->capacity);
+		this->firstIndex = 0;
+		this->lastIndex = this->size - 1;
+	}
+	BufferSpan span = { this->arrayPointer + this->firstIndex, this->size };
+	return span;
+}
+
+bool QueueArrayBuffer::enQueueBlock(const void * memPtr, int blockSize) {
+	if (blockSize < 0) return false;
+	if (!this->makeRoom(blockSize)) {
+		this->noteRejectedInsertion();
+		return false;
+	}
+	if (blockSize == 0) return true;
+	int tail = this->wrapIndex(this->lastIndex + 1);
+	int firstPart = this->capacity - tail;
+	if (firstPart >= blockSize) memcpy((void*)(this->arrayPointer + tail), memPtr, blockSize);
+	else {
+		memcpy((void*)(this->arrayPointer + tail), memPtr, firstPart);
+		memcpy((void*)this->arrayPointer, (const uint8_t*)memPtr + firstPart, blockSize - firstPart);
+	}
+	this->lastIndex = this->wrapIndex(tail + blockSize - 1);
+	this->size += blockSize;
+	this->noteInsertion(blockSize);
+	this->noteStored(blockSize);
+	return true;
+}
+
+bool QueueArrayBuffer::deQueueBlock(void * memPtr, int blockSize) {
+	if (!this->peekBlock(memPtr, blockSize)) {
+		if (blockSize > this->size) this->noteRejectedRemoval();
+		return false;
+	}
+	this->firstIndex = this->wrapIndex(this->firstIndex + blockSize);
+	this->size -= blockSize;
+	this->noteFifoRemoval(blockSize);
+	return true;
+}
+
+bool QueueArrayBuffer::discard(int blockSize) {
+	if (blockSize < 0 || blockSize > this->size) return false;
+	this->firstIndex = this->wrapIndex(this->firstIndex + blockSize);
+	this->size -= blockSize;
+	this->noteFifoRemoval(blockSize);
+	return true;
+}
+
+bool QueueArrayBuffer::peekBlock(void * memPtr, int blockSize) {
+	if (blockSize < 0 || blockSize > this->size) return false;
+	if (blockSize == 0) return true;
+	int firstPart = this->capacity - this->firstIndex;
+	if (firstPart >= blockSize) memcpy(memPtr, (void*)(this->arrayPointer + this->firstIndex), blockSize);
+	else {
+		memcpy(memPtr, (void*)(this->arrayPointer + this->firstIndex), firstPart);
+		memcpy((uint8_t*)memPtr + firstPart, (void*)this->arrayPointer, blockSize - firstPart);
+	}
+	return true;
+}
+
+bool QueueArrayBuffer::enQueueVarint(uint64_t dataIn) {
+	int tail = this->wrapIndex(this->lastIndex + 1);
+	if (this->capacity - this->size >= VARINT_MAX_BYTES && this->capacity - tail >= VARINT_MAX_BYTES) {
+		//Fast path: the longest varint fits before the wrap point, encode it in place
+		int length = encodeVarint(dataIn, this->arrayPointer + tail);
+		this->lastIndex = tail + length - 1;
+		this->size += length;
+		this->noteInsertion(length);
+		this->noteStored(length);
+		return true;
+	}
+	uint8_t bytes[VARINT_MAX_BYTES];
+	return this->enQueueBlock(bytes, encodeVarint(dataIn, bytes));
+}
+
+bool QueueArrayBuffer::deQueueVarint(uint64_t * dataOut) {
+	int available = this->size < VARINT_MAX_BYTES ? this->size : VARINT_MAX_BYTES;
+	int length;
+	if (this->capacity - this->firstIndex >= available) length = decodeVarint(this->arrayPointer + this->firstIndex, available, dataOut);
+	else {
+		//The varint may cross the wrap point
+		uint8_t bytes[VARINT_MAX_BYTES];
+		this->peekBlock(bytes, available);
+		length = decodeVarint(bytes, available, dataOut);
+	}
+	if (length == 0) {
+		this->noteRejectedRemoval();
+		return false;
+	}
+	this->firstIndex = this->wrapIndex(this->firstIndex + length);
+	this->size -= length;
+	this->noteFifoRemoval(length);
+	return true;
+}
+
+bool QueueArrayBuffer::deQueueZigzag(int64_t * dataOut) {
+	uint64_t value;
+	if (!this->deQueueVarint(&value)) return false;
+	*dataOut = zigzagDecode(value);
+	return true;
+}
+
+int QueueArrayBuffer::deQueueVarints(uint64_t * dataOut, int maxCount) {
+	int count = 0;
+	while (count < maxCount && this->size > 0) {
+		//Decode the contiguous run from firstIndex in place, then let deQueueVarint take the varint crossing the wrap point
+		int contiguous = this->capacity - this->firstIndex < this->size ? this->capacity - this->firstIndex : this->size;
+		int consumed;
+		int decoded = decodeVarints(this->arrayPointer + this->firstIndex, contiguous, dataOut + count, maxCount - count, &consumed);
+		count += decoded;
+		this->firstIndex = this->wrapIndex(this->firstIndex + consumed);
+		this->size -= consumed;
+		this->noteFifoRemoval(consumed, decoded);
+		if (count == maxCount || this->size == 0) break;
+		if (consumed == contiguous) continue;
+		if (!this->deQueueVarint(dataOut + count)) break;
+		count++;
+	}
+	return count;
+}
+
+void QueueArrayBuffer::storeAt(int index, const void * memPtr, int blockSize) {
+	int firstPart = this->capacity - index;
+	if (firstPart >= blockSize) memcpy((void*)(this->arrayPointer + index), memPtr, blockSize);
+	else {
+		memcpy((void*)(this->arrayPointer + index), memPtr, firstPart);
+		memcpy((void*)this->arrayPointer, (const uint8_t*)memPtr + firstPart, blockSize - firstPart);
+	}
+}
+
+//Header and payload go in with one size update, so the running checksum, a journal and the waiting coroutines see the whole frame
+bool QueueArrayBuffer::enQueueMessage(const void * memPtr, int length) {
+	if (length < 0) return false;
+#ifndef BUFFER_COMPILE_TIME_ENDIAN
+	if (this->endian == NOT_SET) return false;
+#endif
+	uint8_t header[VARINT_MAX_BYTES];
+	int headerSize;
+	if (this->messageHeader == FIXED_32_HEADER) {
+		encodePrimity(header, (uint32_t)length, this->endian);
+		headerSize = sizeof(uint32_t);
+	}
+	else headerSize = encodeVarint((uint64_t)length, header);
+	if (length > INT_MAX - headerSize || !this->makeRoom(headerSize + length)) {
+		this->noteRejectedInsertion();
+		return false;
+	}
+	int tail = this->wrapIndex(this->lastIndex + 1);
+	if (this->capacity - tail >= headerSize + length) {
+		//Fast path: the frame does not cross the wrap point
+		memcpy((void*)(this->arrayPointer + tail), header, headerSize);
+		if (length > 0) memcpy((void*)(this->arrayPointer + tail + headerSize), memPtr, length);
+	}
+	else {
+		this->storeAt(tail, header, headerSize);
+		if (length > 0) this->storeAt(this->wrapIndex(tail + headerSize), memPtr, length);
+	}
+	this->lastIndex = this->wrapIndex(tail + headerSize + length - 1);
+	this->size += headerSize + length;
+	this->noteInsertion(headerSize + length);
+	this->noteStored(headerSize + length);
+	return true;
+}
+
+bool QueueArrayBuffer::peekMessage(BufferSegments * payload) {
+	int headerSize, payloadSize;
+	if (!this->frameAt(0, &headerSize, &payloadSize)) return false;
+	*payload = this->segmentsAt(headerSize, payloadSize);
+	return true;
+}
+
+bool QueueArrayBuffer::deQueueMessage(void * memPtr, int maxLength, int * length) {
+	int headerSize, payloadSize;
+	if (!this->frameAt(0, &headerSize, &payloadSize) || payloadSize > maxLength) {
+		this->noteRejectedRemoval();
+		return false;
+	}
+	BufferSegments payload = this->segmentsAt(headerSize, payloadSize);
+	if (payload.first.size > 0) memcpy(memPtr, payload.first.data, payload.first.size);
+	if (payload.second.size > 0) memcpy((uint8_t*)memPtr + payload.first.size, payload.second.data, payload.second.size);
+	*length = payloadSize;
+	return this->discard(headerSize + payloadSize);
+}
+
+bool QueueArrayBuffer::discardMessage() {
+	int headerSize, payloadSize;
+	if (!this->frameAt(0, &headerSize, &payloadSize)) {
+		this->noteRejectedRemoval();
+		return false;
+	}
+	return this->discard(headerSize + payloadSize);
+}
+
+#if defined(__unix__) || defined(__APPLE__)
+int QueueArrayBuffer::readFrom(int fileDescriptor) {
+	int freeBytes = this->capacity - this->size;
+	if (freeBytes == 0) {
+		errno = ENOBUFS;
+		return -1;
+	}
+	struct iovec segments[2];
+	int tail = this->wrapIndex(this->lastIndex + 1);
+	int firstPart = this->capacity - tail;
+	if (firstPart > freeBytes) firstPart = freeBytes;
+	segments[0].iov_base = (void*)(this->arrayPointer + tail);
+	segments[0].iov_len = firstPart;
+	segments[1].iov_base = (void*)this->arrayPointer;
+	segments[1].iov_len = freeBytes - firstPart;
+	ssize_t result;
+	do result = readv(fileDescriptor, segments, freeBytes > firstPart ? 2 : 1);
+	while (result < 0 && errno == EINTR);
+	if (result > 0) {
+		this->lastIndex = this->wrapIndex(tail + (int)result - 1);
+		this->size += (int)result;
+		this->noteInsertion((int)result);
+		this->noteStored((int)result);
+	}
+	return (int)result;
+}
+
+int QueueArrayBuffer::writeTo(int fileDescriptor) {
+	if (this->size == 0) return 0;
+	struct iovec segments[2];
+	int firstPart = this->capacity - this->firstIndex;
+	if (firstPart > this->size) firstPart = this->size;
+	segments[0].iov_base = (void*)(this->arrayPointer + this->firstIndex);
+	segments[0].iov_len = firstPart;
+	segments[1].iov_base = (void*)this->arrayPointer;
+	segments[1].iov_len = this->size - firstPart;
+	ssize_t result;
+	do result = writev(fileDescriptor, segments, this->size > firstPart ? 2 : 1);
+	while (result < 0 && errno == EINTR);
+	if (result > 0) {
+		this->firstIndex = this->wrapIndex(this->firstIndex + (int)result);
+		this->size -= (int)result;
+		this->noteFifoRemoval((int)result);
+	}
+	return (int)result;
+}
+#endif
+
+bool QueueArrayBuffer::relocate(int newCapacity) {
+	int newBlockCapacity;
+	bool newPooled;
+	uint8_t* newArray = allocateBlock(newCapacity, &newBlockCapacity, &newPooled);
+	this->peekBlock((void*)newArray, this->size);
+	memset((void*)(newArray + this->size), '\0', newCapacity - this->size);
+	this->releaseArray();
+	this->arrayPointer = newArray;
+	this->blockCapacity = newBlockCapacity;
+	this->pooled = newPooled;
+	this->borrowed = false;
+	this->capacity = newCapacity;
+	this->capacityMask = maskOf(newCapacity);
+	this->firstIndex = 0;
+	this->lastIndex = this->size - 1;
+	return true;
+}
+
+bool QueueArrayBuffer::reserve(int newCapacity) {
+	if (newCapacity <= this->capacity) return true;
+	return this->relocate(newCapacity);
+}
+
+bool QueueArrayBuffer::shrinkToFit() {
+	if (this->size == this->capacity) return true;
+	return this->relocate(this->size);
+}
 //Endsection: QueueArrayBuffer implementation
 #pragma endregion QueueArrayBuffer implementation
\ No newline at end of file
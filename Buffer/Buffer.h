@@ -4,18 +4,28 @@
 #pragma once
 #ifndef _BUFFER_H_
 #define _BUFFER_H_
+#include <climits>
 #include <cstdint>
+#include <cstring>
 #include <string>
+#if __cplusplus >= 201703L || (defined(_MSVC_LANG) && _MSVC_LANG >= 201703L)
+#define BUFFER_STRING_VIEW
+#include <string_view>
+#endif
+#if defined(__cpp_impl_coroutine) && defined(__linux__)
+#define BUFFER_HAS_COROUTINES
+#endif
+#include "ByteOrder.h"
+#include "ByteSwapSimd.h"
+#include "ByteScan.h"
+#include "Crc32c.h"
+#include "Varint.h"
+#include "BufferPool.h"
+#include "BufferInstrumentation.h"
 #include "Stack.h"
 #include "Queue.h"
 using namespace std;
 
-enum Endian {
-	NOT_SET,
-	BIG_ENDIAN,
-	LITTLE_ENDIAN
-};
-
 enum ExceptionErrorCode {
 	EMPTY_INITIALIZATION_STRING,
 	NEGATIVE_CAPACITY,
@@ -30,22 +40,84 @@ enum ExceptionErrorCode {
 	NOT_ENOUGH_DATA_TO_POP,
 	NOT_ENOUGH_DATA_TO_TOP,
 	NOT_ENOUGH_SPACE_TO_PUSH,
+	FILE_OPEN_FAILED,
+	FILE_MAP_FAILED,
+	FILE_TOO_LARGE,
+	NOT_ENOUGH_DATA_TO_DEQUEUE,
+	NOT_IN_EVENT_LOOP,
+	EVENT_LOOP_FAILED,
+	READ_ONLY_BUFFER,
+	CAPACITY_TOO_LARGE,
+	INVALID_CHUNK_SIZE,
+	NO_EXCEPTION,
 	UNKNOWN_EXCEPTION
 };
 
+//Return the static message of an error code, nothing is allocated
+const char* getErrorMessage(ExceptionErrorCode code) noexcept;
+
+enum MemoryMode {
+	COPY_MEMORY,		//The buffer allocates its own array and copies the caller's memory block into it
+	BORROW_MEMORY		//The buffer works in place on the caller's memory block, which must outlive it
+};
+
+//Length prefix of the messages framed by QueueArrayBuffer::enQueueMessage
+enum MessageHeader {
+	FIXED_32_HEADER,	//4 bytes in the buffer's byte order, the same bytes enQueueInt(length) would store
+	VARINT_HEADER		//1 byte below 128 bytes of payload, up to 5 bytes (see Varint.h)
+};
+
+//A contiguous piece of a buffer's data array, valid until the buffer is modified, grown or destroyed
+struct BufferSpan {
+	uint8_t* data;
+	int size;
+};
+
+//The data of a ring buffer in order: 'second' is {NULL, 0} unless the data wraps around the end of the array
+struct BufferSegments {
+	BufferSpan first;
+	BufferSpan second;
+	int size() const { return this->first.size + this->second.size; };
+	bool isContiguous() const { return this->second.size == 0; };
+};
+
+//CRC32C of the segments in order, continuing from 'crc' (see Crc32c.h)
+inline uint32_t crc32c(BufferSegments segments, uint32_t crc = 0) { return crc32c(segments.second.data, segments.second.size, crc32c(segments.first.data, segments.first.size, crc)); }
+
+//Where a resumable search of a QueueArrayBuffer got to (see QueueArrayBuffer::findNext), one per stream being parsed
+struct ScanCursor {
+	long long position;		//Stream position (see QueueArrayBuffer::getReadPosition) the next search starts from
+	ScanCursor() :position(0) {};
+};
+
+#ifdef BUFFER_STRING_VIEW
+//C++17 builds only: look at a span as text, nothing is copied
+inline string_view toStringView(BufferSpan span) { return string_view((const char*)span.data, span.size); }
+#endif
+
+//Nothing is allocated or copied: the library throws BufferException(code) with the static message of getErrorMessage
 class BufferException {
 public:
 	int exceptionCode;
-	char* msgPtr;
-	BufferException(int code, const char* message);
-	BufferException(const BufferException &obj);
-	~BufferException();
+	const char* msgPtr;
+	BufferException(int code, const char* message) noexcept;	//The pointer is kept as is: 'message' must have static storage (a string literal)
+	BufferException(ExceptionErrorCode code) noexcept;	//Use the message of getErrorMessage(code)
 	string getMessage();
+	const char* what() const noexcept { return this->msgPtr; };
 	int getCode();
 };
 
+//Result of the noexcept try... methods: 'value' is meaningful only when 'code' is NO_EXCEPTION
+template <typename T> struct BufferResult {
+	T value;
+	ExceptionErrorCode code;
+	bool ok() const { return this->code == NO_EXCEPTION; };
+	const char* getMessage() const { return getErrorMessage(this->code); };
+};
+
 class Buffer {
 public:
+	virtual ~Buffer() {};
 	virtual int getCapacity();					//Return buffer's capacity
 	virtual int getSize();						//Return number of bytes stored in the buffer
 	virtual bool isEmpty();						//Return true if the buffer is empty
@@ -85,14 +157,25 @@ public:
 	//Construct this ArrayStackBuffer with the size 'capacity'
 	ArrayBuffer(int capacity, Endian systemEndian);
 	//Construct this ArrayStackBuffer with the size 'capacity' and then copy 'dataSize' byte(s) from memory block pointed by memPtr into buffer.
-	ArrayBuffer(void* memPtr, int capacity, int dataSize, Endian systemEndian);
+	//With BORROW_MEMORY the buffer is a view: no allocation, 'capacity' bytes at memPtr are used in place.
+	ArrayBuffer(void* memPtr, int capacity, int dataSize, Endian systemEndian, MemoryMode memoryMode = COPY_MEMORY);
 	//Construct this buffer to be enough to store the 'inputString'
 	ArrayBuffer(string inputString, Endian systemEndian);
 	//Construct this buffer with the size 'capacity' and then store the inputString into it.
 	ArrayBuffer(int capacity, string inputString, Endian systemEndian);
+	//Copy constructor/assignment duplicate the data array, move constructor/assignment take it over and leave the source empty with capacity 0
+	ArrayBuffer(const ArrayBuffer& obj);
+	ArrayBuffer(ArrayBuffer&& obj) noexcept;
+	ArrayBuffer& operator=(const ArrayBuffer& obj);
+	ArrayBuffer& operator=(ArrayBuffer&& obj) noexcept;
 	//Free up all allocated memory
 	~ArrayBuffer();
 	virtual void clean();									//Clean the buffer's content
+	//Capacity management, a borrowed buffer that has to grow moves its content into an array of its own
+	void setGrowable(bool growable) { this->growable = growable; };	//When true, push/enQueue double the capacity instead of returning false on a full buffer
+	bool isGrowable() { return this->growable; };
+	virtual bool reserve(int newCapacity);					//Make the capacity at least 'newCapacity', keeping the content
+	virtual bool shrinkToFit();								//Reduce the capacity to the number of bytes stored in the buffer
 	//Methods that will throw exception when error occur (in the case of invalid index/offset)
 	virtual uint8_t& operator[](int index);					//Return reference to the byte at index
 	virtual string getString();								//Return the whole data as std::string object
@@ -106,6 +189,28 @@ public:
 	virtual bool getLong(int offset, long* outputLong);					//Return an 8-byte long starting from the offset index byte
 	virtual bool getDouble(int offset, double* outputDouble);			//Return an 8-byte double starting from the offset index byte
 	virtual bool getMemoryBlock(void* memPtr, int offset, int size);	//Copy 'size' bytes from buffer into a memory block pointed by memPtr
+	BufferSpan getSpan(int offset, int size);							//Return the 'size' bytes at 'offset' in place, {NULL, 0} if they are out of range
+	BufferSpan getData() { BufferSpan span = { this->arrayPointer, this->size }; return span; };	//Return the whole data in place
+#ifdef BUFFER_STRING_VIEW
+	string_view getStringView() { return toStringView(this->getData()); };	//Return the whole data in place as text
+#endif
+	bool isBorrowed() { return this->borrowed; };						//Return true if the data array belongs to the caller (BORROW_MEMORY)
+	bool isReadOnly() { return this->readOnly; };						//Return true if the data array can not be written (see MappedFileBuffer)
+	//CRC32C checksums of the data in place (see Crc32c.h)
+	virtual uint32_t getCrc32c();												//Return the CRC32C of the whole data
+	bool getCrc32c(int offset, int size, uint32_t* outputCrc);				//Return the CRC32C of the 'size' bytes at 'offset', false if they are out of range
+	//Running checksum: while it is on, every byte stored by push/enQueue goes into a CRC32C, in insertion order, as it is written
+	void setRunningChecksum(bool enabled) { this->runningChecksum = enabled; this->runningCrc = 0; };	//Turn it on or off, restarting from 0
+	bool hasRunningChecksum() { return this->runningChecksum; };
+	uint32_t getRunningChecksum() { return this->runningCrc; };				//CRC32C of the bytes stored since it was turned on or reset
+	void resetRunningChecksum() { this->runningCrc = 0; };
+	//Searches of the data in place (see ByteScan.h), starting 'from' bytes in. They return the offset of the first match, -1 if there is none.
+	virtual int find(uint8_t value, int from = 0);							//Offset of the first byte equal to 'value'
+	virtual int findAny(const void* set, int setSize, int from = 0);		//Offset of the first byte equal to any of the 'setSize' bytes at 'set'
+	virtual int find(const void* pattern, int patternSize, int from = 0);	//Offset where the 'patternSize' bytes at 'pattern' first appear
+	//Instrumentation (see BufferInstrumentation.h): all zero unless BUFFER_INSTRUMENTATION is defined
+	BufferStatsSnapshot getStats();
+	void resetStats();
 	/*
 	Be careful when using write methods, they are build base on the writePrimity template,
 	and they just generally write data into the data array. The size of the buffer will not
@@ -117,35 +222,123 @@ public:
 	virtual bool writeDouble(int offset, double data);		//Write an double value into the buffer at 'offset' position
 	template <typename T> bool writePrimity(int offset, T data);		//write any primitive object into buffer at 'offset' position
 	template <typename T> bool getPrimity(int offset, T* outputObject);	//Get any primitive object, return result via an object pointer
+	//Batched methods: one bounds check and one vectorized byte order conversion for 'count' consecutive values (see ByteSwapSimd.h)
+	//The get methods read stored data only (offset + count values <= size), the write methods follow writePrimity (<= capacity)
+	bool getInts(int offset, int* output, int count) { return this->getPrimities(offset, output, count); };
+	bool getFloats(int offset, float* output, int count) { return this->getPrimities(offset, output, count); };
+	bool getLongs(int offset, long* output, int count) { return this->getPrimities(offset, output, count); };
+	bool getDoubles(int offset, double* output, int count) { return this->getPrimities(offset, output, count); };
+	bool writeInts(int offset, const int* data, int count) { return this->writePrimities(offset, data, count); };
+	bool writeFloats(int offset, const float* data, int count) { return this->writePrimities(offset, data, count); };
+	bool writeLongs(int offset, const long* data, int count) { return this->writePrimities(offset, data, count); };
+	bool writeDoubles(int offset, const double* data, int count) { return this->writePrimities(offset, data, count); };
+	template <typename T> bool getPrimities(int offset, T* output, int count);			//Get 'count' primitive objects starting from the offset index byte
+	template <typename T> bool writePrimities(int offset, const T* data, int count);	//Write 'count' primitive objects into buffer at 'offset' position
+	//Methods that never throw, the error comes back as the code of the result (see BufferResult)
+	template <typename T> BufferResult<T> tryGetPrimity(int offset) noexcept;	//Get any primitive object starting from the offset index byte
+	BufferResult<uint8_t> tryGetByte(int index) noexcept;						//Return the byte at index
+	BufferResult<char> tryGetChar(int index) noexcept;							//Return the byte at index as a character
+	BufferResult<int> tryGetInt(int offset) noexcept { return this->tryGetPrimity<int>(offset); };				//Return an 4-byte integer starting from the offset index byte
+	BufferResult<float> tryGetFloat(int offset) noexcept { return this->tryGetPrimity<float>(offset); };		//Return an 4-byte float starting from the offset index byte
+	BufferResult<long> tryGetLong(int offset) noexcept { return this->tryGetPrimity<long>(offset); };			//Return an 8-byte long starting from the offset index byte
+	BufferResult<double> tryGetDouble(int offset) noexcept { return this->tryGetPrimity<double>(offset); };	//Return an 8-byte double starting from the offset index byte
+protected:
+	bool growable;
+	int blockCapacity;		//Size of the block behind arrayPointer, bigger than capacity when it comes from the BufferPool
+	bool pooled;			//True when arrayPointer was acquired from the BufferPool
+	bool borrowed;			//True when arrayPointer belongs to the caller and must not be freed
+	bool readOnly;			//True when arrayPointer is mapped without write access: the write methods return false and clean() throws
+	bool runningChecksum;	//True while the stored bytes go into runningCrc
+	uint32_t runningCrc;
+	void checksumIn(const uint8_t* data, int bytes) { if (this->runningChecksum) this->runningCrc = crc32c(data, bytes, this->runningCrc); };	//Called with the bytes a push/enQueue has just stored
+	void releaseArray();	//Give arrayPointer back to the pool or the heap, unless it is borrowed
+	//Get a block of at least 'capacity' bytes from the BufferPool (while it is enabled) or the heap, and give it back
+	static uint8_t* allocateBlock(int capacity, int* blockCapacity, bool* pooled);
+	static void freeBlock(uint8_t* block, int blockCapacity, bool pooled);
+	//Make room for 'extraBytes' more bytes, growing the buffer if it is growable. Return false if they do not fit.
+	bool makeRoom(int extraBytes) { return this->capacity - this->size >= extraBytes || this->grow(extraBytes); };
+	bool grow(int extraBytes);
+#ifdef BUFFER_INSTRUMENTATION
+	BufferInstrumentation instrumentation;
+#endif
+	//Instrumentation hooks, called after 'size' has been updated. They are empty unless BUFFER_INSTRUMENTATION is defined.
+	//'operations' is 0 for the second part of an operation that was already counted.
+	void noteInsertion(int bytes, int operations = 1) {
+#ifdef BUFFER_INSTRUMENTATION
+		this->instrumentation.noteInsertion(bytes, this->size, operations);
+#endif
+	};
+	void noteFifoRemoval(int bytes, int operations = 1) {
+#ifdef BUFFER_INSTRUMENTATION
+		this->instrumentation.noteFifoRemoval(bytes, operations);
+#endif
+	};
+	void noteLifoRemoval(int bytes, int operations = 1) {
+#ifdef BUFFER_INSTRUMENTATION
+		this->instrumentation.noteLifoRemoval(bytes, this->size, operations);
+#endif
+	};
+	void noteRejectedInsertion() {
+#ifdef BUFFER_INSTRUMENTATION
+		this->instrumentation.noteRejectedInsertion();
+#endif
+	};
+	void noteRejectedRemoval() {
+#ifdef BUFFER_INSTRUMENTATION
+		this->instrumentation.noteRejectedRemoval();
+#endif
+	};
 };
 
 #pragma region ArrayBuffer templates
 template<typename T>
 inline bool ArrayBuffer::writePrimity(int offset, T data) {
-	if (offset < 0 || offset + sizeof(T) > this->capacity) return false;
-	if (this->endian == NOT_SET) {
-		BufferException bE(NOT_SET_ENDIAN, "Please set Endian to be BIG_ENDIAN or LITTLE_ENDIAN according to your system.");
+	if (this->readOnly || offset < 0 || offset + sizeof(T) > this->capacity) return false;
+	if (!encodePrimity(this->arrayPointer + offset, data, this->endian)) {
+		BufferException bE(NOT_SET_ENDIAN);
 		throw bE;
 	}
-	if (this->endian == BIG_ENDIAN) {
-		uint8_t* ptr = (uint8_t*)&data;
-		for (int i = 0; i < sizeof(T); i++) this->arrayPointer[offset++] = *(ptr++);
-	}
-	else if (this->endian == LITTLE_ENDIAN) {
-		uint8_t* ptr = ((uint8_t*)&data) + sizeof(T) - 1;
-		for (int i = 0; i < sizeof(T); i++) this->arrayPointer[offset++] = *(ptr--);
-	}
 	return true;
 }
 
 template<typename T>
 inline bool ArrayBuffer::getPrimity(int offset, T * outputObject) {
-	if (this->endian == NOT_SET || offset < 0 || offset + sizeof(T) > this->capacity) return false;
-	uint8_t* ptr = (uint8_t*)outputObject;
-	if (this->endian == BIG_ENDIAN) for (int i = 0; i < sizeof(T); i++) *(ptr++) = this->arrayPointer[offset + i];
-	else if (this->endian == LITTLE_ENDIAN) for (int i = sizeof(T) - 1; i >= 0; i--) *(ptr++) = this->arrayPointer[offset + i];
+	if (offset < 0 || offset + sizeof(T) > this->capacity) return false;
+	return decodePrimity(this->arrayPointer + offset, outputObject, this->endian);
+}
+
+template<typename T>
+inline bool ArrayBuffer::getPrimities(int offset, T * output, int count) {
+	if (offset < 0 || count < 0 || (long long)count * (long long)sizeof(T) > (long long)this->size - offset) return false;
+	return decodePrimities(output, this->arrayPointer + offset, count, this->endian);
+}
+
+template<typename T>
+inline bool ArrayBuffer::writePrimities(int offset, const T * data, int count) {
+	if (this->readOnly || offset < 0 || count < 0 || (long long)count * (long long)sizeof(T) > (long long)this->capacity - offset) return false;
+	if (!encodePrimities(this->arrayPointer + offset, data, count, this->endian)) {
+		BufferException bE(NOT_SET_ENDIAN);
+		throw bE;
+	}
 	return true;
 }
+
+template<typename T>
+inline BufferResult<T> ArrayBuffer::tryGetPrimity(int offset) noexcept {
+	BufferResult<T> result;
+	result.value = 0;
+#ifndef BUFFER_COMPILE_TIME_ENDIAN
+	if (this->endian == NOT_SET) result.code = NOT_SET_ENDIAN;
+	else
+#endif
+	if (offset < 0) result.code = NEGATIVE_INDEX;
+	else if (offset + sizeof(T) > this->size) result.code = OUT_OF_RANGE_INDEX;
+	else {
+		decodePrimity(this->arrayPointer + offset, &result.value, this->endian);
+		result.code = NO_EXCEPTION;
+	}
+	return result;
+}
 #pragma endregion ArrayBuffer templates
 
 #pragma region StackArrayBuffer
@@ -154,11 +347,16 @@ public:
 	//Construct this ArrayStackBuffer with the size 'capacity'
 	StackArrayBuffer(int capacity, Endian systemEndian) :ArrayBuffer(capacity, systemEndian) {};
 	//Construct this ArrayStackBuffer with the size 'capacity' and then copy 'dataSize' byte(s) from memory block pointed by memPtr into buffer.
-	StackArrayBuffer(void* memPtr, int capacity, int dataSize, Endian systemEndian) : ArrayBuffer(memPtr, capacity, dataSize, systemEndian) {};
+	StackArrayBuffer(void* memPtr, int capacity, int dataSize, Endian systemEndian, MemoryMode memoryMode = COPY_MEMORY) : ArrayBuffer(memPtr, capacity, dataSize, systemEndian, memoryMode) {};
 	//Construct this ArrayStackBuffer to be enough to store the input string
 	StackArrayBuffer(string inputString, Endian systemEndian) :ArrayBuffer(inputString, systemEndian) {};
 	//Construct this ArrayStackBuffer with the size 'capacity' and then store input string into it.
 	StackArrayBuffer(int capacity, string inputString, Endian systemEndian) :ArrayBuffer(capacity, inputString, systemEndian) {};
+	//Copy/move the stack, see ArrayBuffer
+	StackArrayBuffer(const StackArrayBuffer& obj) :ArrayBuffer(obj) {};
+	StackArrayBuffer(StackArrayBuffer&& obj) noexcept :ArrayBuffer(std::move(obj)) {};
+	StackArrayBuffer& operator=(const StackArrayBuffer& obj) { ArrayBuffer::operator=(obj); return *this; };
+	StackArrayBuffer& operator=(StackArrayBuffer&& obj) noexcept { ArrayBuffer::operator=(std::move(obj)); return *this; };
 	//Destructor: Unallocate all memory.
 	~StackArrayBuffer();
 	//Methods that will throw exception when error occur (in the case of empty/full stack errors)
@@ -168,42 +366,77 @@ public:
 	template <typename T> bool pop(T* output);	//Return the primity at top of stack and then remove it from stack
 	template <typename T> bool top(T* output);	//Return the primity at top of stack without removing it from stack
 	template <typename T> bool push(T input);	//Push a primity to stack, return true if insertion was OK
+	//Methods that never throw, the error comes back as the code of the result (see BufferResult)
+	template <typename T> BufferResult<T> tryPop() noexcept;	//Return the primity at top of stack and then remove it from stack
+	template <typename T> BufferResult<T> tryTop() noexcept;	//Return the primity at top of stack without removing it from stack
+	//Batched methods: input[0] is pushed first, output receives the popped values in the order they were pushed (the old top last)
+	template <typename T> bool pushPrimities(const T* input, int count);	//Push 'count' primities, all or none
+	template <typename T> bool popPrimities(T* output, int count);			//Pop 'count' primities, all or none
+	//Record methods: several fields moved as one unit, with one capacity/endian check, all or none. The first field is pushed first.
+	template <typename T1, typename T2, typename... Ts> bool push(T1 field1, T2 field2, Ts... fields);		//Push a record, return true if insertion was OK
+	template <typename T1, typename T2, typename... Ts> bool pop(T1* field1, T2* field2, Ts*... fields);	//Pop the record on top of the stack, return false if there is not enough data
+	template <typename T1, typename T2, typename... Ts> tuple<T1, T2, Ts...> pop();						//Pop the record on top of the stack, throw if there is not enough data
 	//Implement compulsory methods in the stack interface
 	uint8_t pop() { return this->pop<uint8_t>(); }				//implement the 1-byte pop() method from stack interface
 	uint8_t top() { return this->top<uint8_t>(); }				//implement the 1-byte top() method from stack interface
-	bool pop(uint8_t* output) { return this->pop(output); }		//implement the 1-byte pop() method from stack interface
-	bool top(uint8_t* output) { return this->top(output); }		//implement the 1-byte top() method from stack interface
-	bool push(uint8_t input) { return this->push(input); }		//implement the 1-byte push() method from stack interface
+	bool pop(uint8_t* output) { return this->pop<uint8_t>(output); }		//implement the 1-byte pop() method from stack interface
+	bool top(uint8_t* output) { return this->top<uint8_t>(output); }		//implement the 1-byte top() method from stack interface
+	bool push(uint8_t input) { return this->push<uint8_t>(input); }		//implement the 1-byte push() method from stack interface
 	//Stack methods implementation for char
 	char popChar() { return this->pop<char>(); }				//method to pop a character using: T pop() template
 	char topChar() { return this->top<char>(); }				//method to get a top character using: T top() template
 	bool popChar(char* output) { return this->pop(output); }	//method to pop a character using: bool pop(T* output) template
 	bool topChar(char* output) { return this->top(output); }	//method to get a top character using: bool top(T* output) template
 	bool pushChar(char input) { return this->push(input); }		//method to push a character using: bool push(T input) template
+	BufferResult<char> tryPopChar() noexcept { return this->tryPop<char>(); }		//method to pop a character using: BufferResult<T> tryPop() template
+	BufferResult<char> tryTopChar() noexcept { return this->tryTop<char>(); }		//method to get a top character using: BufferResult<T> tryTop() template
 	//Stack methods implementation for int						
 	int popInt() { return this->pop<int>(); }					//method to pop an int using: T pop() template
 	int topInt() { return this->top<int>(); }					//method to get a top int using: T top() template
 	bool popInt(int* output) { return this->pop(output); }		//method to pop an int using: bool pop(T* output) template
 	bool topInt(int* output) { return this->top(output); }		//method to get a top int using: bool top(T* output) template
 	bool pushInt(int input) { return this->push(input); }		//method to push an int using: bool push(T input) template
+	BufferResult<int> tryPopInt() noexcept { return this->tryPop<int>(); }		//method to pop an int using: BufferResult<T> tryPop() template
+	BufferResult<int> tryTopInt() noexcept { return this->tryTop<int>(); }		//method to get a top int using: BufferResult<T> tryTop() template
+	bool pushInts(const int* input, int count) { return this->pushPrimities(input, count); }	//method to push an int array using: bool pushPrimities(const T* input, int count) template
+	bool popInts(int* output, int count) { return this->popPrimities(output, count); }		//method to pop an int array using: bool popPrimities(T* output, int count) template
 	//Stack methods implementation for float
 	float popFloat() { return this->pop<float>(); }				//method to pop a float using: T pop() template
 	float topFloat() { return this->top<float>(); }				//method to get a top float using: T top() template
 	bool popFloat(float* output) { return this->pop(output); }	//method to pop a float using: bool pop(T* output) template
 	bool topFloat(float* output) { return this->top(output); }	//method to get a top float using: bool top(T* output) template
 	bool pushFloat(float input) { return this->push(input); }	//method to push a float using: bool push(T input) template
+	BufferResult<float> tryPopFloat() noexcept { return this->tryPop<float>(); }		//method to pop a float using: BufferResult<T> tryPop() template
+	BufferResult<float> tryTopFloat() noexcept { return this->tryTop<float>(); }		//method to get a top float using: BufferResult<T> tryTop() template
+	bool pushFloats(const float* input, int count) { return this->pushPrimities(input, count); }	//method to push a float array using: bool pushPrimities(const T* input, int count) template
+	bool popFloats(float* output, int count) { return this->popPrimities(output, count); }		//method to pop a float array using: bool popPrimities(T* output, int count) template
 	//Stack methods implementation for long
 	long popLong() { return this->pop<long>(); }				//method to pop a long using: T pop() template
 	long topLong() { return this->top<long>(); }				//method to get a top long using: T top() template
 	bool popLong(long* output) { return this->pop(output); }	//method to pop a long using: bool pop(T* output) template
 	bool topLong(long* output) { return this->top(output); }	//method to get a top long using: bool top(T* output) template
 	bool pushLong(long input) { return this->push(input); }		//method to push a long using: bool push(T input) template
+	BufferResult<long> tryPopLong() noexcept { return this->tryPop<long>(); }		//method to pop a long using: BufferResult<T> tryPop() template
+	BufferResult<long> tryTopLong() noexcept { return this->tryTop<long>(); }		//method to get a top long using: BufferResult<T> tryTop() template
+	bool pushLongs(const long* input, int count) { return this->pushPrimities(input, count); }	//method to push a long array using: bool pushPrimities(const T* input, int count) template
+	bool popLongs(long* output, int count) { return this->popPrimities(output, count); }		//method to pop a long array using: bool popPrimities(T* output, int count) template
 	//Stack methods implementation for double
 	double popDouble() { return this->pop<double>(); }				//method to pop a double using: T pop() template
 	double topDouble() { return this->top<double>(); }				//method to get a top double using: T top() template
 	bool popDouble(double* output) { return this->pop(output); }	//method to pop a double using: bool pop(T* output) template
 	bool topDouble(double* output) { return this->top(output); }	//method to get a top double using: bool top(T* output) template
 	bool pushDouble(double input) { return this->push(input); }		//method to push a double using: bool push(T input) template
+	BufferResult<double> tryPopDouble() noexcept { return this->tryPop<double>(); }		//method to pop a double using: BufferResult<T> tryPop() template
+	BufferResult<double> tryTopDouble() noexcept { return this->tryTop<double>(); }		//method to get a top double using: BufferResult<T> tryTop() template
+	bool pushDoubles(const double* input, int count) { return this->pushPrimities(input, count); }	//method to push a double array using: bool pushPrimities(const T* input, int count) template
+	bool popDoubles(double* output, int count) { return this->popPrimities(output, count); }		//method to pop a double array using: bool popPrimities(T* output, int count) template
+	//Varint methods (see Varint.h): the bytes are pushed in reverse order so the varint on top is read downward from the top
+	bool pushVarint(uint64_t input);		//Push an unsigned integer in 1 to 10 bytes, return true if insertion was OK
+	bool popVarint(uint64_t* output);		//Return the varint at top of stack and then remove it from stack
+	bool topVarint(uint64_t* output);		//Return the varint at top of stack without removing it from stack
+	bool pushZigzag(int64_t input) { return this->pushVarint(zigzagEncode(input)); }	//Push a signed integer, small negative values stay short
+	bool popZigzag(int64_t* output);		//Return the zigzag varint at top of stack and then remove it from stack
+	bool topZigzag(int64_t* output);		//Return the zigzag varint at top of stack without removing it from stack
 };
 #pragma endregion StackArrayBuffer
 
@@ -212,17 +445,19 @@ template<typename T>
 inline T StackArrayBuffer::pop() {
 	int offset = this->size - sizeof(T);
 	if (offset < 0) {
-		BufferException bE(NOT_ENOUGH_DATA_TO_POP, "Data in the stack is not enough to pop");
+		this->noteRejectedRemoval();
+		BufferException bE(NOT_ENOUGH_DATA_TO_POP);
 		throw bE;
 	}
 	T output;
 	if (this->getPrimity(offset, &output)) {
 		this->size -= sizeof(T);
 		this->arrayPointer[this->size] = '\0';
+		this->noteLifoRemoval(sizeof(T));
 		return output;
 	}
 	else {
-		BufferException bE(UNKNOWN_EXCEPTION, "Something wrong when calling getPrimity method.");
+		BufferException bE(UNKNOWN_EXCEPTION);
 		throw bE;
 	}
 }
@@ -231,13 +466,13 @@ template<typename T>
 inline T StackArrayBuffer::top() {
 	int offset = this->size - sizeof(T);
 	if (offset < 0) {
-		BufferException bE(NOT_ENOUGH_DATA_TO_POP, "Data in the stack is not enough to pop");
+		BufferException bE(NOT_ENOUGH_DATA_TO_POP);
 		throw bE;
 	}
 	T output;
 	if (this->getPrimity(offset, &output)) return output;
 	else {
-		BufferException bE(UNKNOWN_EXCEPTION, "Something wrong when calling getPrimity method.");
+		BufferException bE(UNKNOWN_EXCEPTION);
 		throw bE;
 	}
 }
@@ -245,14 +480,18 @@ inline T StackArrayBuffer::top() {
 template<typename T>
 inline bool StackArrayBuffer::pop(T * output) {
 	int offset = this->size - sizeof(T);
-	if (offset < 0) return false;
+	if (offset < 0) {
+		this->noteRejectedRemoval();
+		return false;
+	}
 	if (this->getPrimity(offset, output)) {
 		this->size -= sizeof(T);
 		this->arrayPointer[this->size] = '\0';
+		this->noteLifoRemoval(sizeof(T));
 		return true;
 	}
 	else {
-		BufferException bE(UNKNOWN_EXCEPTION, "Something wrong when calling getPrimity method.");
+		BufferException bE(UNKNOWN_EXCEPTION);
 		throw bE;
 	}
 }
@@ -266,50 +505,300 @@ inline bool StackArrayBuffer::top(T * output) {
 
 template<typename T>
 inline bool StackArrayBuffer::push(T dataByte) {
-	if (this->capacity - this->size < sizeof(T)) return false;
-	return this->writePrimity(this->size, dataByte);
+	if (!this->makeRoom(sizeof(T))) {
+		this->noteRejectedInsertion();
+		return false;
+	}
+	if (!this->writePrimity(this->size, dataByte)) return false;
+	this->size += sizeof(T);
+	this->noteInsertion(sizeof(T));
+	this->checksumIn(this->arrayPointer + this->size - sizeof(T), sizeof(T));
+	return true;
+}
+
+template<typename T>
+inline bool StackArrayBuffer::pushPrimities(const T * input, int count) {
+	if (count < 0) return false;
+	if ((long long)count * (long long)sizeof(T) > INT_MAX || !this->makeRoom(count * sizeof(T))) {
+		this->noteRejectedInsertion();
+		return false;
+	}
+	if (!this->writePrimities(this->size, input, count)) return false;
+	this->size += count * sizeof(T);
+	this->noteInsertion(count * sizeof(T));
+	this->checksumIn(this->arrayPointer + this->size - (count * sizeof(T)), count * sizeof(T));
+	return true;
+}
+
+template<typename T>
+inline bool StackArrayBuffer::popPrimities(T * output, int count) {
+	if (count < 0) return false;
+	if ((long long)count * (long long)sizeof(T) > this->size) {
+		this->noteRejectedRemoval();
+		return false;
+	}
+	if (!this->getPrimities(this->size - count * sizeof(T), output, count)) return false;
+	this->size -= count * sizeof(T);
+	this->noteLifoRemoval(count * sizeof(T));
+	return true;
+}
+
+template<typename T1, typename T2, typename... Ts>
+inline bool StackArrayBuffer::push(T1 field1, T2 field2, Ts... fields) {
+	const int recordSize = RecordSize<T1, T2, Ts...>::value;
+#ifndef BUFFER_COMPILE_TIME_ENDIAN
+	if (this->endian == NOT_SET) {
+		BufferException bE(NOT_SET_ENDIAN);
+		throw bE;
+	}
+#endif
+	if (!this->makeRoom(recordSize)) {
+		this->noteRejectedInsertion();
+		return false;
+	}
+	encodeRecord(this->arrayPointer + this->size, this->endian, field1, field2, fields...);
+	this->size += recordSize;
+	this->noteInsertion(recordSize);
+	this->checksumIn(this->arrayPointer + this->size - recordSize, recordSize);
+	return true;
+}
+
+template<typename T1, typename T2, typename... Ts>
+inline bool StackArrayBuffer::pop(T1 * field1, T2 * field2, Ts *... fields) {
+	const int recordSize = RecordSize<T1, T2, Ts...>::value;
+#ifndef BUFFER_COMPILE_TIME_ENDIAN
+	if (this->endian == NOT_SET) return false;
+#endif
+	if (this->size < recordSize) {
+		this->noteRejectedRemoval();
+		return false;
+	}
+	this->size -= recordSize;
+	decodeRecord(this->arrayPointer + this->size, this->endian, field1, field2, fields...);
+	this->noteLifoRemoval(recordSize);
+	return true;
+}
+
+template<typename T1, typename T2, typename... Ts>
+inline tuple<T1, T2, Ts...> StackArrayBuffer::pop() {
+	const int recordSize = RecordSize<T1, T2, Ts...>::value;
+#ifndef BUFFER_COMPILE_TIME_ENDIAN
+	if (this->endian == NOT_SET) {
+		BufferException bE(NOT_SET_ENDIAN);
+		throw bE;
+	}
+#endif
+	if (this->size < recordSize) {
+		this->noteRejectedRemoval();
+		BufferException bE(NOT_ENOUGH_DATA_TO_POP);
+		throw bE;
+	}
+	tuple<T1, T2, Ts...> record;
+	this->size -= recordSize;
+	decodeRecordTuple(this->arrayPointer + this->size, this->endian, record, index_sequence_for<T1, T2, Ts...>());
+	this->noteLifoRemoval(recordSize);
+	return record;
+}
+
+template<typename T>
+inline BufferResult<T> StackArrayBuffer::tryPop() noexcept {
+	BufferResult<T> result = this->tryTop<T>();
+	if (result.code == NOT_ENOUGH_DATA_TO_TOP) {
+		result.code = NOT_ENOUGH_DATA_TO_POP;
+		this->noteRejectedRemoval();
+	}
+	if (result.ok()) {
+		this->size -= sizeof(T);
+		this->arrayPointer[this->size] = '\0';
+		this->noteLifoRemoval(sizeof(T));
+	}
+	return result;
+}
+
+template<typename T>
+inline BufferResult<T> StackArrayBuffer::tryTop() noexcept {
+	BufferResult<T> result;
+	if (this->size < sizeof(T)) {
+		result.value = 0;
+		result.code = NOT_ENOUGH_DATA_TO_TOP;
+		return result;
+	}
+	return this->tryGetPrimity<T>(this->size - sizeof(T));
 }
 
 #pragma endregion StackArrayBuffer templates
 
 #pragma region QueueArrayBuffer
+class QueueJournal;	//See QueueJournal.h
+class QueueWaitList;	//See AsyncQueueBuffer.h
+template <typename T> class QueueDeQueueAwaiter;
+template <typename T> class QueueEnQueueAwaiter;
+
+//Told by a QueueArrayBuffer each time data is stored into it or taken out of it, while coroutines wait on it
+class QueueWaiters {
+public:
+	virtual ~QueueWaiters() {};
+	virtual void notify() = 0;
+};
+
 class QueueArrayBuffer :public ArrayBuffer, public Queue<uint8_t> {
+	friend class QueueJournal;
+	friend class QueueWaitList;
 	int firstIndex, lastIndex;
-	int& rotateRight(int& index) { return index = (index + 1) % this->capacity; };
+	int capacityMask;	//capacity - 1 when capacity is a power of two, -1 otherwise
+	static int maskOf(int capacity) { return (capacity > 0 && (capacity & (capacity - 1)) == 0) ? capacity - 1 : -1; };
+	//Bring an index in the range [0, 2 * capacity) back into the ring without a division
+	int wrapIndex(int index) { return (this->capacityMask >= 0) ? (index & this->capacityMask) : (index >= this->capacity ? index - this->capacity : index); };
+	bool relocate(int newCapacity);		//Move the content to a new array of 'newCapacity' bytes, starting at index 0
+	QueueJournal* journal;				//Set while a QueueJournal records this queue, not copied/moved with the content
+	MessageHeader messageHeader;
+	long long readPosition;				//Bytes taken out of the queue so far, where the resumable searches keep their place
+	//Start offset of a resumable search, and where the next one starts once this one found 'found' (-1: nothing, the last 'overlap' bytes may still begin a match)
+	int resumeOffset(ScanCursor* cursor) {
+		long long offset = cursor->position - this->readPosition;
+		return offset < 0 ? 0 : (offset > this->size ? this->size : (int)offset);
+	};
+	void keepPlace(ScanCursor* cursor, int from, int found, int overlap) {
+		int next = found >= 0 ? found : this->size - overlap;
+		cursor->position = this->readPosition + (next > from ? next : from);
+	};
+	//Read the header of the frame 'offset' bytes after the first-joined byte, return false if that frame is not complete yet
+	bool frameAt(int offset, int* headerSize, int* payloadSize);
+	BufferSegments segmentsAt(int offset, int length);	//View of 'length' bytes starting 'offset' bytes after the first-joined byte
+	void storeAt(int index, const void* memPtr, int blockSize);	//Copy a block to the array from 'index' on, across the wrap point
+	QueueWaiters* waiters;				//Set once a coroutine waited on this queue, owned by the queue, not copied/moved with the content
+	//Called with the number of bytes an enQueue has just stored at the end of the queue: feed them to the running checksum and the journal
+	void noteStored(int bytes) {
+		if (this->runningChecksum || this->journal != NULL) this->forwardStored(bytes);
+		if (this->waiters != NULL) this->waiters->notify();
+	};
+	void forwardStored(int bytes);
+	//Hides ArrayBuffer::noteFifoRemoval so that every deQueue path also lets the coroutines waiting for space know
+	void noteFifoRemoval(int bytes, int operations = 1) {
+		ArrayBuffer::noteFifoRemoval(bytes, operations);
+		this->readPosition += bytes;
+		if (this->waiters != NULL) this->waiters->notify();
+	};
+	template <typename... Ts, size_t... I> bool deQueueRecordTuple(tuple<Ts...>& record, index_sequence<I...>) { return this->deQueueRecord(&get<I>(record)...); };
 public:
 	//Construct this ArrayStackBuffer with the size 'capacity'
 	QueueArrayBuffer(int capacity, Endian systemEndian);
 	//Construct this ArrayStackBuffer with the size 'capacity' and then copy 'dataSize' byte(s) from memory block pointed by memPtr into buffer.
-	QueueArrayBuffer(void* memPtr, int capacity, int dataSize, Endian systemEndian);
+	QueueArrayBuffer(void* memPtr, int capacity, int dataSize, Endian systemEndian, MemoryMode memoryMode = COPY_MEMORY);
 	//Construct this ArrayStackBuffer to be enough to store the input string
 	QueueArrayBuffer(string inputString, Endian systemEndian);
 	//Construct this ArrayStackBuffer with the size 'capacity' and then store input string into it.
 	QueueArrayBuffer(int capacity, string inputString, Endian systemEndian);
+	//Copy/move the queue, see ArrayBuffer
+	QueueArrayBuffer(const QueueArrayBuffer& obj);
+	QueueArrayBuffer(QueueArrayBuffer&& obj) noexcept;
+	QueueArrayBuffer& operator=(const QueueArrayBuffer& obj);
+	QueueArrayBuffer& operator=(QueueArrayBuffer&& obj) noexcept;
 	//Destructor: Unallocate all memory.
 	~QueueArrayBuffer();
-	//Override getString method
+	void clean();			//Clean the queue's content, the bytes dropped count as taken out (see getReadPosition)
+	//Capacity management: the content is re-linearized to start at index 0 of the new array
+	bool reserve(int newCapacity);
+	bool shrinkToFit();
+	//Override getString method: reserve once and copy the (at most two) segments
 	string getString();
+	//Views of the data in place, valid until the queue is modified, grown or destroyed
+	BufferSegments getSegments();				//Return the data as one or two segments, in order, nothing is moved
+	BufferSpan linearize();						//Rotate the ring so that the data starts at index 0 (no allocation), return it as one span
+	//CRC32C over the data in order, across the wrap point. getCrc32c(offset, size, ...) still works on array indexes.
+	using ArrayBuffer::getCrc32c;
+	uint32_t getCrc32c();						//Return the CRC32C of the whole queue
+	bool peekCrc32c(int size, uint32_t* outputCrc);	//Return the CRC32C of the 'size' first-joined bytes, false if there is not enough data
+	//Searches over the data in order, across the wrap point: offsets count from the first-joined byte, so a delimiter
+	//found at 'offset' ends a frame that deQueueBlock(memPtr, offset + 1) or getSegments() can take in one piece
+	int find(uint8_t value, int from = 0);
+	int findAny(const void* set, int setSize, int from = 0);
+	int find(const void* pattern, int patternSize, int from = 0);
+	//Resumable searches, for data that arrives in pieces: the cursor remembers where the last search stopped, so calling
+	//again after more data came in only scans the new bytes (and the patternSize - 1 before them). Once a match is found the
+	//cursor stays on it until it is deQueued. Use one cursor per queue, a new one after the queue was assigned or restored.
+	int findNext(uint8_t value, ScanCursor* cursor);
+	int findNextAny(const void* set, int setSize, ScanCursor* cursor);
+	int findNext(const void* pattern, int patternSize, ScanCursor* cursor);
+	long long getReadPosition() { return this->readPosition; };		//Number of bytes taken out of the queue since it was created
+#ifdef BUFFER_STRING_VIEW
+	string_view getStringView() { return toStringView(this->linearize()); };	//Return the whole data in place as text, linearizing the ring if it wraps
+#endif
+	//Block methods: move a whole memory block in at most two memcpy calls around the wrap point
+	bool enQueueBlock(const void* memPtr, int blockSize);	//Copy 'blockSize' bytes from memPtr to the end of the queue, return false if there is not enough space
+	bool deQueueBlock(void* memPtr, int blockSize);			//Move the 'blockSize' first-joined bytes out of the queue into memPtr, return false if there is not enough data
+	bool peekBlock(void* memPtr, int blockSize);			//Copy the 'blockSize' first-joined bytes into memPtr without removing them from the queue
+	bool discard(int blockSize);							//Remove the 'blockSize' first-joined bytes without copying them, return false if there is not enough data
+#if defined(__unix__) || defined(__APPLE__)
+	//File descriptor streaming: one readv/writev call over the (at most two) free or used regions of the ring, EINTR is retried.
+	//Both return the number of bytes moved or -1 with errno set (EAGAIN/EWOULDBLOCK on a non-blocking descriptor with nothing to move).
+	int readFrom(int fileDescriptor);		//Append what the descriptor has ready, 0 means end of file, -1 with errno ENOBUFS means the queue is full
+	int writeTo(int fileDescriptor);		//Write out as many first-joined bytes as the descriptor accepts, 0 if the queue is empty
+#endif
 	//Templates for all queue's methods
 	template <typename T> bool enQueue(T input);
 	template <typename T> bool deQueue(T* output);
+	template <typename T> BufferResult<T> tryDeQueue() noexcept;	//Never throw, the error comes back as the code of the result (see BufferResult)
+#ifdef BUFFER_HAS_COROUTINES
+	//Awaitable methods (C++20, include AsyncQueueBuffer.h): 'co_await' suspends the coroutine until the queue has the data/space
+	template <typename T> QueueDeQueueAwaiter<T> deQueueAsync();				//co_await gives the first-joined value
+	template <typename T> QueueEnQueueAwaiter<T> enQueueAsync(T input);		//co_await returns once the value is stored
+#endif
+	//Batched methods: 'count' values with one bounds check and vectorized byte order conversion, all or none
+	template <typename T> bool enQueuePrimities(const T* input, int count);
+	template <typename T> bool deQueuePrimities(T* output, int count);
+	//Record methods: several fields moved as one unit, with one capacity/endian check, all or none
+	template <typename T, typename... Ts> bool enQueueRecord(T field, Ts... fields);		//Push a record to the queue, return true if insertion was OK
+	template <typename T, typename... Ts> bool deQueueRecord(T* field, Ts*... fields);		//Move the first-joined record out of the queue, return false if there is not enough data
+	template <typename T, typename... Ts> tuple<T, Ts...> deQueueRecord();				//Move the first-joined record out of the queue, throw if there is not enough data
 	//Methods must be implemented to complete the Queue<uint8_t> interface
-	bool enQueue(uint8_t dataIn) { return this->enQueue(dataIn); };			//Push a byte to the queue, return true if insertion was OK
-	bool deQueue(uint8_t* dataOut) { return this->deQueue(dataOut); };		//Return the first-joined byte in the queue and then remove it from the queue
+	bool enQueue(uint8_t dataIn) { return this->enQueue<uint8_t>(dataIn); };			//Push a byte to the queue, return true if insertion was OK
+	bool deQueue(uint8_t* dataOut) { return this->deQueue<uint8_t>(dataOut); };		//Return the first-joined byte in the queue and then remove it from the queue
 	//Queue methods for char
 	bool enQueueChar(char dataIn) { return this->enQueue(dataIn); };		//Push a char to the queue, return true if insertion was OK
 	bool deQueueChar(char* dataOut) { return this->deQueue(dataOut); };		//Return the first-joined char in the queue and then remove it from the queue
+	BufferResult<char> tryDeQueueChar() noexcept { return this->tryDeQueue<char>(); };
 	//Queue methods for int
 	bool enQueueInt(int dataIn) { return this->enQueue(dataIn); };			//Push an int to the queue, return true if insertion was OK
 	bool deQueueInt(int* dataOut) { return this->deQueue(dataOut); };		//Return the first-joined int in the queue and then remove it from the queue
+	BufferResult<int> tryDeQueueInt() noexcept { return this->tryDeQueue<int>(); };
+	bool enQueueInts(const int* dataIn, int count) { return this->enQueuePrimities(dataIn, count); };	//Push 'count' ints to the queue, all or none
+	bool deQueueInts(int* dataOut, int count) { return this->deQueuePrimities(dataOut, count); };		//Move the 'count' first-joined ints out of the queue, all or none
 	//Queue methods for float
 	bool enQueueFloat(float dataIn) { return this->enQueue(dataIn); };		//Push a float to the queue, return true if insertion was OK
 	bool deQueueFloat(float* dataOut) { return this->deQueue(dataOut); };	//Return the first-joined float in the queue and then remove it from the queue
+	BufferResult<float> tryDeQueueFloat() noexcept { return this->tryDeQueue<float>(); };
+	bool enQueueFloats(const float* dataIn, int count) { return this->enQueuePrimities(dataIn, count); };	//Push 'count' floats to the queue, all or none
+	bool deQueueFloats(float* dataOut, int count) { return this->deQueuePrimities(dataOut, count); };		//Move the 'count' first-joined floats out of the queue, all or none
 	//Queue methods for long
 	bool enQueueLong(long dataIn) { return this->enQueue(dataIn); };		//Push a long to the queue, return true if insertion was OK
 	bool deQueueLong(long* dataOut) { return this->deQueue(dataOut); };		//Return the first-joined long in the queue and then remove it from the queue
+	BufferResult<long> tryDeQueueLong() noexcept { return this->tryDeQueue<long>(); };
+	bool enQueueLongs(const long* dataIn, int count) { return this->enQueuePrimities(dataIn, count); };	//Push 'count' longs to the queue, all or none
+	bool deQueueLongs(long* dataOut, int count) { return this->deQueuePrimities(dataOut, count); };		//Move the 'count' first-joined longs out of the queue, all or none
 	//Queue methods for double
 	bool enQueueDouble(double dataIn) { return this->enQueue(dataIn); };	//Push a double to the queue, return true if insertion was OK
 	bool deQueueDouble(double* dataOut) { return this->deQueue(dataOut); };	//Return the first-joined double in the queue and then remove it from the queue
+	BufferResult<double> tryDeQueueDouble() noexcept { return this->tryDeQueue<double>(); };
+	bool enQueueDoubles(const double* dataIn, int count) { return this->enQueuePrimities(dataIn, count); };	//Push 'count' doubles to the queue, all or none
+	bool deQueueDoubles(double* dataOut, int count) { return this->deQueuePrimities(dataOut, count); };		//Move the 'count' first-joined doubles out of the queue, all or none
+	//Varint methods (see Varint.h)
+	bool enQueueVarint(uint64_t dataIn);		//Push an unsigned integer in 1 to 10 bytes, return true if insertion was OK
+	bool deQueueVarint(uint64_t* dataOut);		//Return the first-joined varint in the queue and then remove it from the queue
+	bool enQueueZigzag(int64_t dataIn) { return this->enQueueVarint(zigzagEncode(dataIn)); };	//Push a signed integer, small negative values stay short
+	bool deQueueZigzag(int64_t* dataOut);		//Return the first-joined zigzag varint in the queue and then remove it from the queue
+	int deQueueVarints(uint64_t* dataOut, int maxCount);	//Move up to 'maxCount' first-joined varints into dataOut with the batched decoder, return how many were moved
+	//Message methods: each message is stored as one frame, a length header (see MessageHeader) followed by the payload.
+	//A frame is enQueued whole or not at all, so a reader never sees half of one.
+	void setMessageHeader(MessageHeader header) { this->messageHeader = header; };	//Choose the header before the first message, FIXED_32_HEADER by default
+	MessageHeader getMessageHeader() { return this->messageHeader; };
+	bool enQueueMessage(const void* memPtr, int length);	//Store a 'length' bytes message, return false if the whole frame does not fit
+	bool peekMessage(BufferSegments* payload);				//View the first-joined message's payload in place (two segments if it wraps), false if no message is complete
+	bool deQueueMessage(void* memPtr, int maxLength, int* length);	//Move the first-joined message's payload to memPtr, false if none is complete or it is longer than maxLength
+	bool discardMessage();									//Remove the first-joined message, false if none is complete
+	//Hand up to 'maxCount' complete messages to handler(BufferSegments payload) in order, then remove them all at once.
+	//The views are valid during the call only, the handler must not modify the queue. Return the number of messages handled.
+	template <typename F> int deQueueMessages(F handler, int maxCount = INT_MAX);
 
 };
 #pragma endregion QueueArrayBuffer
@@ -318,36 +807,237 @@ public:
 #pragma region QueueArrayBuffer templates
 template<typename T>
 inline bool QueueArrayBuffer::enQueue(T dataIn) {
-	if (this->size + sizeof(T) > this->capacity) return false;
-	if (this->endian == NOT_SET) return false;
-	else if (this->endian == BIG_ENDIAN) {
-		uint8_t* ptr = (uint8_t*)&dataIn;
-		for (int i = 0; i < sizeof(T); i++) this->arrayPointer[this->rotateRight(this->lastIndex)] = *(ptr++);
+	if (!this->makeRoom(sizeof(T))) {
+		this->noteRejectedInsertion();
+		return false;
 	}
-	else if (this->endian == LITTLE_ENDIAN) {
-		uint8_t* ptr = ((uint8_t*)&dataIn) + sizeof(T) - 1;
-		for (int i = 0; i < sizeof(T); i++) this->arrayPointer[this->rotateRight(this->lastIndex)] = *(ptr--);
+	int tail = this->wrapIndex(this->lastIndex + 1);
+	if (this->capacity - tail >= sizeof(T)) {
+		//Fast path: the value does not cross the wrap point, store it in place
+		if (!encodePrimity(this->arrayPointer + tail, dataIn, this->endian)) return false;
+		this->lastIndex = tail + sizeof(T) - 1;
+		this->size += sizeof(T);
+		this->noteInsertion(sizeof(T));
+		this->noteStored(sizeof(T));
+		return true;
 	}
-	this->size += sizeof(T);
-	return true;
+	uint8_t bytes[sizeof(T)];
+	if (!encodePrimity(bytes, dataIn, this->endian)) return false;
+	return this->enQueueBlock(bytes, sizeof(T));
 }
 
 template<typename T>
 inline bool QueueArrayBuffer::deQueue(T* dataOut) {
-	if (this->size < sizeof(T) || this->endian == NOT_SET) return false;
-	if (this->endian == BIG_ENDIAN) {
-		uint8_t* ptr = (uint8_t*)dataOut;
-		for (int i = 0; i < sizeof(T); i++) *(ptr++) = this->arrayPointer[this->firstIndex];
-		this->rotateRight(this->firstIndex);
+	if (this->size < sizeof(T)) {
+		this->noteRejectedRemoval();
+		return false;
 	}
-	else if (this->endian == LITTLE_ENDIAN) {
-		uint8_t* ptr = ((uint8_t*)dataOut) + sizeof(T) - 1;
-		for (int i = 0; i < sizeof(T); i++) *(ptr--) = this->arrayPointer[this->firstIndex];
-		this->rotateRight(this->firstIndex);
+	if (this->capacity - this->firstIndex >= sizeof(T)) {
+		//Fast path: the value does not cross the wrap point, load it in place
+		if (!decodePrimity(this->arrayPointer + this->firstIndex, dataOut, this->endian)) return false;
+		this->firstIndex = this->wrapIndex(this->firstIndex + sizeof(T));
+		this->size -= sizeof(T);
+		this->noteFifoRemoval(sizeof(T));
+		return true;
 	}
+	uint8_t bytes[sizeof(T)];
+	if (!this->peekBlock(bytes, sizeof(T)) || !decodePrimity(bytes, dataOut, this->endian)) return false;
+	this->firstIndex = this->wrapIndex(this->firstIndex + sizeof(T));
 	this->size -= sizeof(T);
+	this->noteFifoRemoval(sizeof(T));
+	return true;
+}
+
+template<typename T>
+inline BufferResult<T> QueueArrayBuffer::tryDeQueue() noexcept {
+	BufferResult<T> result;
+	result.value = 0;
+	if (this->deQueue(&result.value)) result.code = NO_EXCEPTION;
+#ifndef BUFFER_COMPILE_TIME_ENDIAN
+	else if (this->endian == NOT_SET) result.code = NOT_SET_ENDIAN;
+#endif
+	else result.code = NOT_ENOUGH_DATA_TO_DEQUEUE;
+	return result;
+}
+template<typename T>
+inline bool QueueArrayBuffer::enQueuePrimities(const T * dataIn, int count) {
+#ifndef BUFFER_COMPILE_TIME_ENDIAN
+	if (this->endian == NOT_SET) return false;
+#endif
+	if (count < 0) return false;
+	if ((long long)count * (long long)sizeof(T) > INT_MAX || !this->makeRoom(count * sizeof(T))) {
+		this->noteRejectedInsertion();
+		return false;
+	}
+	//Values before the wrap point, then the value crossing it (if any), then the rest from the start of the array
+	//The whole call counts as one insertion: enQueue counts it when a value crosses the wrap point
+	int tail = this->wrapIndex(this->lastIndex + 1);
+	int headValues = (this->capacity - tail) / (int)sizeof(T);
+	if (headValues > count) headValues = count;
+	if (headValues > 0) {
+		encodePrimities(this->arrayPointer + tail, dataIn, headValues, this->endian);
+		this->lastIndex = tail + headValues * sizeof(T) - 1;
+		this->size += headValues * sizeof(T);
+		this->noteInsertion(headValues * sizeof(T), headValues == count ? 1 : 0);
+		this->noteStored(headValues * sizeof(T));
+	}
+	if (headValues == count) return true;
+	bool crossed = this->wrapIndex(this->lastIndex + 1) != 0;
+	if (crossed) this->enQueue(dataIn[headValues++]);
+	tail = this->wrapIndex(this->lastIndex + 1);
+	encodePrimities(this->arrayPointer + tail, dataIn + headValues, count - headValues, this->endian);
+	this->lastIndex = tail + (count - headValues) * sizeof(T) - 1;
+	this->size += (count - headValues) * sizeof(T);
+	this->noteInsertion((count - headValues) * sizeof(T), crossed ? 0 : 1);
+	this->noteStored((count - headValues) * sizeof(T));
+	return true;
+}
+
+template<typename T>
+inline bool QueueArrayBuffer::deQueuePrimities(T * dataOut, int count) {
+#ifndef BUFFER_COMPILE_TIME_ENDIAN
+	if (this->endian == NOT_SET) return false;
+#endif
+	if (count < 0) return false;
+	if ((long long)count * (long long)sizeof(T) > this->size) {
+		this->noteRejectedRemoval();
+		return false;
+	}
+	int headValues = (this->capacity - this->firstIndex) / (int)sizeof(T);
+	if (headValues > count) headValues = count;
+	decodePrimities(dataOut, this->arrayPointer + this->firstIndex, headValues, this->endian);
+	this->firstIndex = this->wrapIndex(this->firstIndex + headValues * sizeof(T));
+	this->size -= headValues * sizeof(T);
+	this->noteFifoRemoval(headValues * sizeof(T), headValues == count ? 1 : 0);
+	if (headValues == count) return true;
+	bool crossed = this->firstIndex != 0;
+	if (crossed) this->deQueue(dataOut + headValues++);
+	decodePrimities(dataOut + headValues, this->arrayPointer + this->firstIndex, count - headValues, this->endian);
+	this->firstIndex += (count - headValues) * sizeof(T);
+	this->size -= (count - headValues) * sizeof(T);
+	this->noteFifoRemoval((count - headValues) * sizeof(T), crossed ? 0 : 1);
+	return true;
+}
+template<typename T, typename... Ts>
+inline bool QueueArrayBuffer::enQueueRecord(T field, Ts... fields) {
+	const int recordSize = RecordSize<T, Ts...>::value;
+#ifndef BUFFER_COMPILE_TIME_ENDIAN
+	if (this->endian == NOT_SET) return false;
+#endif
+	if (!this->makeRoom(recordSize)) {
+		this->noteRejectedInsertion();
+		return false;
+	}
+	int tail = this->wrapIndex(this->lastIndex + 1);
+	if (this->capacity - tail >= recordSize) {
+		//Fast path: the record does not cross the wrap point, store it in place
+		encodeRecord(this->arrayPointer + tail, this->endian, field, fields...);
+		this->lastIndex = tail + recordSize - 1;
+		this->size += recordSize;
+		this->noteInsertion(recordSize);
+		this->noteStored(recordSize);
+		return true;
+	}
+	uint8_t bytes[recordSize];
+	encodeRecord(bytes, this->endian, field, fields...);
+	return this->enQueueBlock(bytes, recordSize);
+}
+
+template<typename T, typename... Ts>
+inline bool QueueArrayBuffer::deQueueRecord(T * field, Ts *... fields) {
+	const int recordSize = RecordSize<T, Ts...>::value;
+#ifndef BUFFER_COMPILE_TIME_ENDIAN
+	if (this->endian == NOT_SET) return false;
+#endif
+	if (this->size < recordSize) {
+		this->noteRejectedRemoval();
+		return false;
+	}
+	if (this->capacity - this->firstIndex >= recordSize) decodeRecord(this->arrayPointer + this->firstIndex, this->endian, field, fields...);
+	else {
+		uint8_t bytes[recordSize];
+		this->peekBlock(bytes, recordSize);
+		decodeRecord(bytes, this->endian, field, fields...);
+	}
+	this->firstIndex = this->wrapIndex(this->firstIndex + recordSize);
+	this->size -= recordSize;
+	this->noteFifoRemoval(recordSize);
 	return true;
 }
 
+template<typename T, typename... Ts>
+inline tuple<T, Ts...> QueueArrayBuffer::deQueueRecord() {
+#ifndef BUFFER_COMPILE_TIME_ENDIAN
+	if (this->endian == NOT_SET) {
+		BufferException bE(NOT_SET_ENDIAN);
+		throw bE;
+	}
+#endif
+	if (this->size < RecordSize<T, Ts...>::value) {
+		this->noteRejectedRemoval();
+		BufferException bE(NOT_ENOUGH_DATA_TO_DEQUEUE);
+		throw bE;
+	}
+	tuple<T, Ts...> record;
+	this->deQueueRecordTuple(record, index_sequence_for<T, Ts...>());
+	return record;
+}
+//Inline: deQueueMessages reads every header of a batch with them
+inline BufferSegments QueueArrayBuffer::segmentsAt(int offset, int length) {
+	int start = this->wrapIndex(this->firstIndex + offset);
+	BufferSegments segments = { { this->arrayPointer + start, length }, { NULL, 0 } };
+	int firstPart = this->capacity - start;
+	if (firstPart < length) {
+		segments.first.size = firstPart;
+		segments.second.data = this->arrayPointer;
+		segments.second.size = length - firstPart;
+	}
+	return segments;
+}
+
+inline bool QueueArrayBuffer::frameAt(int offset, int* headerSize, int* payloadSize) {
+	int available = this->size - offset;
+	int maxHeader = this->messageHeader == FIXED_32_HEADER ? (int)sizeof(uint32_t) : 5;
+	int headerBytes = available < maxHeader ? available : maxHeader;
+	if (headerBytes <= 0) return false;
+	//The header may cross the wrap point: read it from a copy then
+	int start = this->wrapIndex(this->firstIndex + offset);
+	const uint8_t* header = this->arrayPointer + start;
+	uint8_t bytes[5];
+	if (this->capacity - start < headerBytes) {
+		memcpy(bytes, header, this->capacity - start);
+		memcpy(bytes + this->capacity - start, this->arrayPointer, headerBytes - (this->capacity - start));
+		header = bytes;
+	}
+	uint64_t length;
+	if (this->messageHeader == FIXED_32_HEADER) {
+		uint32_t fixedLength;
+		if (headerBytes < (int)sizeof(uint32_t) || !decodePrimity(header, &fixedLength, this->endian)) return false;
+		length = fixedLength;
+		*headerSize = sizeof(uint32_t);
+	}
+	else if ((*headerSize = decodeVarint(header, headerBytes, &length)) == 0) return false;
+	if (length > (uint64_t)(available - *headerSize)) return false;
+	*payloadSize = (int)length;
+	return true;
+}
+
+template<typename F>
+inline int QueueArrayBuffer::deQueueMessages(F handler, int maxCount) {
+	int count = 0, offset = 0, headerSize, payloadSize;
+	while (count < maxCount && this->frameAt(offset, &headerSize, &payloadSize)) {
+		handler(this->segmentsAt(offset + headerSize, payloadSize));
+		offset += headerSize + payloadSize;
+		count++;
+	}
+	if (count == 0) {
+		this->noteRejectedRemoval();
+		return 0;
+	}
+	this->firstIndex = this->wrapIndex(this->firstIndex + offset);
+	this->size -= offset;
+	this->noteFifoRemoval(offset, count);
+	return count;
+}
 #pragma endregion QueueArrayBuffer templates
 #endif // !_BUFFER_H_
\ No newline at end of file
@@ -0,0 +1,80 @@
+//Buffer library by Huynh Hoang Kha
+//Optional counters and dwell-time histograms for the stack/queue buffers
+#include <cstdio>
+#include "BufferInstrumentation.h"
+
+#pragma region Export implementation
+//------------------------------------------------------------------------------------------------------------
+//Section: Export implementation
+std::string exportBufferStats(const std::string& name, const BufferStatsSnapshot& stats) {
+	std::string text;
+	char line[256];
+	const char* names[] = { "insertions", "removals", "rejected_insertions", "rejected_removals", "bytes_in", "bytes_out", "high_water_mark", "dwell_samples" };
+	uint64_t values[] = { stats.insertions, stats.removals, stats.rejectedInsertions, stats.rejectedRemovals, stats.bytesIn, stats.bytesOut, (uint64_t)stats.highWaterMark, stats.dwellSamples };
+	snprintf(line, sizeof(line), "%s.enabled %d\n", name.c_str(), stats.enabled ? 1 : 0);
+	text += line;
+	for (int i = 0; i < 8; i++) {
+		snprintf(line, sizeof(line), "%s.%s %llu\n", name.c_str(), names[i], (unsigned long long)values[i]);
+		text += line;
+	}
+	for (int i = 0; i < BUFFER_DWELL_BUCKETS; i++) {
+		if (stats.dwellHistogram[i] == 0) continue;
+		snprintf(line, sizeof(line), "%s.dwell_ns_le_%llu %llu\n", name.c_str(), 2ULL << i, (unsigned long long)stats.dwellHistogram[i]);
+		text += line;
+	}
+	return text;
+}
+//Endsection: Export implementation
+#pragma endregion Export implementation
+
+#ifdef BUFFER_INSTRUMENTATION
+#pragma region BufferInstrumentation implementation
+//------------------------------------------------------------------------------------------------------------
+//Section: BufferInstrumentation implementation
+void BufferInstrumentation::reset() {
+	this->insertions = this->removals = this->rejectedInsertions = this->rejectedRemovals = 0;
+	this->bytesIn = this->bytesOut = this->dwellSamples = 0;
+	this->highWaterMark = 0;
+	for (int i = 0; i < BUFFER_DWELL_BUCKETS; i++) this->dwellHistogram[i] = 0;
+	this->firstSample = this->sampleCount = 0;
+	this->untilNextSample = BUFFER_DWELL_SAMPLE_INTERVAL;
+}
+
+BufferStatsSnapshot BufferInstrumentation::snapshot() const {
+	BufferStatsSnapshot stats;
+	stats.enabled = true;
+	stats.insertions = this->insertions.load(std::memory_order_relaxed);
+	stats.removals = this->removals.load(std::memory_order_relaxed);
+	stats.rejectedInsertions = this->rejectedInsertions.load(std::memory_order_relaxed);
+	stats.rejectedRemovals = this->rejectedRemovals.load(std::memory_order_relaxed);
+	stats.bytesIn = this->bytesIn.load(std::memory_order_relaxed);
+	stats.bytesOut = this->bytesOut.load(std::memory_order_relaxed);
+	stats.highWaterMark = this->highWaterMark.load(std::memory_order_relaxed);
+	stats.dwellSamples = this->dwellSamples.load(std::memory_order_relaxed);
+	for (int i = 0; i < BUFFER_DWELL_BUCKETS; i++) stats.dwellHistogram[i] = this->dwellHistogram[i].load(std::memory_order_relaxed);
+	return stats;
+}
+
+void BufferInstrumentation::startSample(int sizeAfter) {
+	this->untilNextSample = BUFFER_DWELL_SAMPLE_INTERVAL;
+	if (this->sampleCount == BUFFER_DWELL_PENDING_SAMPLES) return;	//Too many items in flight, skip this one
+	int slot = (this->firstSample + this->sampleCount) % BUFFER_DWELL_PENDING_SAMPLES;
+	this->samplePosition[slot] = this->bytesIn.load(std::memory_order_relaxed);
+	this->sampleDepth[slot] = sizeAfter;
+	this->sampleTime[slot] = std::chrono::steady_clock::now();
+	this->sampleCount++;
+}
+
+//Record the dwell time of the oldest or the newest pending sample and forget it
+void BufferInstrumentation::finishSample(int slot) {
+	long long nanoseconds = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - this->sampleTime[slot]).count();
+	int bucket = 0;
+	while (bucket < BUFFER_DWELL_BUCKETS - 1 && (nanoseconds >> (bucket + 1)) > 0) bucket++;
+	add(this->dwellHistogram[bucket], 1);
+	add(this->dwellSamples, 1);
+	if (slot == this->firstSample) this->firstSample = (this->firstSample + 1) % BUFFER_DWELL_PENDING_SAMPLES;
+	this->sampleCount--;
+}
+//Endsection: BufferInstrumentation implementation
+#pragma endregion BufferInstrumentation implementation
+#endif
@@ -0,0 +1,87 @@
+//Buffer library by Huynh Hoang Kha
+//Optional counters and dwell-time histograms for the stack/queue buffers
+#pragma once
+#ifndef _BUFFER_INSTRUMENTATION_H_
+#define _BUFFER_INSTRUMENTATION_H_
+#include <cstdint>
+#include <string>
+#ifdef BUFFER_INSTRUMENTATION
+#include <atomic>
+#include <chrono>
+#endif
+
+/*
+Define BUFFER_INSTRUMENTATION (the same way for the whole program, it changes the size of ArrayBuffer) to make
+StackArrayBuffer and QueueArrayBuffer count their operations. Without it the hooks are empty inline functions
+and getStats() returns a snapshot with 'enabled' false and every counter 0.
+
+The buffers are not thread safe, so only the thread that owns a buffer updates its counters: they are relaxed
+atomics written with plain load/store (no locked instruction), which lets any other thread scrape them.
+One insertion out of BUFFER_DWELL_SAMPLE_INTERVAL is timestamped, its dwell time (until the stack pops it or
+the queue hands its last byte out) goes into a log2 histogram: bucket i counts times in [2^i, 2^(i+1)) ns.
+*/
+#ifndef BUFFER_DWELL_SAMPLE_INTERVAL
+#define BUFFER_DWELL_SAMPLE_INTERVAL 64
+#endif
+#define BUFFER_DWELL_BUCKETS 40
+#define BUFFER_DWELL_PENDING_SAMPLES 16
+
+struct BufferStatsSnapshot {
+	bool enabled;
+	uint64_t insertions;			//Successful push/enQueue calls
+	uint64_t removals;				//Successful pop/deQueue calls
+	uint64_t rejectedInsertions;	//push/enQueue calls refused because the buffer was full
+	uint64_t rejectedRemovals;		//pop/deQueue calls refused because there was not enough data
+	uint64_t bytesIn;
+	uint64_t bytesOut;
+	int highWaterMark;				//Biggest size reached since the buffer was created or the stats were reset
+	uint64_t dwellSamples;
+	uint64_t dwellHistogram[BUFFER_DWELL_BUCKETS];
+};
+
+//Format a snapshot as "name.counter value" lines, one histogram line per non-empty bucket ("name.dwell_ns_le_<2^(i+1)>")
+std::string exportBufferStats(const std::string& name, const BufferStatsSnapshot& stats);
+
+#ifdef BUFFER_INSTRUMENTATION
+class BufferInstrumentation {
+	std::atomic<uint64_t> insertions, removals, rejectedInsertions, rejectedRemovals, bytesIn, bytesOut, dwellSamples;
+	std::atomic<int> highWaterMark;
+	std::atomic<uint64_t> dwellHistogram[BUFFER_DWELL_BUCKETS];
+	//Timestamped insertions not removed yet, oldest first: 'position' is the value of bytesIn and 'depth' the size right after them
+	uint64_t samplePosition[BUFFER_DWELL_PENDING_SAMPLES];
+	int sampleDepth[BUFFER_DWELL_PENDING_SAMPLES];
+	std::chrono::steady_clock::time_point sampleTime[BUFFER_DWELL_PENDING_SAMPLES];
+	int firstSample, sampleCount;
+	int untilNextSample;
+	static void add(std::atomic<uint64_t>& counter, uint64_t amount) { counter.store(counter.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed); };
+	void finishSample(int slot);
+public:
+	BufferInstrumentation() { this->reset(); };
+	BufferInstrumentation(const BufferInstrumentation&) :BufferInstrumentation() {};	//A copied buffer starts with fresh stats
+	BufferInstrumentation& operator=(const BufferInstrumentation&) { return *this; };
+	void reset();
+	BufferStatsSnapshot snapshot() const;
+	void noteInsertion(int bytes, int sizeAfter, int operations) {
+		add(this->insertions, operations);
+		add(this->bytesIn, bytes);
+		if (sizeAfter > this->highWaterMark.load(std::memory_order_relaxed)) this->highWaterMark.store(sizeAfter, std::memory_order_relaxed);
+		if (operations > 0 && --this->untilNextSample == 0) this->startSample(sizeAfter);
+	};
+	void noteFifoRemoval(int bytes, int operations) {
+		add(this->removals, operations);
+		add(this->bytesOut, bytes);
+		while (this->sampleCount > 0 && this->samplePosition[this->firstSample] <= this->bytesOut.load(std::memory_order_relaxed)) this->finishSample(this->firstSample);
+	};
+	void noteLifoRemoval(int bytes, int sizeAfter, int operations) {
+		add(this->removals, operations);
+		add(this->bytesOut, bytes);
+		while (this->sampleCount > 0 && this->sampleDepth[(this->firstSample + this->sampleCount - 1) % BUFFER_DWELL_PENDING_SAMPLES] > sizeAfter)
+			this->finishSample((this->firstSample + this->sampleCount - 1) % BUFFER_DWELL_PENDING_SAMPLES);
+	};
+	void noteRejectedInsertion() { add(this->rejectedInsertions, 1); };
+	void noteRejectedRemoval() { add(this->rejectedRemovals, 1); };
+	void noteClean() { this->firstSample = this->sampleCount = 0; };	//Pending samples are dropped with the content
+	void startSample(int sizeAfter);
+};
+#endif
+#endif // !_BUFFER_INSTRUMENTATION_H_
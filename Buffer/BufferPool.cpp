@@ -0,0 +1,133 @@
+//Buffer library by Huynh Hoang Kha
+//This implement a size-classed pool that recycles the data arrays of the array buffers
+#include <atomic>
+#include <cstring>
+#include "BufferPool.h"
+using namespace std;
+
+#pragma region BufferPool state
+namespace {
+	atomic<bool> poolEnabled(false);
+	atomic<bool> poolZeroOnAcquire(true);
+	atomic<int> poolMaxCachedBytes(4 * 1024 * 1024);
+	atomic<long long> statAcquired(0), statReused(0), statReleased(0), statHeapAllocations(0), statHeapFrees(0), statZeroedBytes(0);
+
+	struct FreeBlock { FreeBlock* next; };		//Free blocks are linked through their own first bytes
+
+	struct ThreadCache {
+		FreeBlock* heads[BUFFER_POOL_SIZE_CLASSES];
+		int cachedBytes;
+		ThreadCache() :cachedBytes(0) { memset(heads, 0, sizeof(heads)); }
+		~ThreadCache();
+		void clear();
+	};
+
+	thread_local ThreadCache threadCache;
+	thread_local bool threadCacheDestroyed = false;	//Trivially destructible, still readable while other thread_locals are destroyed
+
+	//Return the size class of a block of 'capacity' bytes, or -1 if it is too big to be cached
+	int sizeClassOf(int capacity) {
+		int sizeClass = 0, blockSize = BUFFER_POOL_MIN_BLOCK;
+		while (blockSize < capacity) {
+			blockSize <<= 1;
+			if (++sizeClass >= BUFFER_POOL_SIZE_CLASSES) return -1;
+		}
+		return sizeClass;
+	}
+
+	void ThreadCache::clear() {
+		for (int sizeClass = 0; sizeClass < BUFFER_POOL_SIZE_CLASSES; sizeClass++) {
+			while (heads[sizeClass] != NULL) {
+				FreeBlock* block = heads[sizeClass];
+				heads[sizeClass] = block->next;
+				delete[] (uint8_t*)block;
+				statHeapFrees.fetch_add(1, memory_order_relaxed);
+			}
+		}
+		cachedBytes = 0;
+	}
+
+	ThreadCache::~ThreadCache() {
+		clear();
+		threadCacheDestroyed = true;
+	}
+}
+#pragma endregion BufferPool state
+
+#pragma region BufferPool implementation
+//------------------------------------------------------------------------------------------------------------
+//Section: BufferPool implementation
+void BufferPool::setEnabled(bool enabled) { poolEnabled.store(enabled, memory_order_relaxed); }
+bool BufferPool::isEnabled() { return poolEnabled.load(memory_order_relaxed); }
+void BufferPool::setZeroOnAcquire(bool zeroOnAcquire) { poolZeroOnAcquire.store(zeroOnAcquire, memory_order_relaxed); }
+bool BufferPool::isZeroOnAcquire() { return poolZeroOnAcquire.load(memory_order_relaxed); }
+void BufferPool::setMaxCachedBytes(int bytesPerThread) { poolMaxCachedBytes.store(bytesPerThread, memory_order_relaxed); }
+
+uint8_t * BufferPool::acquire(int minCapacity, int * blockCapacity) {
+	statAcquired.fetch_add(1, memory_order_relaxed);
+	int sizeClass = sizeClassOf(minCapacity);
+	uint8_t* block = NULL;
+	if (sizeClass < 0) *blockCapacity = minCapacity;
+	else {
+		*blockCapacity = BUFFER_POOL_MIN_BLOCK << sizeClass;
+		if (!threadCacheDestroyed && threadCache.heads[sizeClass] != NULL) {
+			FreeBlock* freeBlock = threadCache.heads[sizeClass];
+			threadCache.heads[sizeClass] = freeBlock->next;
+			threadCache.cachedBytes -= *blockCapacity;
+			block = (uint8_t*)freeBlock;
+			statReused.fetch_add(1, memory_order_relaxed);
+		}
+	}
+	if (block == NULL) {
+		while (block == NULL) block = new uint8_t[*blockCapacity];
+		statHeapAllocations.fetch_add(1, memory_order_relaxed);
+	}
+	if (poolZeroOnAcquire.load(memory_order_relaxed)) {
+		memset((void*)block, '\0', *blockCapacity);
+		statZeroedBytes.fetch_add(*blockCapacity, memory_order_relaxed);
+	}
+	return block;
+}
+
+void BufferPool::release(uint8_t * block, int blockCapacity) {
+	if (block == NULL) return;
+	statReleased.fetch_add(1, memory_order_relaxed);
+	int sizeClass = sizeClassOf(blockCapacity);
+	//Only exact class-sized blocks can be recycled, anything else goes back to the heap
+	if (sizeClass < 0 || (BUFFER_POOL_MIN_BLOCK << sizeClass) != blockCapacity || threadCacheDestroyed
+		|| threadCache.cachedBytes + blockCapacity > poolMaxCachedBytes.load(memory_order_relaxed)) {
+		delete[] block;
+		statHeapFrees.fetch_add(1, memory_order_relaxed);
+		return;
+	}
+	FreeBlock* freeBlock = (FreeBlock*)block;
+	freeBlock->next = threadCache.heads[sizeClass];
+	threadCache.heads[sizeClass] = freeBlock;
+	threadCache.cachedBytes += blockCapacity;
+}
+
+void BufferPool::trim() {
+	if (!threadCacheDestroyed) threadCache.clear();
+}
+
+BufferPoolStats BufferPool::getStats() {
+	BufferPoolStats stats;
+	stats.acquired = statAcquired.load(memory_order_relaxed);
+	stats.reused = statReused.load(memory_order_relaxed);
+	stats.released = statReleased.load(memory_order_relaxed);
+	stats.heapAllocations = statHeapAllocations.load(memory_order_relaxed);
+	stats.heapFrees = statHeapFrees.load(memory_order_relaxed);
+	stats.zeroedBytes = statZeroedBytes.load(memory_order_relaxed);
+	return stats;
+}
+
+void BufferPool::resetStats() {
+	statAcquired.store(0, memory_order_relaxed);
+	statReused.store(0, memory_order_relaxed);
+	statReleased.store(0, memory_order_relaxed);
+	statHeapAllocations.store(0, memory_order_relaxed);
+	statHeapFrees.store(0, memory_order_relaxed);
+	statZeroedBytes.store(0, memory_order_relaxed);
+}
+//Endsection: BufferPool implementation
+#pragma endregion BufferPool implementation
@@ -0,0 +1,39 @@
+//Buffer library by Huynh Hoang Kha
+//This implement a size-classed pool that recycles the data arrays of the array buffers
+#pragma once
+#ifndef _BUFFER_POOL_H_
+#define _BUFFER_POOL_H_
+#include <cstdint>
+
+#define BUFFER_POOL_MIN_BLOCK 64				//Smallest block handed out by the pool
+#define BUFFER_POOL_SIZE_CLASSES 15				//Power-of-two classes from 64 bytes to 1 MB, bigger blocks always come from the heap
+
+struct BufferPoolStats {
+	long long acquired;			//Blocks handed out by acquire()
+	long long reused;			//Blocks served from a free list instead of the heap
+	long long released;			//Blocks given back by release()
+	long long heapAllocations;	//Blocks allocated from the heap
+	long long heapFrees;		//Blocks returned to the heap (free list over budget, oversized block or thread exit)
+	long long zeroedBytes;		//Bytes cleared by acquire() while zeroOnAcquire was on
+};
+
+/*
+Every thread keeps its own free list per size class, so acquire() and release() take no lock. A block released
+by another thread than the one that acquired it simply joins the releasing thread's free lists.
+ArrayBuffer and its derived classes take their data arrays from the pool while it is enabled.
+*/
+class BufferPool {
+public:
+	static void setEnabled(bool enabled);				//Route the array buffers' allocations through the pool (default: off)
+	static bool isEnabled();
+	static void setZeroOnAcquire(bool zeroOnAcquire);	//Clear blocks handed out by acquire() (default: on). Off saves a memset
+														//on blocks that are about to be overwritten, their old content stays readable
+	static bool isZeroOnAcquire();
+	static void setMaxCachedBytes(int bytesPerThread);	//Bytes a thread may keep in its free lists (default: 4 MB)
+	static uint8_t* acquire(int minCapacity, int* blockCapacity);	//Return a block of at least 'minCapacity' bytes, its real size goes to blockCapacity
+	static void release(uint8_t* block, int blockCapacity);		//Give back a block returned by acquire()
+	static void trim();									//Free every block cached by the calling thread
+	static BufferPoolStats getStats();
+	static void resetStats();
+};
+#endif // !_BUFFER_POOL_H_
@@ -0,0 +1,171 @@
+//Buffer library by Huynh Hoang Kha
+//Byte order helpers shared by every buffer
+#pragma once
+#ifndef _BYTE_ORDER_H_
+#define _BYTE_ORDER_H_
+#include <cstdint>
+#include <cstring>
+#include <cstdlib>
+#include <string>
+#include <tuple>
+#include <utility>
+//glibc's <endian.h> (pulled in by the standard headers above) defines BIG_ENDIAN and LITTLE_ENDIAN as macros
+#ifdef BIG_ENDIAN
+#undef BIG_ENDIAN
+#endif
+#ifdef LITTLE_ENDIAN
+#undef LITTLE_ENDIAN
+#endif
+
+enum Endian {
+	NOT_SET,
+	BIG_ENDIAN,
+	LITTLE_ENDIAN
+};
+
+//Host byte order, detected at compile time (every MSVC target is little endian)
+#if defined(__BYTE_ORDER__) && defined(__ORDER_BIG_ENDIAN__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+const Endian HOST_ENDIAN = BIG_ENDIAN;
+#else
+const Endian HOST_ENDIAN = LITTLE_ENDIAN;
+#endif
+
+//Byte order of the data stored in the buffers: a buffer told that the system is BIG_ENDIAN copies
+//values as they are and a buffer told LITTLE_ENDIAN reverses them, so the stored data is big endian
+#ifndef BUFFER_WIRE_ENDIAN
+#define BUFFER_WIRE_ENDIAN BIG_ENDIAN
+#endif
+
+/*
+Define BUFFER_COMPILE_TIME_ENDIAN to ignore the Endian given to the buffers' constructors and use HOST_ENDIAN
+instead: the byte order decision is then made by the compiler, NOT_SET stops being an error and every typed
+access becomes one unaligned load/store plus, when HOST_ENDIAN differs from BUFFER_WIRE_ENDIAN, one bswap.
+*/
+
+#pragma region Byte swapping
+inline uint16_t byteSwap16(uint16_t value) {
+#if defined(_MSC_VER)
+	return _byteswap_ushort(value);
+#else
+	return __builtin_bswap16(value);
+#endif
+}
+
+inline uint32_t byteSwap32(uint32_t value) {
+#if defined(_MSC_VER)
+	return _byteswap_ulong(value);
+#else
+	return __builtin_bswap32(value);
+#endif
+}
+
+inline uint64_t byteSwap64(uint64_t value) {
+#if defined(_MSC_VER)
+	return _byteswap_uint64(value);
+#else
+	return __builtin_bswap64(value);
+#endif
+}
+
+//Reverse the N bytes pointed by ptr, using one bswap instruction for the primitive sizes
+template <size_t N> inline void swapBytesInPlace(uint8_t* ptr) {
+	for (size_t i = 0; i < N / 2; i++) {
+		uint8_t temp = ptr[i];
+		ptr[i] = ptr[N - 1 - i];
+		ptr[N - 1 - i] = temp;
+	}
+}
+template <> inline void swapBytesInPlace<1>(uint8_t* ptr) {}
+template <> inline void swapBytesInPlace<2>(uint8_t* ptr) {
+	uint16_t value;
+	memcpy(&value, ptr, 2);
+	value = byteSwap16(value);
+	memcpy(ptr, &value, 2);
+}
+template <> inline void swapBytesInPlace<4>(uint8_t* ptr) {
+	uint32_t value;
+	memcpy(&value, ptr, 4);
+	value = byteSwap32(value);
+	memcpy(ptr, &value, 4);
+}
+template <> inline void swapBytesInPlace<8>(uint8_t* ptr) {
+	uint64_t value;
+	memcpy(&value, ptr, 8);
+	value = byteSwap64(value);
+	memcpy(ptr, &value, 8);
+}
+#pragma endregion Byte swapping
+
+#pragma region Primitive load/store
+//Store 'value' at dst (no alignment needed) in the 'wireEndian' byte order
+template <Endian wireEndian, typename T> inline void storePrimity(uint8_t* dst, T value) {
+	uint8_t bytes[sizeof(T)];
+	memcpy(bytes, &value, sizeof(T));
+	if (wireEndian != HOST_ENDIAN) swapBytesInPlace<sizeof(T)>(bytes);
+	memcpy(dst, bytes, sizeof(T));
+}
+
+//Load a value stored at src (no alignment needed) in the 'wireEndian' byte order
+template <Endian wireEndian, typename T> inline T loadPrimity(const uint8_t* src) {
+	uint8_t bytes[sizeof(T)];
+	memcpy(bytes, src, sizeof(T));
+	if (wireEndian != HOST_ENDIAN) swapBytesInPlace<sizeof(T)>(bytes);
+	T value;
+	memcpy(&value, bytes, sizeof(T));
+	return value;
+}
+
+//Store 'data' at dst for a buffer declared with 'systemEndian', return false if the endian is NOT_SET
+template <typename T> inline bool encodePrimity(uint8_t* dst, T data, Endian systemEndian) {
+#ifdef BUFFER_COMPILE_TIME_ENDIAN
+	storePrimity<BUFFER_WIRE_ENDIAN>(dst, data);
+#else
+	if (systemEndian == NOT_SET) return false;
+	uint8_t bytes[sizeof(T)];
+	memcpy(bytes, &data, sizeof(T));
+	if (systemEndian != BUFFER_WIRE_ENDIAN) swapBytesInPlace<sizeof(T)>(bytes);
+	memcpy(dst, bytes, sizeof(T));
+#endif
+	return true;
+}
+
+//Load a value stored at src by a buffer declared with 'systemEndian', return false if the endian is NOT_SET
+template <typename T> inline bool decodePrimity(const uint8_t* src, T* outputObject, Endian systemEndian) {
+#ifdef BUFFER_COMPILE_TIME_ENDIAN
+	*outputObject = loadPrimity<BUFFER_WIRE_ENDIAN, T>(src);
+#else
+	if (systemEndian == NOT_SET) return false;
+	uint8_t bytes[sizeof(T)];
+	memcpy(bytes, src, sizeof(T));
+	if (systemEndian != BUFFER_WIRE_ENDIAN) swapBytesInPlace<sizeof(T)>(bytes);
+	memcpy((void*)outputObject, bytes, sizeof(T));
+#endif
+	return true;
+}
+#pragma endregion Primitive load/store
+
+#pragma region Record encode/decode
+//Size in bytes of a record made of the primitives Ts..., known at compile time
+template <typename... Ts> struct RecordSize;
+template <> struct RecordSize<> { static constexpr int value = 0; };
+template <typename T, typename... Ts> struct RecordSize<T, Ts...> { static constexpr int value = (int)sizeof(T) + RecordSize<Ts...>::value; };
+
+//Store the fields one after another at dst, the recursion is expanded inline into one store per field
+inline void encodeRecord(uint8_t* dst, Endian systemEndian) {}
+template <typename T, typename... Ts> inline void encodeRecord(uint8_t* dst, Endian systemEndian, T field, Ts... rest) {
+	encodePrimity(dst, field, systemEndian);
+	encodeRecord(dst + sizeof(T), systemEndian, rest...);
+}
+
+//Load the fields stored one after another at src
+inline void decodeRecord(const uint8_t* src, Endian systemEndian) {}
+template <typename T, typename... Ts> inline void decodeRecord(const uint8_t* src, Endian systemEndian, T* field, Ts*... rest) {
+	decodePrimity(src, field, systemEndian);
+	decodeRecord(src + sizeof(T), systemEndian, rest...);
+}
+
+template <typename... Ts, size_t... I> inline void decodeRecordTuple(const uint8_t* src, Endian systemEndian, std::tuple<Ts...>& record, std::index_sequence<I...>) {
+	decodeRecord(src, systemEndian, &std::get<I>(record)...);
+}
+#pragma endregion Record encode/decode
+#endif // !_BYTE_ORDER_H_
@@ -0,0 +1,198 @@
+//Buffer library by Huynh Hoang Kha
+//Searching arrays for a byte, a set of bytes or a byte pattern: scalar, SSE2 and AVX2 versions and their run time dispatch
+#include <cstring>
+#include "ByteScan.h"
+#include "CpuFeatures.h"
+
+typedef int(*ByteFunction)(const uint8_t* data, int size, uint8_t value);
+typedef int(*AnyFunction)(const uint8_t* data, int size, const uint8_t* set, int setSize);
+typedef int(*PatternFunction)(const uint8_t* data, int size, const uint8_t* pattern, int patternSize);
+
+#pragma region Scalar implementation
+//------------------------------------------------------------------------------------------------------------
+//Section: Scalar implementation
+static int scanByteScalar(const uint8_t* data, int size, uint8_t value) {
+	for (int i = 0; i < size; i++) if (data[i] == value) return i;
+	return -1;
+}
+
+static int scanAnyScalar(const uint8_t* data, int size, const uint8_t* set, int setSize) {
+	bool inSet[256] = {};
+	for (int i = 0; i < setSize; i++) inSet[set[i]] = true;
+	for (int i = 0; i < size; i++) if (inSet[data[i]]) return i;
+	return -1;
+}
+
+//Positions from 'from' on, for the tails the SIMD versions leave, 'patternSize' is at least 2
+static int scanPatternFrom(const uint8_t* data, int size, const uint8_t* pattern, int patternSize, int from) {
+	uint8_t first = pattern[0], last = pattern[patternSize - 1];
+	for (int i = from; i + patternSize <= size; i++) {
+		if (data[i] == first && data[i + patternSize - 1] == last && memcmp(data + i + 1, pattern + 1, patternSize - 2) == 0) return i;
+	}
+	return -1;
+}
+
+static int scanPatternScalar(const uint8_t* data, int size, const uint8_t* pattern, int patternSize) {
+	return scanPatternFrom(data, size, pattern, patternSize, 0);
+}
+//Endsection: Scalar implementation
+#pragma endregion Scalar implementation
+
+#ifdef BUFFER_X86_SIMD
+#pragma region SIMD implementation
+//------------------------------------------------------------------------------------------------------------
+//Section: SIMD implementation
+static inline int lowestBit(uint32_t mask) {
+#if defined(_MSC_VER)
+	unsigned long index;
+	_BitScanForward(&index, mask);
+	return (int)index;
+#else
+	return __builtin_ctz(mask);
+#endif
+}
+
+BUFFER_TARGET("sse2") static int scanByteSse2(const uint8_t* data, int size, uint8_t value) {
+	__m128i needle = _mm_set1_epi8((char)value);
+	int i = 0;
+	for (; i + 16 <= size; i += 16) {
+		uint32_t mask = (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)(data + i)), needle));
+		if (mask != 0) return i + lowestBit(mask);
+	}
+	int found = scanByteScalar(data + i, size - i, value);
+	return found < 0 ? -1 : i + found;
+}
+
+BUFFER_TARGET("sse2") static int scanAnySse2(const uint8_t* data, int size, const uint8_t* set, int setSize) {
+	if (setSize > BYTE_SCAN_SIMD_SET_SIZE) return scanAnyScalar(data, size, set, setSize);
+	__m128i needles[BYTE_SCAN_SIMD_SET_SIZE];
+	for (int k = 0; k < setSize; k++) needles[k] = _mm_set1_epi8((char)set[k]);
+	int i = 0;
+	for (; i + 16 <= size; i += 16) {
+		__m128i block = _mm_loadu_si128((const __m128i*)(data + i));
+		__m128i hits = _mm_cmpeq_epi8(block, needles[0]);
+		for (int k = 1; k < setSize; k++) hits = _mm_or_si128(hits, _mm_cmpeq_epi8(block, needles[k]));
+		uint32_t mask = (uint32_t)_mm_movemask_epi8(hits);
+		if (mask != 0) return i + lowestBit(mask);
+	}
+	int found = scanAnyScalar(data + i, size - i, set, setSize);
+	return found < 0 ? -1 : i + found;
+}
+
+BUFFER_TARGET("sse2") static int scanPatternSse2(const uint8_t* data, int size, const uint8_t* pattern, int patternSize) {
+	__m128i first = _mm_set1_epi8((char)pattern[0]);
+	__m128i last = _mm_set1_epi8((char)pattern[patternSize - 1]);
+	int i = 0;
+	for (; i + patternSize - 1 + 16 <= size; i += 16) {
+		__m128i firstHits = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)(data + i)), first);
+		__m128i lastHits = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)(data + i + patternSize - 1)), last);
+		uint32_t mask = (uint32_t)_mm_movemask_epi8(_mm_and_si128(firstHits, lastHits));
+		for (; mask != 0; mask &= mask - 1) {
+			int candidate = i + lowestBit(mask);
+			if (memcmp(data + candidate + 1, pattern + 1, patternSize - 2) == 0) return candidate;
+		}
+	}
+	return scanPatternFrom(data, size, pattern, patternSize, i);
+}
+
+//Two 32-byte blocks per round, the loop only looks for which one matched once their OR did
+BUFFER_TARGET("avx2") static int scanByteAvx2(const uint8_t* data, int size, uint8_t value) {
+	__m256i needle = _mm256_set1_epi8((char)value);
+	int i = 0;
+	for (; i + 64 <= size; i += 64) {
+		__m256i firstHits = _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*)(data + i)), needle);
+		__m256i secondHits = _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*)(data + i + 32)), needle);
+		if (_mm256_testz_si256(_mm256_or_si256(firstHits, secondHits), _mm256_or_si256(firstHits, secondHits))) continue;
+		uint32_t mask = (uint32_t)_mm256_movemask_epi8(firstHits);
+		if (mask != 0) return i + lowestBit(mask);
+		return i + 32 + lowestBit((uint32_t)_mm256_movemask_epi8(secondHits));
+	}
+	for (; i + 32 <= size; i += 32) {
+		uint32_t mask = (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*)(data + i)), needle));
+		if (mask != 0) return i + lowestBit(mask);
+	}
+	int found = scanByteScalar(data + i, size - i, value);
+	return found < 0 ? -1 : i + found;
+}
+
+BUFFER_TARGET("avx2") static int scanAnyAvx2(const uint8_t* data, int size, const uint8_t* set, int setSize) {
+	if (setSize > BYTE_SCAN_SIMD_SET_SIZE) return scanAnyScalar(data, size, set, setSize);
+	__m256i needles[BYTE_SCAN_SIMD_SET_SIZE];
+	for (int k = 0; k < setSize; k++) needles[k] = _mm256_set1_epi8((char)set[k]);
+	int i = 0;
+	for (; i + 32 <= size; i += 32) {
+		__m256i block = _mm256_loadu_si256((const __m256i*)(data + i));
+		__m256i hits = _mm256_cmpeq_epi8(block, needles[0]);
+		for (int k = 1; k < setSize; k++) hits = _mm256_or_si256(hits, _mm256_cmpeq_epi8(block, needles[k]));
+		uint32_t mask = (uint32_t)_mm256_movemask_epi8(hits);
+		if (mask != 0) return i + lowestBit(mask);
+	}
+	int found = scanAnySse2(data + i, size - i, set, setSize);
+	return found < 0 ? -1 : i + found;
+}
+
+BUFFER_TARGET("avx2") static int scanPatternAvx2(const uint8_t* data, int size, const uint8_t* pattern, int patternSize) {
+	__m256i first = _mm256_set1_epi8((char)pattern[0]);
+	__m256i last = _mm256_set1_epi8((char)pattern[patternSize - 1]);
+	int i = 0;
+	for (; i + patternSize - 1 + 32 <= size; i += 32) {
+		__m256i firstHits = _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*)(data + i)), first);
+		__m256i lastHits = _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*)(data + i + patternSize - 1)), last);
+		uint32_t mask = (uint32_t)_mm256_movemask_epi8(_mm256_and_si256(firstHits, lastHits));
+		for (; mask != 0; mask &= mask - 1) {
+			int candidate = i + lowestBit(mask);
+			if (memcmp(data + candidate + 1, pattern + 1, patternSize - 2) == 0) return candidate;
+		}
+	}
+	return scanPatternFrom(data, size, pattern, patternSize, i);
+}
+//Endsection: SIMD implementation
+#pragma endregion SIMD implementation
+#endif
+
+#pragma region Dispatch
+//------------------------------------------------------------------------------------------------------------
+//Section: Dispatch implementation
+static ByteScanImplementation currentImplementation = SCALAR_BYTE_SCAN;
+static ByteFunction scanByte = scanByteScalar;
+static AnyFunction scanAny = scanAnyScalar;
+static PatternFunction scanPattern = scanPatternScalar;
+
+bool setByteScanImplementation(ByteScanImplementation implementation) {
+#ifdef BUFFER_X86_SIMD
+	if (implementation == AVX2_BYTE_SCAN && !cpuSupports(CPU_AVX2)) return false;
+	if (implementation == SSE2_BYTE_SCAN && !cpuSupports(CPU_SSE2)) return false;
+	switch (implementation) {
+	case AVX2_BYTE_SCAN: scanByte = scanByteAvx2; scanAny = scanAnyAvx2; scanPattern = scanPatternAvx2; break;
+	case SSE2_BYTE_SCAN: scanByte = scanByteSse2; scanAny = scanAnySse2; scanPattern = scanPatternSse2; break;
+	default: scanByte = scanByteScalar; scanAny = scanAnyScalar; scanPattern = scanPatternScalar; break;
+	}
+#else
+	if (implementation != SCALAR_BYTE_SCAN) return false;
+#endif
+	currentImplementation = implementation;
+	return true;
+}
+
+static bool implementationSelected = setByteScanImplementation(AVX2_BYTE_SCAN) || setByteScanImplementation(SSE2_BYTE_SCAN) || setByteScanImplementation(SCALAR_BYTE_SCAN);
+
+ByteScanImplementation getByteScanImplementation() { return currentImplementation; }
+
+int scanForByte(const uint8_t* data, int size, uint8_t value) {
+	if (size <= 0) return -1;
+	return scanByte(data, size, value);
+}
+
+int scanForAny(const uint8_t* data, int size, const uint8_t* set, int setSize) {
+	if (size <= 0 || setSize <= 0) return -1;
+	if (setSize == 1) return scanByte(data, size, set[0]);
+	return scanAny(data, size, set, setSize);
+}
+
+int scanForPattern(const uint8_t* data, int size, const uint8_t* pattern, int patternSize) {
+	if (patternSize <= 0) return 0;
+	if (patternSize > size) return -1;
+	if (patternSize == 1) return scanByte(data, size, pattern[0]);
+	return scanPattern(data, size, pattern, patternSize);
+}
+//Endsection: Dispatch implementation
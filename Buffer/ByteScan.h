@@ -0,0 +1,29 @@
+//Buffer library by Huynh Hoang Kha
+//Searching arrays for a byte, a set of bytes or a byte pattern, used by the find methods of the buffers
+#pragma once
+#ifndef _BYTE_SCAN_H_
+#define _BYTE_SCAN_H_
+#include <cstdint>
+
+/*
+The scan functions return the index of the first match in the 'size' bytes at data, or -1 if there is none.
+scanForAny matches any of the 'setSize' bytes at 'set', scanForPattern the first place where the 'patternSize'
+bytes at 'pattern' start (an empty pattern matches at 0).
+On x86 they compare 16 (SSE2) or 32 (AVX2) bytes per instruction, chosen once at run time from what the CPU
+supports, and fall back to byte loops elsewhere. The pattern search compares the first and the last byte of the
+pattern at every position at once and only checks the whole pattern where both match.
+*/
+enum ByteScanImplementation {
+	SCALAR_BYTE_SCAN,
+	SSE2_BYTE_SCAN,
+	AVX2_BYTE_SCAN
+};
+
+#define BYTE_SCAN_SIMD_SET_SIZE 16	//Bigger sets are looked up in a table byte by byte
+
+int scanForByte(const uint8_t* data, int size, uint8_t value);
+int scanForAny(const uint8_t* data, int size, const uint8_t* set, int setSize);
+int scanForPattern(const uint8_t* data, int size, const uint8_t* pattern, int patternSize);
+ByteScanImplementation getByteScanImplementation();							//Return the implementation in use
+bool setByteScanImplementation(ByteScanImplementation implementation);		//Switch to another scan implementation, false if this CPU lacks its instructions (see ByteScanBenchmark)
+#endif // !_BYTE_SCAN_H_
@@ -0,0 +1,141 @@
+//Buffer library by Huynh Hoang Kha
+//Byte order conversion of whole arrays of primitives: scalar, SSSE3 and AVX2 versions and their run time dispatch
+#include "ByteSwapSimd.h"
+#include "CpuFeatures.h"
+
+typedef void(*SwapFunction)(uint8_t* dst, const uint8_t* src, int count);
+
+#pragma region Scalar implementation
+//------------------------------------------------------------------------------------------------------------
+//Section: Scalar implementation
+static void swapScalar16(uint8_t* dst, const uint8_t* src, int count) {
+	for (int i = 0; i < count; i++) {
+		uint16_t value;
+		memcpy(&value, src + 2 * i, 2);
+		value = byteSwap16(value);
+		memcpy(dst + 2 * i, &value, 2);
+	}
+}
+
+static void swapScalar32(uint8_t* dst, const uint8_t* src, int count) {
+	for (int i = 0; i < count; i++) {
+		uint32_t value;
+		memcpy(&value, src + 4 * i, 4);
+		value = byteSwap32(value);
+		memcpy(dst + 4 * i, &value, 4);
+	}
+}
+
+static void swapScalar64(uint8_t* dst, const uint8_t* src, int count) {
+	for (int i = 0; i < count; i++) {
+		uint64_t value;
+		memcpy(&value, src + 8 * i, 8);
+		value = byteSwap64(value);
+		memcpy(dst + 8 * i, &value, 8);
+	}
+}
+//Endsection: Scalar implementation
+#pragma endregion Scalar implementation
+
+#ifdef BUFFER_X86_SIMD
+#pragma region SIMD implementation
+//------------------------------------------------------------------------------------------------------------
+//Section: SIMD implementation
+//Shuffle masks reversing every 2, 4 or 8 bytes of a 16-byte lane
+static const int8_t swapMask16[16] = { 1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14 };
+static const int8_t swapMask32[16] = { 3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12 };
+static const int8_t swapMask64[16] = { 7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8 };
+
+//Swap 'bytes' bytes (a multiple of the value size) with 16-byte shuffles, return how many bytes were done
+BUFFER_TARGET("ssse3") static int swapSsse3(uint8_t* dst, const uint8_t* src, int bytes, const int8_t* maskBytes) {
+	__m128i mask = _mm_loadu_si128((const __m128i*)maskBytes);
+	int done = 0;
+	for (; done + 16 <= bytes; done += 16) {
+		__m128i value = _mm_loadu_si128((const __m128i*)(src + done));
+		_mm_storeu_si128((__m128i*)(dst + done), _mm_shuffle_epi8(value, mask));
+	}
+	return done;
+}
+
+//Same with 32-byte shuffles, the mask is repeated in both 16-byte lanes
+BUFFER_TARGET("avx2") static int swapAvx2(uint8_t* dst, const uint8_t* src, int bytes, const int8_t* maskBytes) {
+	__m256i mask = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*)maskBytes));
+	int done = 0;
+	for (; done + 64 <= bytes; done += 64) {
+		__m256i first = _mm256_loadu_si256((const __m256i*)(src + done));
+		__m256i second = _mm256_loadu_si256((const __m256i*)(src + done + 32));
+		_mm256_storeu_si256((__m256i*)(dst + done), _mm256_shuffle_epi8(first, mask));
+		_mm256_storeu_si256((__m256i*)(dst + done + 32), _mm256_shuffle_epi8(second, mask));
+	}
+	for (; done + 32 <= bytes; done += 32) {
+		__m256i value = _mm256_loadu_si256((const __m256i*)(src + done));
+		_mm256_storeu_si256((__m256i*)(dst + done), _mm256_shuffle_epi8(value, mask));
+	}
+	return done;
+}
+
+static void swapSsse3_16(uint8_t* dst, const uint8_t* src, int count) {
+	int done = swapSsse3(dst, src, 2 * count, swapMask16);
+	swapScalar16(dst + done, src + done, count - done / 2);
+}
+
+static void swapSsse3_32(uint8_t* dst, const uint8_t* src, int count) {
+	int done = swapSsse3(dst, src, 4 * count, swapMask32);
+	swapScalar32(dst + done, src + done, count - done / 4);
+}
+
+static void swapSsse3_64(uint8_t* dst, const uint8_t* src, int count) {
+	int done = swapSsse3(dst, src, 8 * count, swapMask64);
+	swapScalar64(dst + done, src + done, count - done / 8);
+}
+
+static void swapAvx2_16(uint8_t* dst, const uint8_t* src, int count) {
+	int done = swapAvx2(dst, src, 2 * count, swapMask16);
+	swapScalar16(dst + done, src + done, count - done / 2);
+}
+
+static void swapAvx2_32(uint8_t* dst, const uint8_t* src, int count) {
+	int done = swapAvx2(dst, src, 4 * count, swapMask32);
+	swapScalar32(dst + done, src + done, count - done / 4);
+}
+
+static void swapAvx2_64(uint8_t* dst, const uint8_t* src, int count) {
+	int done = swapAvx2(dst, src, 8 * count, swapMask64);
+	swapScalar64(dst + done, src + done, count - done / 8);
+}
+//Endsection: SIMD implementation
+#pragma endregion SIMD implementation
+#endif
+
+#pragma region Dispatch
+//------------------------------------------------------------------------------------------------------------
+//Section: Dispatch implementation
+static ByteSwapImplementation currentImplementation = SCALAR_BYTE_SWAP;
+static SwapFunction swap16 = swapScalar16;
+static SwapFunction swap32 = swapScalar32;
+static SwapFunction swap64 = swapScalar64;
+
+bool setByteSwapImplementation(ByteSwapImplementation implementation) {
+#ifdef BUFFER_X86_SIMD
+	if (implementation == AVX2_BYTE_SWAP && !cpuSupports(CPU_AVX2)) return false;
+	if (implementation == SSSE3_BYTE_SWAP && !cpuSupports(CPU_SSSE3)) return false;
+	switch (implementation) {
+	case AVX2_BYTE_SWAP: swap16 = swapAvx2_16; swap32 = swapAvx2_32; swap64 = swapAvx2_64; break;
+	case SSSE3_BYTE_SWAP: swap16 = swapSsse3_16; swap32 = swapSsse3_32; swap64 = swapSsse3_64; break;
+	default: swap16 = swapScalar16; swap32 = swapScalar32; swap64 = swapScalar64; break;
+	}
+#else
+	if (implementation != SCALAR_BYTE_SWAP) return false;
+#endif
+	currentImplementation = implementation;
+	return true;
+}
+
+static bool implementationSelected = setByteSwapImplementation(AVX2_BYTE_SWAP) || setByteSwapImplementation(SSSE3_BYTE_SWAP) || setByteSwapImplementation(SCALAR_BYTE_SWAP);
+
+ByteSwapImplementation getByteSwapImplementation() { return currentImplementation; }
+void swapBytesArray16(uint8_t* dst, const uint8_t* src, int count) { swap16(dst, src, count); }
+void swapBytesArray32(uint8_t* dst, const uint8_t* src, int count) { swap32(dst, src, count); }
+void swapBytesArray64(uint8_t* dst, const uint8_t* src, int count) { swap64(dst, src, count); }
+//Endsection: Dispatch implementation
+#pragma endregion Dispatch
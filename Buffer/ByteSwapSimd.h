@@ -0,0 +1,59 @@
+//Buffer library by Huynh Hoang Kha
+//Byte order conversion of whole arrays of primitives, used by the batched buffer methods
+#pragma once
+#ifndef _BYTE_SWAP_SIMD_H_
+#define _BYTE_SWAP_SIMD_H_
+#include "ByteOrder.h"
+
+/*
+The swapBytesArray functions copy 'count' values from src to dst reversing the bytes of each value.
+src and dst may be the same array (in-place swap) but must not overlap otherwise, neither needs to be aligned.
+On x86 they use AVX2 or SSSE3 byte shuffles, chosen once at run time from what the CPU supports,
+and fall back to the scalar bswap loop elsewhere.
+*/
+enum ByteSwapImplementation {
+	SCALAR_BYTE_SWAP,
+	SSSE3_BYTE_SWAP,
+	AVX2_BYTE_SWAP
+};
+
+void swapBytesArray16(uint8_t* dst, const uint8_t* src, int count);
+void swapBytesArray32(uint8_t* dst, const uint8_t* src, int count);
+void swapBytesArray64(uint8_t* dst, const uint8_t* src, int count);
+ByteSwapImplementation getByteSwapImplementation();							//Return the implementation in use
+bool setByteSwapImplementation(ByteSwapImplementation implementation);		//Force an implementation (for benchmarks), return false if the CPU does not support it
+
+template <size_t N> inline void swapBytesArray(uint8_t* dst, const uint8_t* src, int count);
+template <> inline void swapBytesArray<1>(uint8_t* dst, const uint8_t* src, int count) { if (dst != src) memcpy(dst, src, count); }
+template <> inline void swapBytesArray<2>(uint8_t* dst, const uint8_t* src, int count) { swapBytesArray16(dst, src, count); }
+template <> inline void swapBytesArray<4>(uint8_t* dst, const uint8_t* src, int count) { swapBytesArray32(dst, src, count); }
+template <> inline void swapBytesArray<8>(uint8_t* dst, const uint8_t* src, int count) { swapBytesArray64(dst, src, count); }
+
+//Store 'count' values at dst for a buffer declared with 'systemEndian', return false if the endian is NOT_SET
+template <typename T> inline bool encodePrimities(uint8_t* dst, const T* src, int count, Endian systemEndian) {
+#ifdef BUFFER_COMPILE_TIME_ENDIAN
+	bool swap = HOST_ENDIAN != BUFFER_WIRE_ENDIAN;
+#else
+	if (systemEndian == NOT_SET) return false;
+	bool swap = systemEndian != BUFFER_WIRE_ENDIAN;
+#endif
+	if (count <= 0) return true;
+	if (swap) swapBytesArray<sizeof(T)>(dst, (const uint8_t*)src, count);
+	else memcpy((void*)dst, (const void*)src, count * sizeof(T));
+	return true;
+}
+
+//Load 'count' values stored at src by a buffer declared with 'systemEndian', return false if the endian is NOT_SET
+template <typename T> inline bool decodePrimities(T* dst, const uint8_t* src, int count, Endian systemEndian) {
+#ifdef BUFFER_COMPILE_TIME_ENDIAN
+	bool swap = HOST_ENDIAN != BUFFER_WIRE_ENDIAN;
+#else
+	if (systemEndian == NOT_SET) return false;
+	bool swap = systemEndian != BUFFER_WIRE_ENDIAN;
+#endif
+	if (count <= 0) return true;
+	if (swap) swapBytesArray<sizeof(T)>((uint8_t*)dst, src, count);
+	else memcpy((void*)dst, (const void*)src, count * sizeof(T));
+	return true;
+}
+#endif // !_BYTE_SWAP_SIMD_H_
@@ -0,0 +1,46 @@
+//Buffer library by Huynh Hoang Kha
+//Cache line size and heap allocation aligned to it, for the classes that keep their threads' counters on separate cache lines
+#pragma once
+#ifndef _CACHE_ALIGNED_H_
+#define _CACHE_ALIGNED_H_
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#if defined(_WIN32)
+#include <malloc.h>
+#endif
+
+#ifndef BUFFER_CACHE_LINE_SIZE
+#define BUFFER_CACHE_LINE_SIZE 64
+#endif
+
+/*
+Before C++17 'new' only guarantees the alignment of the fundamental types, not the alignas(BUFFER_CACHE_LINE_SIZE)
+of a member, so two such members could still share a cache line. Classes with such members derive from CacheAligned:
+its operator new/delete take the memory from posix_memalign (_aligned_malloc on Windows) at a cache line boundary.
+Objects on the stack or inside another object get their alignment from the compiler, containers using
+std::allocator (std::vector...) do not before C++17.
+*/
+class CacheAligned {
+public:
+	static void* operator new(size_t size) {
+		void* memory = NULL;
+#if defined(_WIN32)
+		memory = _aligned_malloc(size, BUFFER_CACHE_LINE_SIZE);
+#else
+		if (posix_memalign(&memory, BUFFER_CACHE_LINE_SIZE, size) != 0) memory = NULL;
+#endif
+		if (memory == NULL) throw std::bad_alloc();
+		return memory;
+	};
+	static void operator delete(void* memory) {
+#if defined(_WIN32)
+		_aligned_free(memory);
+#else
+		free(memory);
+#endif
+	};
+	static void* operator new[](size_t size) { return operator new(size); };
+	static void operator delete[](void* memory) { operator delete(memory); };
+};
+#endif // !_CACHE_ALIGNED_H_
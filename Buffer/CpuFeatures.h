@@ -0,0 +1,55 @@
+//Buffer library by Huynh Hoang Kha
+//Internal to the library: x86 feature detection and the target attribute of the run time dispatched SIMD code
+#pragma once
+#ifndef _CPU_FEATURES_H_
+#define _CPU_FEATURES_H_
+
+/*
+ByteSwapSimd, Crc32c and ByteScan compile their SIMD versions with BUFFER_TARGET instead of global -m flags,
+so one binary runs on any x86 CPU: each file calls its set...Implementation from a static initializer, trying
+the best version first, and the setter only accepts a version cpuSupports says this CPU can run.
+BUFFER_X86_SIMD is left undefined on other architectures, where only the portable versions are built.
+*/
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#define BUFFER_X86_SIMD
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define BUFFER_TARGET(features)
+#else
+#define BUFFER_TARGET(features) __attribute__((target(features)))
+#endif
+
+enum CpuFeature {
+	CPU_SSE2,
+	CPU_SSSE3,
+	CPU_SSE42,
+	CPU_AVX2
+};
+
+inline bool cpuSupports(CpuFeature feature) {
+#if defined(_MSC_VER)
+	int info[4];
+	__cpuid(info, 1);
+	switch (feature) {
+	case CPU_SSE2: return (info[3] & (1 << 26)) != 0;
+	case CPU_SSSE3: return (info[2] & (1 << 9)) != 0;
+	case CPU_SSE42: return (info[2] & (1 << 20)) != 0;
+	default:
+		//AVX2 also needs the OS to save the YMM registers
+		if ((info[2] & (1 << 27)) == 0 || (_xgetbv(0) & 6) != 6) return false;
+		__cpuidex(info, 7, 0);
+		return (info[1] & (1 << 5)) != 0;
+	}
+#else
+	__builtin_cpu_init();
+	switch (feature) {
+	case CPU_SSE2: return __builtin_cpu_supports("sse2");
+	case CPU_SSSE3: return __builtin_cpu_supports("ssse3");
+	case CPU_SSE42: return __builtin_cpu_supports("sse4.2");
+	default: return __builtin_cpu_supports("avx2");
+	}
+#endif
+}
+#endif
+#endif // !_CPU_FEATURES_H_
@@ -0,0 +1,102 @@
+//Buffer library by Huynh Hoang Kha
+//CRC32C: slicing-by-8 and SSE4.2 versions and their run time dispatch
+#include <cstring>
+#include "Crc32c.h"
+#include "CpuFeatures.h"
+
+typedef uint32_t(*CrcFunction)(uint32_t crc, const uint8_t* data, int length);
+
+#pragma region Software implementation
+//------------------------------------------------------------------------------------------------------------
+//Section: Software implementation
+//crcTable[0] is the usual byte table of the reflected polynomial, crcTable[k][i] is the CRC of byte i followed by k zero bytes
+static uint32_t crcTable[8][256];
+
+static bool buildTables() {
+	for (int i = 0; i < 256; i++) {
+		uint32_t crc = i;
+		for (int bit = 0; bit < 8; bit++) crc = (crc & 1) ? (crc >> 1) ^ 0x82F63B78 : crc >> 1;
+		crcTable[0][i] = crc;
+	}
+	for (int i = 0; i < 256; i++)
+		for (int k = 1; k < 8; k++) crcTable[k][i] = (crcTable[k - 1][i] >> 8) ^ crcTable[0][crcTable[k - 1][i] & 0xFF];
+	return true;
+}
+static bool tablesBuilt = buildTables();
+
+//Little endian load whatever the host is, the compiler turns it into one load on little endian hosts
+static inline uint32_t loadLittle32(const uint8_t* data) {
+	return (uint32_t)data[0] | ((uint32_t)data[1] << 8) | ((uint32_t)data[2] << 16) | ((uint32_t)data[3] << 24);
+}
+
+//Eight bytes per step, the eight table lookups do not depend on each other
+static uint32_t crcSoftware(uint32_t crc, const uint8_t* data, int length) {
+	for (; length >= 8; data += 8, length -= 8) {
+		uint32_t low = crc ^ loadLittle32(data);
+		uint32_t high = loadLittle32(data + 4);
+		crc = crcTable[7][low & 0xFF] ^ crcTable[6][(low >> 8) & 0xFF] ^ crcTable[5][(low >> 16) & 0xFF] ^ crcTable[4][low >> 24]
+			^ crcTable[3][high & 0xFF] ^ crcTable[2][(high >> 8) & 0xFF] ^ crcTable[1][(high >> 16) & 0xFF] ^ crcTable[0][high >> 24];
+	}
+	for (; length > 0; data++, length--) crc = (crc >> 8) ^ crcTable[0][(crc ^ *data) & 0xFF];
+	return crc;
+}
+//Endsection: Software implementation
+#pragma endregion Software implementation
+
+#ifdef BUFFER_X86_SIMD
+#pragma region SSE4.2 implementation
+//------------------------------------------------------------------------------------------------------------
+//Section: SSE4.2 implementation
+BUFFER_TARGET("sse4.2") static uint32_t crcSse42(uint32_t crc, const uint8_t* data, int length) {
+#if defined(__x86_64__) || defined(_M_X64)
+	uint64_t crc64 = crc;
+	for (; length >= 8; data += 8, length -= 8) {
+		uint64_t value;
+		memcpy(&value, data, 8);
+		crc64 = _mm_crc32_u64(crc64, value);
+	}
+	crc = (uint32_t)crc64;
+#endif
+	for (; length >= 4; data += 4, length -= 4) {
+		uint32_t value;
+		memcpy(&value, data, 4);
+		crc = _mm_crc32_u32(crc, value);
+	}
+	for (; length > 0; data++, length--) crc = _mm_crc32_u8(crc, *data);
+	return crc;
+}
+//Endsection: SSE4.2 implementation
+#pragma endregion SSE4.2 implementation
+#endif
+
+#pragma region Dispatch
+//------------------------------------------------------------------------------------------------------------
+//Section: Dispatch implementation
+static Crc32cImplementation currentImplementation = SOFTWARE_CRC32C;
+static CrcFunction crcFunction = crcSoftware;
+
+bool setCrc32cImplementation(Crc32cImplementation implementation) {
+	if (implementation == SSE42_CRC32C) {
+#ifdef BUFFER_X86_SIMD
+		if (!cpuSupports(CPU_SSE42)) return false;
+		crcFunction = crcSse42;
+#else
+		return false;
+#endif
+	}
+	else crcFunction = crcSoftware;
+	currentImplementation = implementation;
+	return true;
+}
+
+static bool implementationSelected = setCrc32cImplementation(SSE42_CRC32C) || setCrc32cImplementation(SOFTWARE_CRC32C);
+
+Crc32cImplementation getCrc32cImplementation() { return currentImplementation; }
+
+uint32_t crc32c(const void* data, int length, uint32_t crc) {
+	if (length <= 0) return crc;
+	//The running value is kept inverted between the bytes
+	return ~crcFunction(~crc, (const uint8_t*)data, length);
+}
+//Endsection: Dispatch implementation
+#pragma endregion Dispatch
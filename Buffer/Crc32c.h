@@ -0,0 +1,23 @@
+//Buffer library by Huynh Hoang Kha
+//CRC32C (Castagnoli) checksums, used to check buffer contents without copying them out
+#pragma once
+#ifndef _CRC32C_H_
+#define _CRC32C_H_
+#include <cstdint>
+
+/*
+crc32c returns the CRC32C of 'length' bytes, the same value as iSCSI, ext4 or SSE4.2 software.
+It is incremental: pass the CRC of the bytes that come before (0 for none), so that
+crc32c(b, lengthB, crc32c(a, lengthA)) is the CRC of a then b. A ring buffer that wraps is done in two calls.
+On x86 it uses the SSE4.2 crc32 instruction when the CPU has it (chosen once at run time),
+elsewhere a slicing-by-8 table loop.
+*/
+enum Crc32cImplementation {
+	SOFTWARE_CRC32C,
+	SSE42_CRC32C
+};
+
+uint32_t crc32c(const void* data, int length, uint32_t crc = 0);
+Crc32cImplementation getCrc32cImplementation();							//Return the implementation in use
+bool setCrc32cImplementation(Crc32cImplementation implementation);		//Select SOFTWARE_CRC32C or SSE42_CRC32C, false when SSE4.2 is missing
+#endif // !_CRC32C_H_
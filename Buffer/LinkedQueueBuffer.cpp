@@ -0,0 +1,210 @@
+//Buffer library by Huynh Hoang Kha
+//This implement an unbounded queue buffer over a linked list of fixed-size chunks
+#include "LinkedQueueBuffer.h"
+
+#pragma region LinkedQueueBuffer implementation
+//------------------------------------------------------------------------------------------------------------
+//Section: LinkedQueueBuffer implementation
+LinkedQueueBuffer::LinkedQueueBuffer(Endian systemEndian, int chunkSize, int capacity, int maxFreeChunks) {
+	if (capacity < 0) {
+		BufferException bE(NEGATIVE_CAPACITY);
+		throw bE;
+	}
+	if (chunkSize <= 0) {
+		BufferException bE(INVALID_CHUNK_SIZE);
+		throw bE;
+	}
+	this->endian = systemEndian;
+	this->capacity = capacity;
+	this->size = 0;
+	this->chunkSize = chunkSize;
+	this->maxFreeChunks = maxFreeChunks;
+	this->headChunk = this->tailChunk = this->freeChunks = NULL;
+	this->headOffset = this->tailOffset = 0;
+	this->freeChunkCount = this->liveChunks = 0;
+}
+
+LinkedQueueBuffer::~LinkedQueueBuffer() {
+	this->maxFreeChunks = 0;
+	this->clean();
+	while (this->freeChunks != NULL) {
+		Chunk* chunk = this->freeChunks;
+		this->freeChunks = chunk->next;
+		delete[] (uint8_t*)chunk;
+	}
+}
+
+LinkedQueueBuffer::Chunk * LinkedQueueBuffer::newChunk() {
+	Chunk* chunk = this->freeChunks;
+	if (chunk != NULL) {
+		this->freeChunks = chunk->next;
+		this->freeChunkCount--;
+	}
+	else {
+		uint8_t* memory = NULL;
+		while (memory == NULL) memory = new uint8_t[sizeof(Chunk) + this->chunkSize];
+		chunk = (Chunk*)memory;
+	}
+	chunk->next = NULL;
+	this->liveChunks++;
+	return chunk;
+}
+
+void LinkedQueueBuffer::recycleChunk(Chunk * chunk) {
+	this->liveChunks--;
+	if (this->freeChunkCount < this->maxFreeChunks) {
+		chunk->next = this->freeChunks;
+		this->freeChunks = chunk;
+		this->freeChunkCount++;
+	}
+	else delete[] (uint8_t*)chunk;
+}
+
+void LinkedQueueBuffer::clean() {
+	while (this->headChunk != NULL) {
+		Chunk* chunk = this->headChunk;
+		this->headChunk = chunk->next;
+		this->recycleChunk(chunk);
+	}
+	this->tailChunk = NULL;
+	this->headOffset = this->tailOffset = 0;
+	this->size = 0;
+}
+
+bool LinkedQueueBuffer::locate(int offset, Chunk ** chunk, int * index) {
+	if (offset < 0 || offset >= this->size) return false;
+	int position = this->headOffset + offset;
+	Chunk* current = this->headChunk;
+	while (position >= this->chunkSize) {
+		position -= this->chunkSize;
+		current = current->next;
+	}
+	*chunk = current;
+	*index = position;
+	return true;
+}
+
+void LinkedQueueBuffer::copyOut(int offset, void * memPtr, int blockSize) {
+	if (blockSize == 0) return;
+	Chunk* chunk = NULL;
+	int index = 0;
+	this->locate(offset, &chunk, &index);
+	uint8_t* destination = (uint8_t*)memPtr;
+	while (blockSize > 0) {
+		int step = this->chunkSize - index < blockSize ? this->chunkSize - index : blockSize;
+		memcpy((void*)destination, (void*)(chunk->data() + index), step);
+		destination += step;
+		blockSize -= step;
+		chunk = chunk->next;
+		index = 0;
+	}
+}
+
+void LinkedQueueBuffer::copyIn(int offset, const void * memPtr, int blockSize) {
+	if (blockSize == 0) return;
+	Chunk* chunk = NULL;
+	int index = 0;
+	this->locate(offset, &chunk, &index);
+	const uint8_t* source = (const uint8_t*)memPtr;
+	while (blockSize > 0) {
+		int step = this->chunkSize - index < blockSize ? this->chunkSize - index : blockSize;
+		memcpy((void*)(chunk->data() + index), (const void*)source, step);
+		source += step;
+		blockSize -= step;
+		chunk = chunk->next;
+		index = 0;
+	}
+}
+
+uint8_t & LinkedQueueBuffer::operator[](int index) {
+	if (index < 0) {
+		BufferException bE(NEGATIVE_INDEX);
+		throw bE;
+	}
+	Chunk* chunk;
+	int chunkIndex;
+	if (!this->locate(index, &chunk, &chunkIndex)) {
+		BufferException bE(OUT_OF_RANGE_INDEX);
+		throw bE;
+	}
+	return chunk->data()[chunkIndex];
+}
+
+string LinkedQueueBuffer::getString() {
+	string result;
+	result.reserve(this->size);
+	int remaining = this->size, index = this->headOffset;
+	for (Chunk* chunk = this->headChunk; remaining > 0; chunk = chunk->next) {
+		int step = this->chunkSize - index < remaining ? this->chunkSize - index : remaining;
+		result.append((const char*)(chunk->data() + index), step);
+		remaining -= step;
+		index = 0;
+	}
+	return result;
+}
+
+int LinkedQueueBuffer::getInt(int offset) { return this->getPrimityOrThrow<int>(offset); }
+float LinkedQueueBuffer::getFloat(int offset) { return this->getPrimityOrThrow<float>(offset); }
+long LinkedQueueBuffer::getLong(int offset) { return this->getPrimityOrThrow<long>(offset); }
+double LinkedQueueBuffer::getDouble(int offset) { return this->getPrimityOrThrow<double>(offset); }
+
+bool LinkedQueueBuffer::getMemoryBlock(void * memPtr, int offset, int size) {
+	if (offset < 0 || size < 0 || offset + size > this->size) return false;
+	this->copyOut(offset, memPtr, size);
+	return true;
+}
+
+bool LinkedQueueBuffer::enQueueBlock(const void * memPtr, int blockSize) {
+	if (blockSize < 0 || blockSize > this->capacity - this->size) return false;
+	const uint8_t* source = (const uint8_t*)memPtr;
+	int remaining = blockSize;
+	while (remaining > 0) {
+		if (this->tailChunk == NULL) {
+			this->headChunk = this->tailChunk = this->newChunk();
+			this->headOffset = this->tailOffset = 0;
+		}
+		else if (this->tailOffset == this->chunkSize) {
+			//Link a new chunk, nothing already queued moves
+			Chunk* chunk = this->newChunk();
+			this->tailChunk->next = chunk;
+			this->tailChunk = chunk;
+			this->tailOffset = 0;
+		}
+		int step = this->chunkSize - this->tailOffset < remaining ? this->chunkSize - this->tailOffset : remaining;
+		memcpy((void*)(this->tailChunk->data() + this->tailOffset), (const void*)source, step);
+		this->tailOffset += step;
+		source += step;
+		remaining -= step;
+	}
+	this->size += blockSize;
+	return true;
+}
+
+bool LinkedQueueBuffer::peekBlock(void * memPtr, int blockSize) {
+	if (blockSize < 0 || blockSize > this->size) return false;
+	this->copyOut(0, memPtr, blockSize);
+	return true;
+}
+
+bool LinkedQueueBuffer::deQueueBlock(void * memPtr, int blockSize) {
+	if (!this->peekBlock(memPtr, blockSize)) return false;
+	int remaining = blockSize;
+	while (remaining > 0) {
+		int available = (this->headChunk == this->tailChunk ? this->tailOffset : this->chunkSize) - this->headOffset;
+		int step = available < remaining ? available : remaining;
+		this->headOffset += step;
+		remaining -= step;
+		if (this->headOffset == this->chunkSize && this->headChunk != this->tailChunk) {
+			Chunk* drained = this->headChunk;
+			this->headChunk = drained->next;
+			this->headOffset = 0;
+			this->recycleChunk(drained);
+		}
+	}
+	this->size -= blockSize;
+	//An empty queue restarts at the beginning of its last chunk
+	if (this->size == 0) this->headOffset = this->tailOffset = 0;
+	return true;
+}
+//Endsection: LinkedQueueBuffer implementation
+#pragma endregion LinkedQueueBuffer implementation
@@ -0,0 +1,204 @@
+//Buffer library by Huynh Hoang Kha
+//This implement an unbounded queue buffer over a linked list of fixed-size chunks
+#pragma once
+#ifndef _LINKED_QUEUE_BUFFER_H_
+#define _LINKED_QUEUE_BUFFER_H_
+#include <climits>
+#include "Buffer.h"
+
+#define LINKED_QUEUE_CHUNK_SIZE 4096		//Default number of bytes per chunk
+#define LINKED_QUEUE_FREE_CHUNKS 4			//Default number of drained chunks kept for reuse
+
+#pragma region LinkedQueueBuffer
+/*
+Growing only links a new chunk at the tail, existing data is never copied or moved. Values may straddle
+chunk boundaries. Drained chunks go to a small free list and anything beyond it is freed, so the memory
+held follows the live backlog. The offset-based Buffer methods (getInt, operator[], write...) address
+the queue content from its first-joined byte and walk the chain to reach the offset.
+*/
+class LinkedQueueBuffer :public Buffer, public Queue<uint8_t> {
+	struct Chunk {
+		Chunk* next;
+		uint8_t* data() { return (uint8_t*)(this + 1); };	//The chunk's bytes follow its header in the same allocation
+	};
+	Chunk* headChunk;			//Chunk holding the first-joined byte
+	int headOffset;				//Index of the first-joined byte in headChunk
+	Chunk* tailChunk;			//Chunk receiving the next enqueued byte
+	int tailOffset;				//Index of the next enqueued byte in tailChunk
+	Chunk* freeChunks;			//Drained chunks kept for reuse
+	int freeChunkCount;
+	int maxFreeChunks;
+	int chunkSize;
+	int liveChunks;
+	Chunk* newChunk();
+	void recycleChunk(Chunk* chunk);
+	bool locate(int offset, Chunk** chunk, int* index);			//Find the chunk and index of the byte at 'offset' from the head
+	void copyOut(int offset, void* memPtr, int blockSize);		//Copy content bytes, the range must be valid
+	void copyIn(int offset, const void* memPtr, int blockSize);	//Overwrite content bytes, the range must be valid
+	template <typename T> T getPrimityOrThrow(int offset);		//Shared body of the throwing getInt/getFloat/getLong/getDouble
+public:
+	//Construct an empty queue, 'capacity' limits the number of bytes it may hold (INT_MAX: unbounded)
+	LinkedQueueBuffer(Endian systemEndian, int chunkSize = LINKED_QUEUE_CHUNK_SIZE, int capacity = INT_MAX, int maxFreeChunks = LINKED_QUEUE_FREE_CHUNKS);
+	//Destructor: Unallocate all memory.
+	~LinkedQueueBuffer();
+	LinkedQueueBuffer(const LinkedQueueBuffer&) = delete;
+	LinkedQueueBuffer& operator=(const LinkedQueueBuffer&) = delete;
+	int getChunkSize() { return this->chunkSize; };
+	int getAllocatedBytes() { return (this->liveChunks + this->freeChunkCount) * this->chunkSize; };	//Return the bytes held in chunks, live and free
+	void clean();											//Clean the buffer's content
+	//Methods that will throw exception when error occur (in the case of invalid index/offset)
+	uint8_t& operator[](int index);							//Return reference to the byte at index
+	string getString();										//Return the whole data as std::string object
+	int getInt(int offset);									//Return an 4-byte integer starting from the offset index byte
+	float getFloat(int offset);								//Return an 4-byte float starting from the offset index byte
+	long getLong(int offset);								//Return an 8-byte long starting from the offset index byte
+	double getDouble(int offset);							//Return an 8-byte double starting from the offset index byte
+	//Methods that return false when error occur (in the case of invalid index/offset), output value via a pointer
+	bool getInt(int offset, int* outputInt) { return this->getPrimity(offset, outputInt); };
+	bool getFloat(int offset, float* outputFloat) { return this->getPrimity(offset, outputFloat); };
+	bool getLong(int offset, long* outputLong) { return this->getPrimity(offset, outputLong); };
+	bool getDouble(int offset, double* outputDouble) { return this->getPrimity(offset, outputDouble); };
+	bool getMemoryBlock(void* memPtr, int offset, int size);	//Copy 'size' bytes from buffer into a memory block pointed by memPtr
+	//Write methods overwrite bytes already in the queue, they can not append
+	bool writeInt(int offset, int data) { return this->writePrimity(offset, data); };
+	bool writeFloat(int offset, float data) { return this->writePrimity(offset, data); };
+	bool writeLong(int offset, long data) { return this->writePrimity(offset, data); };
+	bool writeDouble(int offset, double data) { return this->writePrimity(offset, data); };
+	template <typename T> bool writePrimity(int offset, T data);		//write any primitive object into buffer at 'offset' position
+	template <typename T> bool getPrimity(int offset, T* outputObject);	//Get any primitive object, return result via an object pointer
+	//Methods that never throw, the error comes back as the code of the result (see BufferResult)
+	template <typename T> BufferResult<T> tryGetPrimity(int offset) noexcept;
+	BufferResult<int> tryGetInt(int offset) noexcept { return this->tryGetPrimity<int>(offset); };
+	BufferResult<float> tryGetFloat(int offset) noexcept { return this->tryGetPrimity<float>(offset); };
+	BufferResult<long> tryGetLong(int offset) noexcept { return this->tryGetPrimity<long>(offset); };
+	BufferResult<double> tryGetDouble(int offset) noexcept { return this->tryGetPrimity<double>(offset); };
+	//Block methods
+	bool enQueueBlock(const void* memPtr, int blockSize);	//Copy 'blockSize' bytes from memPtr to the end of the queue, return false if the capacity would be exceeded
+	bool deQueueBlock(void* memPtr, int blockSize);			//Move the 'blockSize' first-joined bytes out of the queue into memPtr, return false if there is not enough data
+	bool peekBlock(void* memPtr, int blockSize);			//Copy the 'blockSize' first-joined bytes into memPtr without removing them from the queue
+	//Templates for all queue's methods
+	template <typename T> bool enQueue(T input);
+	template <typename T> bool deQueue(T* output);
+	template <typename T> BufferResult<T> tryDeQueue() noexcept;	//Never throw, the error comes back as the code of the result (see BufferResult)
+	//Methods must be implemented to complete the Queue<uint8_t> interface
+	bool enQueue(uint8_t dataIn) { return this->enQueue<uint8_t>(dataIn); };			//Push a byte to the queue, return true if insertion was OK
+	bool deQueue(uint8_t* dataOut) { return this->deQueue<uint8_t>(dataOut); };		//Return the first-joined byte in the queue and then remove it from the queue
+	//Queue methods for char
+	bool enQueueChar(char dataIn) { return this->enQueue(dataIn); };		//Push a char to the queue, return true if insertion was OK
+	bool deQueueChar(char* dataOut) { return this->deQueue(dataOut); };		//Return the first-joined char in the queue and then remove it from the queue
+	BufferResult<char> tryDeQueueChar() noexcept { return this->tryDeQueue<char>(); };
+	//Queue methods for int
+	bool enQueueInt(int dataIn) { return this->enQueue(dataIn); };			//Push an int to the queue, return true if insertion was OK
+	bool deQueueInt(int* dataOut) { return this->deQueue(dataOut); };		//Return the first-joined int in the queue and then remove it from the queue
+	BufferResult<int> tryDeQueueInt() noexcept { return this->tryDeQueue<int>(); };
+	//Queue methods for float
+	bool enQueueFloat(float dataIn) { return this->enQueue(dataIn); };		//Push a float to the queue, return true if insertion was OK
+	bool deQueueFloat(float* dataOut) { return this->deQueue(dataOut); };	//Return the first-joined float in the queue and then remove it from the queue
+	BufferResult<float> tryDeQueueFloat() noexcept { return this->tryDeQueue<float>(); };
+	//Queue methods for long
+	bool enQueueLong(long dataIn) { return this->enQueue(dataIn); };		//Push a long to the queue, return true if insertion was OK
+	bool deQueueLong(long* dataOut) { return this->deQueue(dataOut); };		//Return the first-joined long in the queue and then remove it from the queue
+	BufferResult<long> tryDeQueueLong() noexcept { return this->tryDeQueue<long>(); };
+	//Queue methods for double
+	bool enQueueDouble(double dataIn) { return this->enQueue(dataIn); };	//Push a double to the queue, return true if insertion was OK
+	bool deQueueDouble(double* dataOut) { return this->deQueue(dataOut); };	//Return the first-joined double in the queue and then remove it from the queue
+	BufferResult<double> tryDeQueueDouble() noexcept { return this->tryDeQueue<double>(); };
+};
+#pragma endregion LinkedQueueBuffer
+
+#pragma region LinkedQueueBuffer templates
+template<typename T>
+inline bool LinkedQueueBuffer::writePrimity(int offset, T data) {
+	if (offset < 0 || offset + sizeof(T) > this->size) return false;
+	uint8_t bytes[sizeof(T)];
+	if (!encodePrimity(bytes, data, this->endian)) {
+		BufferException bE(NOT_SET_ENDIAN);
+		throw bE;
+	}
+	this->copyIn(offset, bytes, sizeof(T));
+	return true;
+}
+
+template<typename T>
+inline bool LinkedQueueBuffer::getPrimity(int offset, T * outputObject) {
+	if (offset < 0 || offset + sizeof(T) > this->size) return false;
+	uint8_t bytes[sizeof(T)];
+	this->copyOut(offset, bytes, sizeof(T));
+	return decodePrimity(bytes, outputObject, this->endian);
+}
+
+template<typename T>
+inline bool LinkedQueueBuffer::enQueue(T dataIn) {
+	if (this->tailChunk != NULL && this->chunkSize - this->tailOffset >= sizeof(T) && this->capacity - this->size >= sizeof(T)) {
+		//Fast path: the value fits in the tail chunk
+		if (!encodePrimity(this->tailChunk->data() + this->tailOffset, dataIn, this->endian)) return false;
+		this->tailOffset += sizeof(T);
+		this->size += sizeof(T);
+		return true;
+	}
+	uint8_t bytes[sizeof(T)];
+	if (!encodePrimity(bytes, dataIn, this->endian)) return false;
+	return this->enQueueBlock(bytes, sizeof(T));
+}
+
+template<typename T>
+inline bool LinkedQueueBuffer::deQueue(T* dataOut) {
+	if (this->size < sizeof(T)) return false;
+	if (this->chunkSize - this->headOffset > sizeof(T)) {
+		//Fast path: the value lies inside the head chunk and does not drain it
+		if (!decodePrimity(this->headChunk->data() + this->headOffset, dataOut, this->endian)) return false;
+		this->headOffset += sizeof(T);
+		this->size -= sizeof(T);
+		return true;
+	}
+	uint8_t bytes[sizeof(T)];
+	if (!this->peekBlock(bytes, sizeof(T)) || !decodePrimity(bytes, dataOut, this->endian)) return false;
+	return this->deQueueBlock(bytes, sizeof(T));
+}
+template<typename T>
+inline BufferResult<T> LinkedQueueBuffer::tryGetPrimity(int offset) noexcept {
+	BufferResult<T> result;
+	result.value = 0;
+#ifndef BUFFER_COMPILE_TIME_ENDIAN
+	if (this->endian == NOT_SET) result.code = NOT_SET_ENDIAN;
+	else
+#endif
+	if (offset < 0) result.code = NEGATIVE_INDEX;
+	else if (!this->getPrimity(offset, &result.value)) result.code = OUT_OF_RANGE_INDEX;
+	else result.code = NO_EXCEPTION;
+	return result;
+}
+
+template<typename T>
+inline T LinkedQueueBuffer::getPrimityOrThrow(int offset) {
+	T data = 0;
+#ifndef BUFFER_COMPILE_TIME_ENDIAN
+	if (this->endian == NOT_SET) {
+		BufferException bE(NOT_SET_ENDIAN);
+		throw bE;
+	}
+#endif
+	if (offset < 0) {
+		BufferException bE(NEGATIVE_INDEX);
+		throw bE;
+	}
+	if (!this->getPrimity(offset, &data)) {
+		BufferException bE(OUT_OF_RANGE_INDEX);
+		throw bE;
+	}
+	return data;
+}
+
+template<typename T>
+inline BufferResult<T> LinkedQueueBuffer::tryDeQueue() noexcept {
+	BufferResult<T> result;
+	result.value = 0;
+	if (this->deQueue(&result.value)) result.code = NO_EXCEPTION;
+#ifndef BUFFER_COMPILE_TIME_ENDIAN
+	else if (this->endian == NOT_SET) result.code = NOT_SET_ENDIAN;
+#endif
+	else result.code = NOT_ENOUGH_DATA_TO_DEQUEUE;
+	return result;
+}
+#pragma endregion LinkedQueueBuffer templates
+#endif // !_LINKED_QUEUE_BUFFER_H_
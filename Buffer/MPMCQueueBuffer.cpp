@@ -0,0 +1,121 @@
+//Buffer library by Huynh Hoang Kha
+//This implement a bounded multi-producer/multi-consumer queue buffer
+#include "MPMCQueueBuffer.h"
+
+#pragma region MPMCQueueArrayBuffer implementation
+//------------------------------------------------------------------------------------------------------------
+//Section: MPMCQueueArrayBuffer implementation
+MPMCQueueArrayBuffer::MPMCQueueArrayBuffer(int capacity, Endian systemEndian) {
+	if (capacity < 0) {
+		BufferException bE(NEGATIVE_CAPACITY);
+		throw bE;
+	}
+	if (capacity > MPMC_MAX_CAPACITY) {
+		BufferException bE(CAPACITY_TOO_LARGE);
+		throw bE;
+	}
+	int slotCount = 1;
+	while (slotCount < capacity) slotCount <<= 1;
+	this->capacity = slotCount;
+	this->slotMask = slotCount - 1;
+	this->endian = systemEndian;
+	this->slots = NULL;
+	while (this->slots == NULL) this->slots = new Slot[slotCount];
+	for (int i = 0; i < slotCount; i++) {
+		this->slots[i].sequence.store(i, memory_order_relaxed);
+		this->slots[i].length.store(0, memory_order_relaxed);
+	}
+	this->enqueuePosition.store(0, memory_order_relaxed);
+	this->dequeuePosition.store(0, memory_order_relaxed);
+}
+
+MPMCQueueArrayBuffer::~MPMCQueueArrayBuffer() {
+	if (this->slots != NULL) {
+		delete[] this->slots;
+		this->slots = NULL;
+	}
+}
+
+int MPMCQueueArrayBuffer::getSize() {
+	size_t dequeued = this->dequeuePosition.load(memory_order_acquire);
+	size_t enqueued = this->enqueuePosition.load(memory_order_acquire);
+	return enqueued > dequeued ? (int)(enqueued - dequeued) : 0;
+}
+
+bool MPMCQueueArrayBuffer::enQueueBlock(const void * memPtr, int blockSize) {
+	if (blockSize <= 0 || blockSize > MPMC_SLOT_PAYLOAD) return false;
+	Slot* slot;
+	size_t position = this->enqueuePosition.load(memory_order_relaxed);
+	for (;;) {
+		slot = &this->slots[position & this->slotMask];
+		size_t sequence = slot->sequence.load(memory_order_acquire);
+		intptr_t difference = (intptr_t)sequence - (intptr_t)position;
+		if (difference == 0) {
+			//The slot is free for this position: try to reserve it
+			if (this->enqueuePosition.compare_exchange_weak(position, position + 1, memory_order_relaxed)) break;
+		}
+		else if (difference < 0) return false;	//The slot still holds the value from the previous lap: the queue is full
+		else position = this->enqueuePosition.load(memory_order_relaxed);	//Another producer took this position
+	}
+	memcpy(slot->data, memPtr, blockSize);
+	slot->length.store((uint8_t)blockSize, memory_order_relaxed);
+	slot->sequence.store(position + 1, memory_order_release);
+	return true;
+}
+
+bool MPMCQueueArrayBuffer::deQueueBlock(void * memPtr, int blockSize) {
+	if (blockSize <= 0 || blockSize > MPMC_SLOT_PAYLOAD) return false;
+	Slot* slot;
+	size_t position = this->dequeuePosition.load(memory_order_relaxed);
+	for (;;) {
+		slot = &this->slots[position & this->slotMask];
+		size_t sequence = slot->sequence.load(memory_order_acquire);
+		intptr_t difference = (intptr_t)sequence - (intptr_t)(position + 1);
+		if (difference == 0) {
+			//Refuse a value of another size before claiming it, so it stays available for the right consumer
+			if (slot->length.load(memory_order_relaxed) != blockSize) return false;
+			if (this->dequeuePosition.compare_exchange_weak(position, position + 1, memory_order_relaxed)) break;
+		}
+		else if (difference < 0) return false;	//No producer has published this position yet: the queue is empty
+		else position = this->dequeuePosition.load(memory_order_relaxed);	//Another consumer took this position
+	}
+	memcpy(memPtr, slot->data, blockSize);
+	slot->sequence.store(position + this->slotMask + 1, memory_order_release);
+	return true;
+}
+
+int MPMCQueueArrayBuffer::peekLength() {
+	size_t position = this->dequeuePosition.load(memory_order_relaxed);
+	for (;;) {
+		Slot* slot = &this->slots[position & this->slotMask];
+		size_t sequence = slot->sequence.load(memory_order_acquire);
+		intptr_t difference = (intptr_t)sequence - (intptr_t)(position + 1);
+		if (difference == 0) {
+			int length = slot->length.load(memory_order_relaxed);
+			//The slot may have been taken and refilled while its length was read: only trust it if it still holds this position
+			atomic_thread_fence(memory_order_acquire);
+			if (slot->sequence.load(memory_order_relaxed) == sequence) return length;
+		}
+		else if (difference < 0) return -1;
+		position = this->dequeuePosition.load(memory_order_relaxed);
+	}
+}
+
+bool MPMCQueueArrayBuffer::discardFirst() {
+	Slot* slot;
+	size_t position = this->dequeuePosition.load(memory_order_relaxed);
+	for (;;) {
+		slot = &this->slots[position & this->slotMask];
+		size_t sequence = slot->sequence.load(memory_order_acquire);
+		intptr_t difference = (intptr_t)sequence - (intptr_t)(position + 1);
+		if (difference == 0) {
+			if (this->dequeuePosition.compare_exchange_weak(position, position + 1, memory_order_relaxed)) break;
+		}
+		else if (difference < 0) return false;
+		else position = this->dequeuePosition.load(memory_order_relaxed);
+	}
+	slot->sequence.store(position + this->slotMask + 1, memory_order_release);
+	return true;
+}
+//Endsection: MPMCQueueArrayBuffer implementation
+#pragma endregion MPMCQueueArrayBuffer implementation
@@ -0,0 +1,112 @@
+//Buffer library by Huynh Hoang Kha
+//This implement a bounded multi-producer/multi-consumer queue buffer
+//Based on per-slot sequence numbers (Dmitry Vyukov's bounded MPMC queue)
+#pragma once
+#ifndef _MPMC_QUEUE_BUFFER_H_
+#define _MPMC_QUEUE_BUFFER_H_
+#include <atomic>
+#include "Buffer.h"
+#include "CacheAligned.h"
+
+#define MPMC_SLOT_PAYLOAD 8		//Biggest value a slot can hold, enough for every primitive (long, double)
+#define MPMC_MAX_CAPACITY (1 << 30)	//Largest power of two an int can hold, the biggest capacity the constructor accepts
+
+#pragma region MPMCQueueArrayBuffer
+/*
+Every enQueue call reserves one whole slot, so the bytes of a multi-byte value never interleave with
+the bytes of another producer's value. A deQueue call takes one whole value back and fails without
+removing anything when the first-joined value does not have the requested size. Such a value stays at the head and
+blocks every consumer until one of them takes it with the right size: mix value sizes only when the consumers can
+tell them apart, with peekLength() before deQueue, and use discardFirst() to drop a value nobody can take.
+*/
+class MPMCQueueArrayBuffer :public Queue<uint8_t>, public CacheAligned {
+	struct Slot {
+		atomic<size_t> sequence;			//Slot is writable for position p when sequence == p, readable when sequence == p + 1
+		atomic<uint8_t> length;				//Number of bytes stored in data
+		uint8_t data[MPMC_SLOT_PAYLOAD];
+	};
+	Slot* slots;
+	size_t slotMask;
+	int capacity;
+	Endian endian;
+	alignas(BUFFER_CACHE_LINE_SIZE) atomic<size_t> enqueuePosition;
+	alignas(BUFFER_CACHE_LINE_SIZE) atomic<size_t> dequeuePosition;
+public:
+	//Construct this MPMCQueueArrayBuffer to hold 'capacity' values, rounded up to a power of two, at most MPMC_MAX_CAPACITY
+	MPMCQueueArrayBuffer(int capacity, Endian systemEndian);
+	//Destructor: Unallocate all memory.
+	~MPMCQueueArrayBuffer();
+	MPMCQueueArrayBuffer(const MPMCQueueArrayBuffer&) = delete;
+	MPMCQueueArrayBuffer& operator=(const MPMCQueueArrayBuffer&) = delete;
+	int getCapacity() { return this->capacity; };	//Return the number of values the queue can hold
+	int getSize();									//Return the number of values stored in the queue, a snapshot only while other threads are running
+	bool isEmpty() { return this->getSize() == 0; };
+	bool isFull() { return this->getSize() == this->capacity; };
+	//Block methods, 'blockSize' must be in the range [1, MPMC_SLOT_PAYLOAD]
+	bool enQueueBlock(const void* memPtr, int blockSize);	//Store 'blockSize' bytes from memPtr as one value, return false if the queue is full
+	bool deQueueBlock(void* memPtr, int blockSize);			//Move the first-joined value into memPtr, return false if the queue is empty or the value is not 'blockSize' bytes long
+	int peekLength();										//Return the size in bytes of the first-joined value, -1 if the queue is empty. Another consumer may take it right after
+	bool discardFirst();									//Remove the first-joined value whatever its size, return false if the queue is empty
+	//Templates for all queue's methods
+	template <typename T> bool enQueue(T input);
+	template <typename T> bool deQueue(T* output);
+	template <typename T> BufferResult<T> tryDeQueue() noexcept;	//Never throw, the error comes back as the code of the result (see BufferResult)
+	//Methods must be implemented to complete the Queue<uint8_t> interface
+	bool enQueue(uint8_t dataIn) { return this->enQueue<uint8_t>(dataIn); };			//Push a byte to the queue, return true if insertion was OK
+	bool deQueue(uint8_t* dataOut) { return this->deQueue<uint8_t>(dataOut); };		//Return the first-joined byte in the queue and then remove it from the queue
+	//Queue methods for char
+	bool enQueueChar(char dataIn) { return this->enQueue(dataIn); };		//Push a char to the queue, return true if insertion was OK
+	bool deQueueChar(char* dataOut) { return this->deQueue(dataOut); };		//Return the first-joined char in the queue and then remove it from the queue
+	BufferResult<char> tryDeQueueChar() noexcept { return this->tryDeQueue<char>(); };
+	//Queue methods for int
+	bool enQueueInt(int dataIn) { return this->enQueue(dataIn); };			//Push an int to the queue, return true if insertion was OK
+	bool deQueueInt(int* dataOut) { return this->deQueue(dataOut); };		//Return the first-joined int in the queue and then remove it from the queue
+	BufferResult<int> tryDeQueueInt() noexcept { return this->tryDeQueue<int>(); };
+	//Queue methods for float
+	bool enQueueFloat(float dataIn) { return this->enQueue(dataIn); };		//Push a float to the queue, return true if insertion was OK
+	bool deQueueFloat(float* dataOut) { return this->deQueue(dataOut); };	//Return the first-joined float in the queue and then remove it from the queue
+	BufferResult<float> tryDeQueueFloat() noexcept { return this->tryDeQueue<float>(); };
+	//Queue methods for long
+	bool enQueueLong(long dataIn) { return this->enQueue(dataIn); };		//Push a long to the queue, return true if insertion was OK
+	bool deQueueLong(long* dataOut) { return this->deQueue(dataOut); };		//Return the first-joined long in the queue and then remove it from the queue
+	BufferResult<long> tryDeQueueLong() noexcept { return this->tryDeQueue<long>(); };
+	//Queue methods for double
+	bool enQueueDouble(double dataIn) { return this->enQueue(dataIn); };	//Push a double to the queue, return true if insertion was OK
+	bool deQueueDouble(double* dataOut) { return this->deQueue(dataOut); };	//Return the first-joined double in the queue and then remove it from the queue
+	BufferResult<double> tryDeQueueDouble() noexcept { return this->tryDeQueue<double>(); };
+};
+#pragma endregion MPMCQueueArrayBuffer
+
+#pragma region MPMCQueueArrayBuffer templates
+template<typename T>
+inline bool MPMCQueueArrayBuffer::enQueue(T dataIn) {
+	static_assert(sizeof(T) <= MPMC_SLOT_PAYLOAD, "Value is too big for an MPMCQueueArrayBuffer slot");
+	uint8_t bytes[sizeof(T)];
+	if (!encodePrimity(bytes, dataIn, this->endian)) return false;
+	return this->enQueueBlock(bytes, sizeof(T));
+}
+
+template<typename T>
+inline bool MPMCQueueArrayBuffer::deQueue(T* dataOut) {
+	static_assert(sizeof(T) <= MPMC_SLOT_PAYLOAD, "Value is too big for an MPMCQueueArrayBuffer slot");
+#ifndef BUFFER_COMPILE_TIME_ENDIAN
+	if (this->endian == NOT_SET) return false;
+#endif
+	uint8_t bytes[sizeof(T)];
+	if (!this->deQueueBlock(bytes, sizeof(T))) return false;
+	return decodePrimity(bytes, dataOut, this->endian);
+}
+
+template<typename T>
+inline BufferResult<T> MPMCQueueArrayBuffer::tryDeQueue() noexcept {
+	BufferResult<T> result;
+	result.value = 0;
+	if (this->deQueue(&result.value)) result.code = NO_EXCEPTION;
+#ifndef BUFFER_COMPILE_TIME_ENDIAN
+	else if (this->endian == NOT_SET) result.code = NOT_SET_ENDIAN;
+#endif
+	else result.code = NOT_ENOUGH_DATA_TO_DEQUEUE;
+	return result;
+}
+#pragma endregion MPMCQueueArrayBuffer templates
+#endif // !_MPMC_QUEUE_BUFFER_H_
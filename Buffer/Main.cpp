@@ -23,9 +23,11 @@ int main() {
 
 
 	}
-	catch (BufferException bE) {
+	catch (BufferException& bE) {
 		cout << bE.getMessage() << endl;
 	}
+#ifdef _WIN32
 	system("pause");
+#endif
 	return 0;
 }
\ No newline at end of file
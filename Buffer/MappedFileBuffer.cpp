@@ -0,0 +1,99 @@
+//Buffer library by Huynh Hoang Kha
+//This implement an ArrayBuffer backed by a memory-mapped file (POSIX systems)
+#include "MappedFileBuffer.h"
+#ifdef BUFFER_HAS_MMAP
+#include <climits>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#pragma region MappedFileBuffer implementation
+//------------------------------------------------------------------------------------------------------------
+//Section: MappedFileBuffer implementation
+MappedFileBuffer::MappedFileBuffer(const char * path, FileMappingMode mappingMode, Endian systemEndian, bool populate, long long fileOffset, int length)
+: ArrayBuffer(NULL, 0, 0, systemEndian, BORROW_MEMORY) {
+	this->mappingMode = mappingMode;
+	this->populate = populate;
+	this->mapBase = NULL;
+	this->mapLength = 0;
+	this->readOnly = mappingMode == READ_ONLY_MAPPING;
+	this->fileDescriptor = open(path, mappingMode == SHARED_WRITABLE_MAPPING ? O_RDWR : O_RDONLY);
+	if (this->fileDescriptor < 0) {
+		BufferException bE(FILE_OPEN_FAILED);
+		throw bE;
+	}
+	if (length < 0) {
+		long long available = this->getFileSize() - fileOffset;
+		if (available > INT_MAX) {
+			close(this->fileDescriptor);
+			BufferException bE(FILE_TOO_LARGE);
+			throw bE;
+		}
+		length = available > 0 ? (int)available : 0;
+	}
+	if (!this->remap(fileOffset, length)) {
+		close(this->fileDescriptor);
+		BufferException bE(FILE_MAP_FAILED);
+		throw bE;
+	}
+}
+
+MappedFileBuffer::~MappedFileBuffer() {
+	this->unmap();
+	if (this->fileDescriptor >= 0) close(this->fileDescriptor);
+}
+
+void MappedFileBuffer::unmap() {
+	if (this->mapBase != NULL) munmap(this->mapBase, this->mapLength);
+	this->mapBase = NULL;
+	this->mapLength = 0;
+	this->arrayPointer = NULL;
+	this->capacity = this->size = this->blockCapacity = 0;
+}
+
+bool MappedFileBuffer::remap(long long fileOffset, int length) {
+	if (fileOffset < 0 || length < 0 || fileOffset + length > this->getFileSize()) return false;
+	this->unmap();
+	if (length == 0) return true;
+	//mmap needs a page-aligned file offset: map from the page start and skip the leading bytes
+	long long pageSize = sysconf(_SC_PAGESIZE);
+	long long alignedOffset = fileOffset - fileOffset % pageSize;
+	size_t mapLength = (size_t)(fileOffset - alignedOffset) + length;
+	//A private writable mapping would be pre-faulted for write by MAP_POPULATE, copying every page: read-only maps are PROT_READ only
+	int flags = (this->mappingMode == SHARED_WRITABLE_MAPPING) ? MAP_SHARED : MAP_PRIVATE;
+	int protection = (this->mappingMode == SHARED_WRITABLE_MAPPING) ? PROT_READ | PROT_WRITE : PROT_READ;
+#ifdef MAP_POPULATE
+	if (this->populate) flags |= MAP_POPULATE;
+#endif
+	void* base = mmap(NULL, mapLength, protection, flags, this->fileDescriptor, (off_t)alignedOffset);
+	if (base == MAP_FAILED) return false;
+	this->mapBase = base;
+	this->mapLength = mapLength;
+	this->arrayPointer = (uint8_t*)base + (fileOffset - alignedOffset);
+	this->capacity = this->size = this->blockCapacity = length;
+	return true;
+}
+
+bool MappedFileBuffer::advise(AccessPattern accessPattern) {
+	if (this->mapBase == NULL) return true;
+	int advice = MADV_NORMAL;
+	if (accessPattern == SEQUENTIAL_ACCESS) advice = MADV_SEQUENTIAL;
+	else if (accessPattern == RANDOM_ACCESS) advice = MADV_RANDOM;
+	else if (accessPattern == WILL_NEED_ACCESS) advice = MADV_WILLNEED;
+	return madvise(this->mapBase, this->mapLength, advice) == 0;
+}
+
+bool MappedFileBuffer::sync(bool waitForCompletion) {
+	if (this->mapBase == NULL || this->mappingMode != SHARED_WRITABLE_MAPPING) return true;
+	return msync(this->mapBase, this->mapLength, waitForCompletion ? MS_SYNC : MS_ASYNC) == 0;
+}
+
+long long MappedFileBuffer::getFileSize() {
+	struct stat fileStatus;
+	if (fstat(this->fileDescriptor, &fileStatus) != 0) return -1;
+	return (long long)fileStatus.st_size;
+}
+//Endsection: MappedFileBuffer implementation
+#pragma endregion MappedFileBuffer implementation
+#endif
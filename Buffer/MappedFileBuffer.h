@@ -0,0 +1,55 @@
+//Buffer library by Huynh Hoang Kha
+//This implement an ArrayBuffer backed by a memory-mapped file (POSIX systems)
+#pragma once
+#ifndef _MAPPED_FILE_BUFFER_H_
+#define _MAPPED_FILE_BUFFER_H_
+#include "Buffer.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#define BUFFER_HAS_MMAP
+
+enum FileMappingMode {
+	READ_ONLY_MAPPING,			//Mapped without write access: the write methods return false, clean() throws READ_ONLY_BUFFER
+	SHARED_WRITABLE_MAPPING		//Shared mapping: writes through the buffer go to the file (see sync)
+};
+
+enum AccessPattern {
+	NORMAL_ACCESS,
+	SEQUENTIAL_ACCESS,			//Aggressive read-ahead, pages behind the reader can be dropped early
+	RANDOM_ACCESS,				//No read-ahead
+	WILL_NEED_ACCESS			//Start reading the whole window in now
+};
+
+/*
+The file content is the buffer content: size and capacity are both the length of the mapped window, and the
+typed accessors (getInt, getLong, getDouble, writePrimity...) work directly on the page cache.
+A READ_ONLY_MAPPING shares the page cache pages and never copies them, even with populate: storing through
+operator[] or getData() on it faults (SIGSEGV), use the write methods, which check isReadOnly().
+The capacity is an int, so files bigger than 2 GB are processed through windows (fileOffset/length), remap()
+moves the window along the file.
+*/
+class MappedFileBuffer :public ArrayBuffer {
+	int fileDescriptor;
+	void* mapBase;				//Page-aligned start of the mapping, arrayPointer may point a few bytes after it
+	size_t mapLength;
+	FileMappingMode mappingMode;
+	bool populate;
+	void unmap();
+public:
+	//Map 'length' bytes of the file starting at 'fileOffset' (length -1: up to the end of the file).
+	//With populate the pages are read in up front (MAP_POPULATE) instead of on first access.
+	MappedFileBuffer(const char* path, FileMappingMode mappingMode, Endian systemEndian, bool populate = false, long long fileOffset = 0, int length = -1);
+	//Destructor: unmap the file and close it
+	~MappedFileBuffer();
+	MappedFileBuffer(const MappedFileBuffer&) = delete;
+	MappedFileBuffer& operator=(const MappedFileBuffer&) = delete;
+	bool remap(long long fileOffset, int length);	//Move the window to another part of the file, return false if it can not be mapped
+	bool advise(AccessPattern accessPattern);		//Pass an access pattern hint to the kernel (madvise)
+	bool sync(bool waitForCompletion = true);		//Flush the writes of a SHARED_WRITABLE_MAPPING to the file (msync)
+	long long getFileSize();						//Return the size of the whole file
+	//The mapping can not be resized through the buffer
+	bool reserve(int newCapacity) { return newCapacity <= this->capacity; };
+	bool shrinkToFit() { return this->size == this->capacity; };
+};
+#endif
+#endif // !_MAPPED_FILE_BUFFER_H_
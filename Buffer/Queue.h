@@ -5,6 +5,7 @@
 template <class T>
 class Queue {
 public:
+	virtual ~Queue() {};
 	virtual bool deQueue(T* dataPtr) = 0;
 	virtual bool enQueue(T data) = 0;
 };
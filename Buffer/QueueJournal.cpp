@@ -0,0 +1,262 @@
+//Buffer library by Huynh Hoang Kha
+//Write-ahead journal and snapshots that let a QueueArrayBuffer survive a crash (POSIX systems)
+#include "QueueJournal.h"
+#ifdef BUFFER_HAS_JOURNAL
+#include "MappedFileBuffer.h"
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+/*
+File layouts, every number is big endian:
+journal:  "BQJ1" | base position (8) | CRC32C of the previous 12 bytes (4), then one record per commit:
+          data length (4) | consumed position (8) | data | CRC32C of length, position and data (4)
+snapshot: "BQS1" | capacity (4) | size (4) | endian (1) | appended position (8) | data | CRC32C of everything before (4)
+*/
+#define JOURNAL_HEADER_SIZE 16
+#define RECORD_OVERHEAD 16
+#define SNAPSHOT_HEADER_SIZE 21
+
+#pragma region File helpers
+//------------------------------------------------------------------------------------------------------------
+//Section: File helpers
+//writev until everything is written, EINTR is retried
+static bool writeAll(int fileDescriptor, struct iovec* segments, int count) {
+	while (count > 0) {
+		ssize_t result = writev(fileDescriptor, segments, count);
+		if (result < 0) {
+			if (errno == EINTR) continue;
+			return false;
+		}
+		while (count > 0 && (size_t)result >= segments->iov_len) {
+			result -= segments->iov_len;
+			segments++;
+			count--;
+		}
+		if (count > 0) {
+			segments->iov_base = (uint8_t*)segments->iov_base + result;
+			segments->iov_len -= result;
+		}
+	}
+	return true;
+}
+
+static bool syncData(int fileDescriptor) {
+#ifdef __APPLE__
+	return fsync(fileDescriptor) == 0;
+#else
+	return fdatasync(fileDescriptor) == 0;
+#endif
+}
+
+//Make a rename durable
+static bool syncDirectoryOf(const string& path) {
+	size_t slash = path.find_last_of('/');
+	string directory = slash == string::npos ? "." : (slash == 0 ? "/" : path.substr(0, slash));
+	int fileDescriptor = open(directory.c_str(), O_RDONLY);
+	if (fileDescriptor < 0) return false;
+	bool result = fsync(fileDescriptor) == 0;
+	close(fileDescriptor);
+	return result;
+}
+
+static long long fileSize(const string& path) {
+	struct stat fileStatus;
+	if (stat(path.c_str(), &fileStatus) != 0) return -1;
+	return (long long)fileStatus.st_size;
+}
+//Endsection: File helpers
+#pragma endregion File helpers
+
+#pragma region QueueJournal implementation
+//------------------------------------------------------------------------------------------------------------
+//Section: QueueJournal implementation
+QueueJournal::QueueJournal(const char * basePath, int groupCommitBytes)
+: pending(groupCommitBytes > 0 && groupCommitBytes < (1 << 16) ? groupCommitBytes : 1 << 16, HOST_ENDIAN) {
+	this->journalPath = string(basePath) + ".journal";
+	this->snapshotPath = string(basePath) + ".snapshot";
+	this->queue = NULL;
+	this->fileDescriptor = -1;
+	this->appendedPosition = this->committedConsumed = 0;
+	this->journalLength = 0;
+	this->groupCommitBytes = groupCommitBytes;
+	this->pending.setGrowable(true);
+}
+
+QueueJournal::~QueueJournal() {
+	this->detach();
+	if (this->fileDescriptor >= 0) close(this->fileDescriptor);
+}
+
+void QueueJournal::append(const uint8_t * data, int bytes) {
+	this->pending.enQueueBlock(data, bytes);
+	this->appendedPosition += bytes;
+	if (this->groupCommitBytes > 0 && this->pending.getSize() >= this->groupCommitBytes) this->commit();
+}
+
+bool QueueJournal::commit() {
+	if (this->fileDescriptor < 0 || this->queue == NULL) return false;
+	long long consumed = this->getConsumedPosition();
+	int dataLength = this->pending.getSize();
+	if (dataLength == 0 && consumed == this->committedConsumed) return true;
+	uint8_t header[12], trailer[4];
+	encodeRecord(header, HOST_ENDIAN, (uint32_t)dataLength, (int64_t)consumed);
+	BufferSegments data = this->pending.getSegments();
+	encodeRecord(trailer, HOST_ENDIAN, crc32c(data, crc32c(header, sizeof(header))));
+	struct iovec segments[4] = {
+		{ header, sizeof(header) },
+		{ data.first.data, (size_t)data.first.size },
+		{ data.second.data, (size_t)data.second.size },
+		{ trailer, sizeof(trailer) }
+	};
+	if (!writeAll(this->fileDescriptor, segments, 4) || !syncData(this->fileDescriptor)) {
+		//Cut a partly written record off so that the next commit follows the last complete one
+		if (ftruncate(this->fileDescriptor, (off_t)this->journalLength) != 0) {}
+		return false;
+	}
+	this->journalLength += RECORD_OVERHEAD + dataLength;
+	this->pending.discard(dataLength);
+	this->committedConsumed = consumed;
+	return true;
+}
+
+bool QueueJournal::restartJournal(long long basePosition) {
+	uint8_t header[JOURNAL_HEADER_SIZE];
+	memcpy(header, "BQJ1", 4);
+	encodeRecord(header + 4, HOST_ENDIAN, (int64_t)basePosition);
+	encodeRecord(header + 12, HOST_ENDIAN, crc32c(header, 12));
+	struct iovec segment = { header, sizeof(header) };
+	if (ftruncate(this->fileDescriptor, 0) != 0 || !writeAll(this->fileDescriptor, &segment, 1) || !syncData(this->fileDescriptor)) return false;
+	this->journalLength = JOURNAL_HEADER_SIZE;
+	return true;
+}
+
+bool QueueJournal::snapshot() {
+	if (this->fileDescriptor < 0 || this->queue == NULL) return false;
+	uint8_t header[SNAPSHOT_HEADER_SIZE], trailer[4];
+	memcpy(header, "BQS1", 4);
+	encodeRecord(header + 4, HOST_ENDIAN, (int32_t)this->queue->capacity, (int32_t)this->queue->size, (char)this->queue->endian, (int64_t)this->appendedPosition);
+	BufferSegments data = this->queue->getSegments();
+	encodeRecord(trailer, HOST_ENDIAN, crc32c(data, crc32c(header, sizeof(header))));
+	struct iovec segments[4] = {
+		{ header, sizeof(header) },
+		{ data.first.data, (size_t)data.first.size },
+		{ data.second.data, (size_t)data.second.size },
+		{ trailer, sizeof(trailer) }
+	};
+	//Write a new file and rename it over the old one, a crash leaves either snapshot complete
+	string temporaryPath = this->snapshotPath + ".tmp";
+	int fileDescriptor = open(temporaryPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	if (fileDescriptor < 0) return false;
+	bool written = writeAll(fileDescriptor, segments, 4) && fsync(fileDescriptor) == 0;
+	close(fileDescriptor);
+	if (!written || rename(temporaryPath.c_str(), this->snapshotPath.c_str()) != 0 || !syncDirectoryOf(this->snapshotPath)) {
+		unlink(temporaryPath.c_str());
+		return false;
+	}
+	//Everything pending is in the snapshot. Until the journal is restarted, recovery sees its records as older than the snapshot.
+	this->pending.discard(this->pending.getSize());
+	this->committedConsumed = this->getConsumedPosition();
+	return this->restartJournal(this->appendedPosition);
+}
+
+void QueueJournal::detach() {
+	if (this->queue == NULL) return;
+	this->commit();
+	this->queue->journal = NULL;
+	this->queue = NULL;
+}
+
+bool QueueJournal::recover(QueueArrayBuffer * queue) {
+	this->detach();
+	if (this->fileDescriptor >= 0) close(this->fileDescriptor);
+	this->fileDescriptor = -1;
+	this->pending.discard(this->pending.getSize());
+	long long snapshotAppended = 0;
+	try {
+		//The snapshot gives the content between snapshotConsumed and snapshotAppended
+		if (fileSize(this->snapshotPath) >= 0) {
+			MappedFileBuffer file(this->snapshotPath.c_str(), READ_ONLY_MAPPING, HOST_ENDIAN, true);
+			BufferSpan data = file.getData();
+			if (data.size < SNAPSHOT_HEADER_SIZE + 4 || memcmp(data.data, "BQS1", 4) != 0) return false;
+			int32_t capacity, size;
+			char endian;
+			int64_t appended;
+			uint32_t crc;
+			decodeRecord(data.data + 4, HOST_ENDIAN, &capacity, &size, &endian, &appended);
+			if (capacity < 0 || size < 0 || size > capacity || data.size != SNAPSHOT_HEADER_SIZE + size + 4) return false;
+			decodeRecord(data.data + SNAPSHOT_HEADER_SIZE + size, HOST_ENDIAN, &crc);
+			if (crc != crc32c(data.data, SNAPSHOT_HEADER_SIZE + size)) return false;
+			bool growable = queue->isGrowable(), runningChecksum = queue->hasRunningChecksum();
+			*queue = QueueArrayBuffer(data.data + SNAPSHOT_HEADER_SIZE, capacity, size, (Endian)endian, COPY_MEMORY);
+			queue->setGrowable(growable);
+			queue->setRunningChecksum(runningChecksum);
+			snapshotAppended = appended;
+		}
+		else queue->discard(queue->getSize());
+		long long snapshotConsumed = snapshotAppended - queue->getSize();
+		this->appendedPosition = snapshotAppended;
+		//Then the journal records that are newer than the snapshot, up to the last complete one
+		bool keepJournal = false;
+		if (fileSize(this->journalPath) >= JOURNAL_HEADER_SIZE) {
+			MappedFileBuffer file(this->journalPath.c_str(), READ_ONLY_MAPPING, HOST_ENDIAN, true);
+			BufferSpan data = file.getData();
+			int64_t base;
+			uint32_t crc;
+			decodeRecord(data.data + 4, HOST_ENDIAN, &base, &crc);
+			if (memcmp(data.data, "BQJ1", 4) != 0 || crc != crc32c(data.data, 12)) return false;
+			long long lastAppended = base, lastConsumed = -1;
+			int offset = JOURNAL_HEADER_SIZE;
+			while (data.size - offset >= RECORD_OVERHEAD) {
+				uint32_t length;
+				int64_t consumed;
+				decodeRecord(data.data + offset, HOST_ENDIAN, &length, &consumed);
+				if (length > (uint32_t)(data.size - offset - RECORD_OVERHEAD)) break;
+				decodeRecord(data.data + offset + 12 + length, HOST_ENDIAN, &crc);
+				if (crc != crc32c(data.data + offset, 12 + length)) break;
+				lastAppended += length;
+				lastConsumed = consumed;
+				offset += RECORD_OVERHEAD + length;
+			}
+			this->journalLength = offset;
+			if (lastConsumed >= 0 && lastAppended >= snapshotAppended && lastConsumed >= snapshotConsumed) {
+				//Final content: [lastConsumed, lastAppended), from the snapshot up to snapshotAppended and from the journal after it
+				long long from = lastConsumed > snapshotAppended ? lastConsumed : snapshotAppended;
+				if (base > from) return false;
+				queue->discard((int)((lastConsumed < snapshotAppended ? lastConsumed : snapshotAppended) - snapshotConsumed));
+				long long position = base;
+				for (int recordOffset = JOURNAL_HEADER_SIZE; recordOffset < offset; ) {
+					uint32_t length;
+					decodeRecord(data.data + recordOffset, HOST_ENDIAN, &length);
+					if (position + length > from) {
+						int skip = from > position ? (int)(from - position) : 0;
+						if (!queue->enQueueBlock(data.data + recordOffset + 12 + skip, length - skip)) return false;
+					}
+					position += length;
+					recordOffset += RECORD_OVERHEAD + length;
+				}
+				this->appendedPosition = lastAppended;
+			}
+			//Records older than the snapshot are dropped with a restart, new ones go after the last complete record
+			keepJournal = lastAppended == this->appendedPosition && lastConsumed <= this->appendedPosition - queue->getSize();
+		}
+		this->fileDescriptor = open(this->journalPath.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644);
+		if (this->fileDescriptor < 0) return false;
+		if (keepJournal) {
+			if (ftruncate(this->fileDescriptor, (off_t)this->journalLength) != 0) return false;
+		}
+		else if (!this->restartJournal(this->appendedPosition)) return false;
+	}
+	catch (BufferException&) {
+		return false;
+	}
+	this->committedConsumed = this->appendedPosition - queue->getSize();
+	this->queue = queue;
+	queue->journal = this;
+	return true;
+}
+//Endsection: QueueJournal implementation
+#pragma endregion QueueJournal implementation
+#endif
@@ -0,0 +1,59 @@
+//Buffer library by Huynh Hoang Kha
+//Write-ahead journal and snapshots that let a QueueArrayBuffer survive a crash (POSIX systems)
+#pragma once
+#ifndef _QUEUE_JOURNAL_H_
+#define _QUEUE_JOURNAL_H_
+#include "Buffer.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#define BUFFER_HAS_JOURNAL
+
+/*
+A QueueJournal keeps two files next to each other: basePath.snapshot and basePath.journal.
+Positions are counted in bytes over the whole life of the queue: 'appended' bytes were ever enQueued,
+'consumed' = appended - size were taken out.
+
+- While a queue is recorded, every byte any enQueue method stores is copied into a pending block in memory,
+  nothing else happens on the hot path (no system call, nothing on deQueue).
+- commit() appends the pending bytes and the consumed position as one record (lengths, positions and a CRC32C)
+  to the journal, then calls fdatasync once. It also runs by itself when the pending bytes reach groupCommitBytes.
+  What was enQueued/deQueued after the last commit is lost in a crash.
+- snapshot() writes the ring (capacity, endian, positions and data, in order) to a new snapshot file, renames it
+  over the old one and restarts the journal empty: the journal only holds what happened since.
+- recover() maps the snapshot (mmap through MappedFileBuffer), then replays only the journal records after it.
+  A torn or corrupted record at the end of the journal (crash during a commit) is cut off.
+
+The journal is not thread safe, like the queue it records. Journal files bigger than 2 GB can not be replayed,
+take snapshots before that.
+*/
+class QueueJournal {
+	string journalPath, snapshotPath;
+	QueueArrayBuffer* queue;
+	int fileDescriptor;				//Journal, opened for append by recover()
+	QueueArrayBuffer pending;		//Bytes enQueued since the last commit
+	long long appendedPosition;		//Position after the last byte enQueued
+	long long committedConsumed;	//Consumed position in the last record written
+	int groupCommitBytes;
+	long long journalLength;		//Bytes of the journal up to the end of the last complete record
+	bool restartJournal(long long basePosition);	//Truncate the journal to a header starting at 'basePosition'
+public:
+	//Nothing is opened before recover(). With groupCommitBytes 0 only explicit commit() calls write.
+	QueueJournal(const char* basePath, int groupCommitBytes = 1 << 20);
+	//Destructor: commit what is pending and let the queue go
+	~QueueJournal();
+	QueueJournal(const QueueJournal&) = delete;
+	QueueJournal& operator=(const QueueJournal&) = delete;
+	//Replace the content of the queue with the recovered one (empty if there are no files yet) and start recording it.
+	//Return false if a file can not be read or written, is not a journal/snapshot, or the queue can not hold the content.
+	bool recover(QueueArrayBuffer* queue);
+	bool commit();				//Write the pending bytes and the consumed position, then fdatasync, return false on an I/O error
+	bool snapshot();			//Write a snapshot of the queue and restart the journal from it, return false on an I/O error
+	void detach();				//Commit and stop recording the queue
+	long long getAppendedPosition() { return this->appendedPosition; };
+	long long getConsumedPosition() { return this->queue == NULL ? this->committedConsumed : this->appendedPosition - this->queue->getSize(); };
+	int getPendingBytes() { return this->pending.getSize(); };
+	//Called by the queue with the bytes an enQueue has just stored
+	void append(const uint8_t* data, int bytes);
+};
+#endif
+#endif // !_QUEUE_JOURNAL_H_
@@ -0,0 +1,96 @@
+//Buffer library by Huynh Hoang Kha
+//This implement a lock-free single-producer/single-consumer queue buffer
+#include "SPSCQueueBuffer.h"
+
+#pragma region SPSCQueueArrayBuffer implementation
+//------------------------------------------------------------------------------------------------------------
+//Section: SPSCQueueArrayBuffer implementation
+SPSCQueueArrayBuffer::SPSCQueueArrayBuffer(int capacity, Endian systemEndian) {
+	if (capacity < 0) {
+		BufferException bE(NEGATIVE_CAPACITY);
+		throw bE;
+	}
+	this->endian = systemEndian;
+	this->capacity = capacity;
+	this->ringSize = capacity + 1;
+	this->arrayPointer = NULL;
+	while (this->arrayPointer == NULL) this->arrayPointer = new uint8_t[this->ringSize];
+	memset((void*)this->arrayPointer, '\0', this->ringSize);
+	this->head.store(0, memory_order_relaxed);
+	this->tail.store(0, memory_order_relaxed);
+	this->cachedHead = 0;
+	this->cachedTail = 0;
+}
+
+SPSCQueueArrayBuffer::~SPSCQueueArrayBuffer() {
+	if (this->arrayPointer != NULL) {
+		delete[] this->arrayPointer;
+		this->arrayPointer = NULL;
+	}
+}
+
+int SPSCQueueArrayBuffer::getSize() {
+	int headIndex = this->head.load(memory_order_acquire);
+	return this->usedBytes(headIndex, this->tail.load(memory_order_acquire));
+}
+
+void SPSCQueueArrayBuffer::clean() {
+	this->head.store(0, memory_order_relaxed);
+	this->tail.store(0, memory_order_relaxed);
+	this->cachedHead = 0;
+	this->cachedTail = 0;
+	memset((void*)this->arrayPointer, '\0', this->ringSize);
+}
+
+bool SPSCQueueArrayBuffer::enQueueBlock(const void * memPtr, int blockSize) {
+	if (blockSize < 0) return false;
+	int tailIndex = this->tail.load(memory_order_relaxed);
+	//Only go to the consumer's cache line when the cached snapshot says the ring is too full
+	if (this->capacity - this->usedBytes(this->cachedHead, tailIndex) < blockSize) {
+		this->cachedHead = this->head.load(memory_order_acquire);
+		if (this->capacity - this->usedBytes(this->cachedHead, tailIndex) < blockSize) return false;
+	}
+	int firstPart = this->ringSize - tailIndex;
+	if (firstPart >= blockSize) memcpy((void*)(this->arrayPointer + tailIndex), memPtr, blockSize);
+	else {
+		memcpy((void*)(this->arrayPointer + tailIndex), memPtr, firstPart);
+		memcpy((void*)this->arrayPointer, (const uint8_t*)memPtr + firstPart, blockSize - firstPart);
+	}
+	this->tail.store(this->wrapIndex(tailIndex + blockSize), memory_order_release);
+	return true;
+}
+
+void SPSCQueueArrayBuffer::copyOut(int headIndex, void * memPtr, int blockSize) {
+	int firstPart = this->ringSize - headIndex;
+	if (firstPart >= blockSize) memcpy(memPtr, (void*)(this->arrayPointer + headIndex), blockSize);
+	else {
+		memcpy(memPtr, (void*)(this->arrayPointer + headIndex), firstPart);
+		memcpy((uint8_t*)memPtr + firstPart, (void*)this->arrayPointer, blockSize - firstPart);
+	}
+}
+
+bool SPSCQueueArrayBuffer::deQueueBlock(void * memPtr, int blockSize) {
+	if (blockSize < 0) return false;
+	int headIndex = this->head.load(memory_order_relaxed);
+	//Only go to the producer's cache line when the cached snapshot says there is not enough data
+	if (this->usedBytes(headIndex, this->cachedTail) < blockSize) {
+		this->cachedTail = this->tail.load(memory_order_acquire);
+		if (this->usedBytes(headIndex, this->cachedTail) < blockSize) return false;
+	}
+	this->copyOut(headIndex, memPtr, blockSize);
+	this->head.store(this->wrapIndex(headIndex + blockSize), memory_order_release);
+	return true;
+}
+
+bool SPSCQueueArrayBuffer::peekBlock(void * memPtr, int blockSize) {
+	if (blockSize < 0) return false;
+	int headIndex = this->head.load(memory_order_relaxed);
+	if (this->usedBytes(headIndex, this->cachedTail) < blockSize) {
+		this->cachedTail = this->tail.load(memory_order_acquire);
+		if (this->usedBytes(headIndex, this->cachedTail) < blockSize) return false;
+	}
+	this->copyOut(headIndex, memPtr, blockSize);
+	return true;
+}
+//Endsection: SPSCQueueArrayBuffer implementation
+#pragma endregion SPSCQueueArrayBuffer implementation
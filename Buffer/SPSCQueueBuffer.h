@@ -0,0 +1,102 @@
+//Buffer library by Huynh Hoang Kha
+//This implement a lock-free single-producer/single-consumer queue buffer
+//Exactly one thread may call the enQueue methods and exactly one thread may call the deQueue/peek methods
+#pragma once
+#ifndef _SPSC_QUEUE_BUFFER_H_
+#define _SPSC_QUEUE_BUFFER_H_
+#include <atomic>
+#include "Buffer.h"
+#include "CacheAligned.h"
+
+#pragma region SPSCQueueArrayBuffer
+class SPSCQueueArrayBuffer :public Queue<uint8_t>, public CacheAligned {
+	uint8_t* arrayPointer;
+	int ringSize;								//capacity + 1: one byte is kept free to tell a full ring from an empty one
+	int capacity;
+	Endian endian;
+	//Consumer side: the index it owns and its last snapshot of the producer's index
+	alignas(BUFFER_CACHE_LINE_SIZE) atomic<int> head;
+	int cachedTail;
+	//Producer side: the index it owns and its last snapshot of the consumer's index
+	alignas(BUFFER_CACHE_LINE_SIZE) atomic<int> tail;
+	int cachedHead;
+	int wrapIndex(int index) { return index >= this->ringSize ? index - this->ringSize : index; };
+	int usedBytes(int headIndex, int tailIndex) { return tailIndex >= headIndex ? tailIndex - headIndex : tailIndex + this->ringSize - headIndex; };
+	void copyOut(int headIndex, void* memPtr, int blockSize);
+public:
+	//Construct this SPSCQueueArrayBuffer with the size 'capacity'
+	SPSCQueueArrayBuffer(int capacity, Endian systemEndian);
+	//Destructor: Unallocate all memory.
+	~SPSCQueueArrayBuffer();
+	SPSCQueueArrayBuffer(const SPSCQueueArrayBuffer&) = delete;
+	SPSCQueueArrayBuffer& operator=(const SPSCQueueArrayBuffer&) = delete;
+	int getCapacity() { return this->capacity; };	//Return buffer's capacity
+	int getSize();									//Return number of bytes stored in the buffer, exact only when called by the producer or the consumer
+	bool isEmpty() { return this->getSize() == 0; };
+	bool isFull() { return this->getSize() == this->capacity; };
+	void clean();									//Drop all content, must not race with the producer or the consumer
+	//Block methods, called by the producer (enQueueBlock) or the consumer (deQueueBlock, peekBlock) only
+	bool enQueueBlock(const void* memPtr, int blockSize);	//Copy 'blockSize' bytes from memPtr to the end of the queue, return false if there is not enough space
+	bool deQueueBlock(void* memPtr, int blockSize);			//Move the 'blockSize' first-joined bytes out of the queue into memPtr, return false if there is not enough data
+	bool peekBlock(void* memPtr, int blockSize);			//Copy the 'blockSize' first-joined bytes into memPtr without removing them from the queue
+	//Templates for all queue's methods
+	template <typename T> bool enQueue(T input);
+	template <typename T> bool deQueue(T* output);
+	template <typename T> BufferResult<T> tryDeQueue() noexcept;	//Never throw, the error comes back as the code of the result (see BufferResult)
+	//Methods must be implemented to complete the Queue<uint8_t> interface
+	bool enQueue(uint8_t dataIn) { return this->enQueue<uint8_t>(dataIn); };			//Push a byte to the queue, return true if insertion was OK
+	bool deQueue(uint8_t* dataOut) { return this->deQueue<uint8_t>(dataOut); };		//Return the first-joined byte in the queue and then remove it from the queue
+	//Queue methods for char
+	bool enQueueChar(char dataIn) { return this->enQueue(dataIn); };		//Push a char to the queue, return true if insertion was OK
+	bool deQueueChar(char* dataOut) { return this->deQueue(dataOut); };		//Return the first-joined char in the queue and then remove it from the queue
+	BufferResult<char> tryDeQueueChar() noexcept { return this->tryDeQueue<char>(); };
+	//Queue methods for int
+	bool enQueueInt(int dataIn) { return this->enQueue(dataIn); };			//Push an int to the queue, return true if insertion was OK
+	bool deQueueInt(int* dataOut) { return this->deQueue(dataOut); };		//Return the first-joined int in the queue and then remove it from the queue
+	BufferResult<int> tryDeQueueInt() noexcept { return this->tryDeQueue<int>(); };
+	//Queue methods for float
+	bool enQueueFloat(float dataIn) { return this->enQueue(dataIn); };		//Push a float to the queue, return true if insertion was OK
+	bool deQueueFloat(float* dataOut) { return this->deQueue(dataOut); };	//Return the first-joined float in the queue and then remove it from the queue
+	BufferResult<float> tryDeQueueFloat() noexcept { return this->tryDeQueue<float>(); };
+	//Queue methods for long
+	bool enQueueLong(long dataIn) { return this->enQueue(dataIn); };		//Push a long to the queue, return true if insertion was OK
+	bool deQueueLong(long* dataOut) { return this->deQueue(dataOut); };		//Return the first-joined long in the queue and then remove it from the queue
+	BufferResult<long> tryDeQueueLong() noexcept { return this->tryDeQueue<long>(); };
+	//Queue methods for double
+	bool enQueueDouble(double dataIn) { return this->enQueue(dataIn); };	//Push a double to the queue, return true if insertion was OK
+	bool deQueueDouble(double* dataOut) { return this->deQueue(dataOut); };	//Return the first-joined double in the queue and then remove it from the queue
+	BufferResult<double> tryDeQueueDouble() noexcept { return this->tryDeQueue<double>(); };
+};
+#pragma endregion SPSCQueueArrayBuffer
+
+#pragma region SPSCQueueArrayBuffer templates
+template<typename T>
+inline bool SPSCQueueArrayBuffer::enQueue(T dataIn) {
+	uint8_t bytes[sizeof(T)];
+	if (!encodePrimity(bytes, dataIn, this->endian)) return false;
+	return this->enQueueBlock(bytes, sizeof(T));
+}
+
+template<typename T>
+inline bool SPSCQueueArrayBuffer::deQueue(T* dataOut) {
+#ifndef BUFFER_COMPILE_TIME_ENDIAN
+	if (this->endian == NOT_SET) return false;
+#endif
+	uint8_t bytes[sizeof(T)];
+	if (!this->deQueueBlock(bytes, sizeof(T))) return false;
+	return decodePrimity(bytes, dataOut, this->endian);
+}
+
+template<typename T>
+inline BufferResult<T> SPSCQueueArrayBuffer::tryDeQueue() noexcept {
+	BufferResult<T> result;
+	result.value = 0;
+	if (this->deQueue(&result.value)) result.code = NO_EXCEPTION;
+#ifndef BUFFER_COMPILE_TIME_ENDIAN
+	else if (this->endian == NOT_SET) result.code = NOT_SET_ENDIAN;
+#endif
+	else result.code = NOT_ENOUGH_DATA_TO_DEQUEUE;
+	return result;
+}
+#pragma endregion SPSCQueueArrayBuffer templates
+#endif // !_SPSC_QUEUE_BUFFER_H_
@@ -5,6 +5,7 @@
 template <class T>
 class Stack {
 public:
+	virtual ~Stack() {};
 	virtual T pop() = 0;
 	virtual T top() = 0;
 	virtual bool pop(T* output) = 0;
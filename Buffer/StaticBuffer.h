@@ -0,0 +1,315 @@
+//Buffer library by Huynh Hoang Kha
+//This implement fixed-capacity stack/queue buffers with inline storage
+//Using compile-time capacity and non-virtual, inlinable methods
+#pragma once
+#ifndef _STATIC_BUFFER_H_
+#define _STATIC_BUFFER_H_
+#include "Buffer.h"
+
+/*
+StaticStackBuffer<N, systemEndian> and StaticQueueBuffer<N, systemEndian> hold their N bytes inside the
+object (no heap allocation) and implement no interface, so every call is resolved at compile time and can
+be inlined. 'systemEndian' plays the role of the Endian given to the other buffers' constructors, the data
+they store is laid out like the data of StackArrayBuffer/QueueArrayBuffer.
+Code that needs runtime polymorphism wraps them with StackInterfaceAdapter/QueueInterfaceAdapter.
+*/
+
+#pragma region StaticStackBuffer
+template <int N, Endian systemEndian = HOST_ENDIAN>
+class StaticStackBuffer final {
+	static_assert(N > 0, "StaticStackBuffer capacity must be positive");
+	static_assert(systemEndian != NOT_SET, "Please set Endian to be BIG_ENDIAN or LITTLE_ENDIAN according to your system.");
+	uint8_t arrayPointer[N];
+	int size;
+public:
+	StaticStackBuffer() { this->size = 0; };
+	static constexpr int getCapacity() { return N; };		//Return buffer's capacity
+	int getSize() const { return this->size; };				//Return number of bytes stored in the buffer
+	bool isEmpty() const { return this->size == 0; };		//Return true if the buffer is empty
+	bool isFull() const { return this->size == N; };		//Return true if the buffer is full
+	void clean() { this->size = 0; };						//Clean the buffer's content
+	const uint8_t* getData() const { return this->arrayPointer; };	//Return the data array, the bottom of the stack first
+	string getString() const { return string((const char*)this->arrayPointer, this->size); };	//Return the whole data as std::string object
+	//Methods that will throw exception when error occur (in the case of empty/full stack errors)
+	template <typename T> T pop();				//Return the primity at top of stack and then remove it from stack
+	template <typename T> T top();				//Return the primity at top of stack without removing it from stack
+	//Methods that return false when error occur (in the case of empty/full stack errors), output value via a pointer
+	template <typename T> bool pop(T* output);	//Return the primity at top of stack and then remove it from stack
+	template <typename T> bool top(T* output);	//Return the primity at top of stack without removing it from stack
+	template <typename T> bool push(T input);	//Push a primity to stack, return true if insertion was OK
+	//Methods that never throw, the error comes back as the code of the result (see BufferResult)
+	template <typename T> BufferResult<T> tryPop() noexcept;	//Return the primity at top of stack and then remove it from stack
+	template <typename T> BufferResult<T> tryTop() noexcept;	//Return the primity at top of stack without removing it from stack
+	//1-byte methods, same names as the stack interface
+	uint8_t pop() { return this->pop<uint8_t>(); }
+	uint8_t top() { return this->top<uint8_t>(); }
+	bool pop(uint8_t* output) { return this->pop<uint8_t>(output); }
+	bool top(uint8_t* output) { return this->top<uint8_t>(output); }
+	bool push(uint8_t input) { return this->push<uint8_t>(input); }
+	//Stack methods implementation for char
+	char popChar() { return this->pop<char>(); }
+	char topChar() { return this->top<char>(); }
+	bool popChar(char* output) { return this->pop(output); }
+	bool topChar(char* output) { return this->top(output); }
+	bool pushChar(char input) { return this->push(input); }
+	BufferResult<char> tryPopChar() noexcept { return this->tryPop<char>(); }
+	BufferResult<char> tryTopChar() noexcept { return this->tryTop<char>(); }
+	//Stack methods implementation for int
+	int popInt() { return this->pop<int>(); }
+	int topInt() { return this->top<int>(); }
+	bool popInt(int* output) { return this->pop(output); }
+	bool topInt(int* output) { return this->top(output); }
+	bool pushInt(int input) { return this->push(input); }
+	BufferResult<int> tryPopInt() noexcept { return this->tryPop<int>(); }
+	BufferResult<int> tryTopInt() noexcept { return this->tryTop<int>(); }
+	//Stack methods implementation for float
+	float popFloat() { return this->pop<float>(); }
+	float topFloat() { return this->top<float>(); }
+	bool popFloat(float* output) { return this->pop(output); }
+	bool topFloat(float* output) { return this->top(output); }
+	bool pushFloat(float input) { return this->push(input); }
+	BufferResult<float> tryPopFloat() noexcept { return this->tryPop<float>(); }
+	BufferResult<float> tryTopFloat() noexcept { return this->tryTop<float>(); }
+	//Stack methods implementation for long
+	long popLong() { return this->pop<long>(); }
+	long topLong() { return this->top<long>(); }
+	bool popLong(long* output) { return this->pop(output); }
+	bool topLong(long* output) { return this->top(output); }
+	bool pushLong(long input) { return this->push(input); }
+	BufferResult<long> tryPopLong() noexcept { return this->tryPop<long>(); }
+	BufferResult<long> tryTopLong() noexcept { return this->tryTop<long>(); }
+	//Stack methods implementation for double
+	double popDouble() { return this->pop<double>(); }
+	double topDouble() { return this->top<double>(); }
+	bool popDouble(double* output) { return this->pop(output); }
+	bool topDouble(double* output) { return this->top(output); }
+	bool pushDouble(double input) { return this->push(input); }
+	BufferResult<double> tryPopDouble() noexcept { return this->tryPop<double>(); }
+	BufferResult<double> tryTopDouble() noexcept { return this->tryTop<double>(); }
+};
+#pragma endregion StaticStackBuffer
+
+#pragma region StaticStackBuffer templates
+template <int N, Endian systemEndian>
+template <typename T>
+inline T StaticStackBuffer<N, systemEndian>::pop() {
+	T output;
+	if (!this->pop(&output)) {
+		BufferException bE(NOT_ENOUGH_DATA_TO_POP);
+		throw bE;
+	}
+	return output;
+}
+
+template <int N, Endian systemEndian>
+template <typename T>
+inline T StaticStackBuffer<N, systemEndian>::top() {
+	T output;
+	if (!this->top(&output)) {
+		BufferException bE(NOT_ENOUGH_DATA_TO_TOP);
+		throw bE;
+	}
+	return output;
+}
+
+template <int N, Endian systemEndian>
+template <typename T>
+inline bool StaticStackBuffer<N, systemEndian>::pop(T * output) {
+	if (!this->top(output)) return false;
+	this->size -= sizeof(T);
+	return true;
+}
+
+template <int N, Endian systemEndian>
+template <typename T>
+inline bool StaticStackBuffer<N, systemEndian>::top(T * output) {
+	if (this->size < (int)sizeof(T)) return false;
+	return decodePrimity(this->arrayPointer + this->size - sizeof(T), output, systemEndian);
+}
+
+template <int N, Endian systemEndian>
+template <typename T>
+inline bool StaticStackBuffer<N, systemEndian>::push(T input) {
+	if (N - this->size < (int)sizeof(T)) return false;
+	encodePrimity(this->arrayPointer + this->size, input, systemEndian);
+	this->size += sizeof(T);
+	return true;
+}
+
+template <int N, Endian systemEndian>
+template <typename T>
+inline BufferResult<T> StaticStackBuffer<N, systemEndian>::tryPop() noexcept {
+	BufferResult<T> result;
+	result.value = 0;
+	result.code = this->pop(&result.value) ? NO_EXCEPTION : NOT_ENOUGH_DATA_TO_POP;
+	return result;
+}
+
+template <int N, Endian systemEndian>
+template <typename T>
+inline BufferResult<T> StaticStackBuffer<N, systemEndian>::tryTop() noexcept {
+	BufferResult<T> result;
+	result.value = 0;
+	result.code = this->top(&result.value) ? NO_EXCEPTION : NOT_ENOUGH_DATA_TO_TOP;
+	return result;
+}
+#pragma endregion StaticStackBuffer templates
+
+#pragma region StaticQueueBuffer
+template <int N, Endian systemEndian = HOST_ENDIAN>
+class StaticQueueBuffer final {
+	static_assert(N > 0, "StaticQueueBuffer capacity must be positive");
+	static_assert(systemEndian != NOT_SET, "Please set Endian to be BIG_ENDIAN or LITTLE_ENDIAN according to your system.");
+	static constexpr int capacityMask = ((N & (N - 1)) == 0) ? N - 1 : -1;	//N - 1 when N is a power of two, -1 otherwise
+	uint8_t arrayPointer[N];
+	int firstIndex;
+	int size;
+	//Bring an index in the range [0, 2 * N) back into the ring, the branch is resolved at compile time
+	static int wrapIndex(int index) { return (capacityMask >= 0) ? (index & capacityMask) : (index >= N ? index - N : index); };
+	void copyOut(void* memPtr, int blockSize);
+public:
+	StaticQueueBuffer() { this->firstIndex = this->size = 0; };
+	static constexpr int getCapacity() { return N; };		//Return buffer's capacity
+	int getSize() const { return this->size; };				//Return number of bytes stored in the buffer
+	bool isEmpty() const { return this->size == 0; };		//Return true if the buffer is empty
+	bool isFull() const { return this->size == N; };		//Return true if the buffer is full
+	void clean() { this->firstIndex = this->size = 0; };	//Clean the buffer's content
+	//Block methods: move a whole memory block in at most two memcpy calls around the wrap point
+	bool enQueueBlock(const void* memPtr, int blockSize);	//Copy 'blockSize' bytes from memPtr to the end of the queue, return false if there is not enough space
+	bool deQueueBlock(void* memPtr, int blockSize);			//Move the 'blockSize' first-joined bytes out of the queue into memPtr, return false if there is not enough data
+	bool peekBlock(void* memPtr, int blockSize);			//Copy the 'blockSize' first-joined bytes into memPtr without removing them from the queue
+	//Templates for all queue's methods
+	template <typename T> bool enQueue(T input);
+	template <typename T> bool deQueue(T* output);
+	template <typename T> BufferResult<T> tryDeQueue() noexcept;	//Never throw, the error comes back as the code of the result (see BufferResult)
+	//1-byte methods, same names as the queue interface
+	bool enQueue(uint8_t dataIn) { return this->enQueue<uint8_t>(dataIn); };
+	bool deQueue(uint8_t* dataOut) { return this->deQueue<uint8_t>(dataOut); };
+	//Queue methods for char
+	bool enQueueChar(char dataIn) { return this->enQueue(dataIn); };
+	bool deQueueChar(char* dataOut) { return this->deQueue(dataOut); };
+	BufferResult<char> tryDeQueueChar() noexcept { return this->tryDeQueue<char>(); };
+	//Queue methods for int
+	bool enQueueInt(int dataIn) { return this->enQueue(dataIn); };
+	bool deQueueInt(int* dataOut) { return this->deQueue(dataOut); };
+	BufferResult<int> tryDeQueueInt() noexcept { return this->tryDeQueue<int>(); };
+	//Queue methods for float
+	bool enQueueFloat(float dataIn) { return this->enQueue(dataIn); };
+	bool deQueueFloat(float* dataOut) { return this->deQueue(dataOut); };
+	BufferResult<float> tryDeQueueFloat() noexcept { return this->tryDeQueue<float>(); };
+	//Queue methods for long
+	bool enQueueLong(long dataIn) { return this->enQueue(dataIn); };
+	bool deQueueLong(long* dataOut) { return this->deQueue(dataOut); };
+	BufferResult<long> tryDeQueueLong() noexcept { return this->tryDeQueue<long>(); };
+	//Queue methods for double
+	bool enQueueDouble(double dataIn) { return this->enQueue(dataIn); };
+	bool deQueueDouble(double* dataOut) { return this->deQueue(dataOut); };
+	BufferResult<double> tryDeQueueDouble() noexcept { return this->tryDeQueue<double>(); };
+};
+#pragma endregion StaticQueueBuffer
+
+#pragma region StaticQueueBuffer templates
+template <int N, Endian systemEndian>
+inline void StaticQueueBuffer<N, systemEndian>::copyOut(void * memPtr, int blockSize) {
+	int firstPart = N - this->firstIndex;
+	if (firstPart >= blockSize) memcpy(memPtr, (void*)(this->arrayPointer + this->firstIndex), blockSize);
+	else {
+		memcpy(memPtr, (void*)(this->arrayPointer + this->firstIndex), firstPart);
+		memcpy((void*)((uint8_t*)memPtr + firstPart), (void*)this->arrayPointer, blockSize - firstPart);
+	}
+}
+
+template <int N, Endian systemEndian>
+inline bool StaticQueueBuffer<N, systemEndian>::enQueueBlock(const void * memPtr, int blockSize) {
+	if (blockSize < 0 || blockSize > N - this->size) return false;
+	int tail = wrapIndex(this->firstIndex + this->size);
+	int firstPart = N - tail;
+	if (firstPart >= blockSize) memcpy((void*)(this->arrayPointer + tail), memPtr, blockSize);
+	else {
+		memcpy((void*)(this->arrayPointer + tail), memPtr, firstPart);
+		memcpy((void*)this->arrayPointer, (const void*)((const uint8_t*)memPtr + firstPart), blockSize - firstPart);
+	}
+	this->size += blockSize;
+	return true;
+}
+
+template <int N, Endian systemEndian>
+inline bool StaticQueueBuffer<N, systemEndian>::deQueueBlock(void * memPtr, int blockSize) {
+	if (!this->peekBlock(memPtr, blockSize)) return false;
+	this->firstIndex = wrapIndex(this->firstIndex + blockSize);
+	this->size -= blockSize;
+	return true;
+}
+
+template <int N, Endian systemEndian>
+inline bool StaticQueueBuffer<N, systemEndian>::peekBlock(void * memPtr, int blockSize) {
+	if (blockSize < 0 || blockSize > this->size) return false;
+	this->copyOut(memPtr, blockSize);
+	return true;
+}
+
+template <int N, Endian systemEndian>
+template <typename T>
+inline bool StaticQueueBuffer<N, systemEndian>::enQueue(T dataIn) {
+	if (N - this->size < (int)sizeof(T)) return false;
+	int tail = wrapIndex(this->firstIndex + this->size);
+	if (N - tail >= (int)sizeof(T)) encodePrimity(this->arrayPointer + tail, dataIn, systemEndian);
+	else {
+		uint8_t bytes[sizeof(T)];
+		encodePrimity(bytes, dataIn, systemEndian);
+		return this->enQueueBlock(bytes, sizeof(T));
+	}
+	this->size += sizeof(T);
+	return true;
+}
+
+template <int N, Endian systemEndian>
+template <typename T>
+inline bool StaticQueueBuffer<N, systemEndian>::deQueue(T * dataOut) {
+	if (this->size < (int)sizeof(T)) return false;
+	if (N - this->firstIndex >= (int)sizeof(T)) decodePrimity(this->arrayPointer + this->firstIndex, dataOut, systemEndian);
+	else {
+		uint8_t bytes[sizeof(T)];
+		this->copyOut(bytes, sizeof(T));
+		decodePrimity(bytes, dataOut, systemEndian);
+	}
+	this->firstIndex = wrapIndex(this->firstIndex + sizeof(T));
+	this->size -= sizeof(T);
+	return true;
+}
+
+template <int N, Endian systemEndian>
+template <typename T>
+inline BufferResult<T> StaticQueueBuffer<N, systemEndian>::tryDeQueue() noexcept {
+	BufferResult<T> result;
+	result.value = 0;
+	result.code = this->deQueue(&result.value) ? NO_EXCEPTION : NOT_ENOUGH_DATA_TO_DEQUEUE;
+	return result;
+}
+#pragma endregion StaticQueueBuffer templates
+
+#pragma region Interface adapters
+//Expose a StaticStackBuffer (or any class with the same 1-byte methods) through the virtual Stack<uint8_t> interface
+template <class StackType>
+class StackInterfaceAdapter final :public Stack<uint8_t> {
+	StackType& stack;
+public:
+	StackInterfaceAdapter(StackType& stack) :stack(stack) {};
+	uint8_t pop() { return this->stack.pop(); }
+	uint8_t top() { return this->stack.top(); }
+	bool pop(uint8_t* output) { return this->stack.pop(output); }
+	bool top(uint8_t* output) { return this->stack.top(output); }
+	bool push(uint8_t input) { return this->stack.push(input); }
+};
+
+//Expose a StaticQueueBuffer (or any class with the same 1-byte methods) through the virtual Queue<uint8_t> interface
+template <class QueueType>
+class QueueInterfaceAdapter final :public Queue<uint8_t> {
+	QueueType& queue;
+public:
+	QueueInterfaceAdapter(QueueType& queue) :queue(queue) {};
+	bool deQueue(uint8_t* dataPtr) { return this->queue.deQueue(dataPtr); }
+	bool enQueue(uint8_t data) { return this->queue.enQueue(data); }
+};
+#pragma endregion Interface adapters
+#endif // !_STATIC_BUFFER_H_
@@ -0,0 +1,83 @@
+//Buffer library by Huynh Hoang Kha
+//LEB128 varint and zigzag helpers shared by the stack/queue buffers
+#pragma once
+#ifndef _VARINT_H_
+#define _VARINT_H_
+#include <cstdint>
+#include <cstring>
+
+/*
+A varint stores 7 bits of the value per byte, least significant group first, and sets the high bit of
+every byte but the last: values below 128 take 1 byte and a full 64-bit value takes 10.
+Zigzag maps signed values to unsigned ones so that small negative numbers stay short too
+(0, -1, 1, -2, 2... become 0, 1, 2, 3, 4...).
+*/
+#define VARINT_MAX_BYTES 10
+
+inline uint64_t zigzagEncode(int64_t value) { return ((uint64_t)value << 1) ^ (uint64_t)(value >> 63); }
+inline int64_t zigzagDecode(uint64_t value) { return (int64_t)(value >> 1) ^ -(int64_t)(value & 1); }
+
+//Return the number of bytes the varint of 'value' takes
+inline int varintSize(uint64_t value) {
+	int size = 1;
+	while (value >= 0x80) {
+		value >>= 7;
+		size++;
+	}
+	return size;
+}
+
+//Write the varint of 'value' at dst (VARINT_MAX_BYTES must be available), return the number of bytes written
+inline int encodeVarint(uint64_t value, uint8_t* dst) {
+	int size = 0;
+	while (value >= 0x80) {
+		dst[size++] = (uint8_t)(value | 0x80);
+		value >>= 7;
+	}
+	dst[size++] = (uint8_t)value;
+	return size;
+}
+
+//Read one varint from the 'available' bytes at src, return the number of bytes used or 0 if it is truncated or too long
+inline int decodeVarint(const uint8_t* src, int available, uint64_t* value) {
+	if (available > 0 && src[0] < 0x80) {
+		*value = src[0];
+		return 1;
+	}
+	uint64_t result = 0;
+	int limit = available < VARINT_MAX_BYTES ? available : VARINT_MAX_BYTES;
+	for (int i = 0; i < limit; i++) {
+		result |= (uint64_t)(src[i] & 0x7F) << (7 * i);
+		if (src[i] < 0x80) {
+			*value = result;
+			return i + 1;
+		}
+	}
+	return 0;
+}
+
+//Batched decoder: read up to 'maxCount' varints from the 'size' bytes at src into output.
+//Runs of 8 one-byte varints are recognized with a single 64-bit test. Decoding stops at the first truncated
+//or invalid varint, *consumed receives the number of bytes used and the number of values is returned.
+inline int decodeVarints(const uint8_t* src, int size, uint64_t* output, int maxCount, int* consumed) {
+	int position = 0, count = 0;
+	while (count < maxCount && position < size) {
+		if (size - position >= 8 && maxCount - count >= 8) {
+			uint64_t word;
+			memcpy(&word, src + position, 8);
+			if ((word & 0x8080808080808080ULL) == 0) {
+				for (int i = 0; i < 8; i++) output[count + i] = src[position + i];
+				position += 8;
+				count += 8;
+				continue;
+			}
+		}
+		int length = decodeVarint(src + position, size - position, output + count);
+		if (length == 0) break;
+		position += length;
+		count++;
+	}
+	*consumed = position;
+	return count;
+}
+#endif // !_VARINT_H_
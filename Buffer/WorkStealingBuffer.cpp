@@ -0,0 +1,222 @@
+//Buffer library by Huynh Hoang Kha
+//This implement a work-stealing stack buffer (Chase-Lev deque) and a small thread pool scheduler built on it
+#include <chrono>
+#include "WorkStealingBuffer.h"
+
+#pragma region WorkStealingStackBuffer implementation
+//------------------------------------------------------------------------------------------------------------
+//Section: WorkStealingStackBuffer implementation
+//Chase-Lev deque with the C11 memory orders of Le, Pop, Cohen and Zappa Nardelli (PPoPP 2013):
+//the owner's top is their 'bottom' and the thieves' bottom is their 'top'
+WorkStealingStackBuffer::WorkStealingStackBuffer(int capacity, Endian systemEndian) {
+	if (capacity < 0) {
+		BufferException bE(NEGATIVE_CAPACITY);
+		throw bE;
+	}
+	long long slotCount = 1;
+	while (slotCount < capacity) slotCount <<= 1;
+	this->endian = systemEndian;
+	this->ring.store(newRing(slotCount), memory_order_relaxed);
+	this->topIndex.store(0, memory_order_relaxed);
+	this->bottomIndex.store(0, memory_order_relaxed);
+}
+
+WorkStealingStackBuffer::~WorkStealingStackBuffer() {
+	Ring* current = this->ring.load(memory_order_relaxed);
+	while (current != NULL) {
+		Ring* retired = current->retired;
+		delete[] current->slots;
+		delete[] current->lengths;
+		delete current;
+		current = retired;
+	}
+}
+
+WorkStealingStackBuffer::Ring * WorkStealingStackBuffer::newRing(long long slotCount) {
+	Ring* result = NULL;
+	while (result == NULL) result = new Ring;
+	result->slots = NULL;
+	while (result->slots == NULL) result->slots = new atomic<uint64_t>[slotCount];
+	result->lengths = NULL;
+	while (result->lengths == NULL) result->lengths = new atomic<uint8_t>[slotCount];
+	result->mask = slotCount - 1;
+	result->retired = NULL;
+	return result;
+}
+
+WorkStealingStackBuffer::Ring * WorkStealingStackBuffer::grow(Ring * full, long long bottom, long long top) {
+	Ring* bigger = newRing(2 * (full->mask + 1));
+	for (long long position = bottom; position < top; position++) {
+		bigger->slots[position & bigger->mask].store(full->slots[position & full->mask].load(memory_order_relaxed), memory_order_relaxed);
+		bigger->lengths[position & bigger->mask].store(full->lengths[position & full->mask].load(memory_order_relaxed), memory_order_relaxed);
+	}
+	bigger->retired = full;
+	this->ring.store(bigger, memory_order_release);
+	return bigger;
+}
+
+int WorkStealingStackBuffer::getSize() {
+	long long bottom = this->bottomIndex.load(memory_order_acquire);
+	long long top = this->topIndex.load(memory_order_acquire);
+	return top > bottom ? (int)(top - bottom) : 0;
+}
+
+bool WorkStealingStackBuffer::pushBlock(const void * memPtr, int blockSize) {
+	if (blockSize <= 0 || blockSize > WORK_STEALING_SLOT_PAYLOAD) return false;
+	uint64_t value = 0;
+	memcpy(&value, memPtr, blockSize);
+	long long top = this->topIndex.load(memory_order_relaxed);
+	long long bottom = this->bottomIndex.load(memory_order_acquire);
+	Ring* current = this->ring.load(memory_order_relaxed);
+	if (top - bottom > current->mask) current = this->grow(current, bottom, top);
+	current->slots[top & current->mask].store(value, memory_order_relaxed);
+	current->lengths[top & current->mask].store((uint8_t)blockSize, memory_order_relaxed);
+	//Publish the item before the new top
+	atomic_thread_fence(memory_order_release);
+	this->topIndex.store(top + 1, memory_order_relaxed);
+	return true;
+}
+
+bool WorkStealingStackBuffer::popBlock(void * memPtr, int blockSize) {
+	if (blockSize <= 0 || blockSize > WORK_STEALING_SLOT_PAYLOAD) return false;
+	//Claim the newest item first, then look at what the thieves have taken
+	long long top = this->topIndex.load(memory_order_relaxed) - 1;
+	Ring* current = this->ring.load(memory_order_relaxed);
+	this->topIndex.store(top, memory_order_relaxed);
+	atomic_thread_fence(memory_order_seq_cst);
+	long long bottom = this->bottomIndex.load(memory_order_relaxed);
+	if (bottom > top || current->lengths[top & current->mask].load(memory_order_relaxed) != blockSize) {
+		//Empty, or an item of another size that stays where it is
+		this->topIndex.store(top + 1, memory_order_relaxed);
+		return false;
+	}
+	uint64_t value = current->slots[top & current->mask].load(memory_order_relaxed);
+	if (bottom == top) {
+		//The last item: the thieves may want it too, whoever moves bottomIndex first gets it
+		bool taken = this->bottomIndex.compare_exchange_strong(bottom, bottom + 1, memory_order_seq_cst, memory_order_relaxed);
+		this->topIndex.store(top + 1, memory_order_relaxed);
+		if (!taken) return false;
+	}
+	memcpy(memPtr, &value, blockSize);
+	return true;
+}
+
+bool WorkStealingStackBuffer::topBlock(void * memPtr, int blockSize) {
+	if (blockSize <= 0 || blockSize > WORK_STEALING_SLOT_PAYLOAD) return false;
+	long long top = this->topIndex.load(memory_order_relaxed) - 1;
+	long long bottom = this->bottomIndex.load(memory_order_acquire);
+	Ring* current = this->ring.load(memory_order_relaxed);
+	if (bottom > top || current->lengths[top & current->mask].load(memory_order_relaxed) != blockSize) return false;
+	uint64_t value = current->slots[top & current->mask].load(memory_order_relaxed);
+	memcpy(memPtr, &value, blockSize);
+	return true;
+}
+
+bool WorkStealingStackBuffer::stealBlock(void * memPtr, int blockSize) {
+	if (blockSize <= 0 || blockSize > WORK_STEALING_SLOT_PAYLOAD) return false;
+	long long bottom = this->bottomIndex.load(memory_order_acquire);
+	atomic_thread_fence(memory_order_seq_cst);
+	long long top = this->topIndex.load(memory_order_acquire);
+	if (bottom >= top) return false;
+	Ring* current = this->ring.load(memory_order_acquire);
+	if (current->lengths[bottom & current->mask].load(memory_order_relaxed) != blockSize) return false;
+	uint64_t value = current->slots[bottom & current->mask].load(memory_order_relaxed);
+	//The item is ours only if nobody moved bottomIndex since it was read
+	if (!this->bottomIndex.compare_exchange_strong(bottom, bottom + 1, memory_order_seq_cst, memory_order_relaxed)) return false;
+	memcpy(memPtr, &value, blockSize);
+	return true;
+}
+//Endsection: WorkStealingStackBuffer implementation
+#pragma endregion WorkStealingStackBuffer implementation
+
+#pragma region TaskScheduler implementation
+//------------------------------------------------------------------------------------------------------------
+//Section: TaskScheduler implementation
+#define SUBMITTED_QUEUE_CAPACITY 4096
+#define WORKER_STACK_CAPACITY 256
+#define IDLE_YIELDS 64			//Idle rounds spent yielding before a worker starts sleeping between rounds
+
+static thread_local TaskScheduler* currentScheduler = NULL;
+static thread_local int currentWorker = -1;
+
+TaskScheduler::TaskScheduler(function<void(long)> runTask, int workerCount, bool stealing)
+: submitted(SUBMITTED_QUEUE_CAPACITY, HOST_ENDIAN) {
+	if (workerCount <= 0) workerCount = (int)thread::hardware_concurrency();
+	if (workerCount <= 0) workerCount = 1;
+	this->workerCount = workerCount;
+	this->runTask = runTask;
+	this->stealing = stealing;
+	this->unfinished.store(0, memory_order_relaxed);
+	this->stopping.store(false, memory_order_relaxed);
+	this->workers = NULL;
+	while (this->workers == NULL) this->workers = new Worker[workerCount];
+	for (int i = 0; i < workerCount; i++) {
+		this->workers[i].tasks = new WorkStealingStackBuffer(WORKER_STACK_CAPACITY, HOST_ENDIAN);
+		this->workers[i].executed.store(0, memory_order_relaxed);
+		this->workers[i].stolen.store(0, memory_order_relaxed);
+	}
+	//Start the threads once every worker's stack exists, they steal from each other
+	for (int i = 0; i < workerCount; i++) this->workers[i].runner = thread(&TaskScheduler::run, this, i);
+}
+
+TaskScheduler::~TaskScheduler() {
+	this->wait();
+	this->stopping.store(true, memory_order_release);
+	for (int i = 0; i < this->workerCount; i++) this->workers[i].runner.join();
+	for (int i = 0; i < this->workerCount; i++) delete this->workers[i].tasks;
+	delete[] this->workers;
+}
+
+int TaskScheduler::getCurrentWorker() {
+	return currentScheduler == this ? currentWorker : -1;
+}
+
+void TaskScheduler::spawn(long task) {
+	//Counted before it can run, so that wait() never sees 0 while it is pending
+	this->unfinished.fetch_add(1, memory_order_relaxed);
+	int worker = this->getCurrentWorker();
+	if (worker >= 0) this->workers[worker].tasks->pushLong(task);
+	else while (!this->submitted.enQueueLong(task)) this_thread::yield();
+}
+
+void TaskScheduler::wait() {
+	while (this->unfinished.load(memory_order_acquire) != 0) this_thread::yield();
+}
+
+bool TaskScheduler::findTask(int index, unsigned & seed, long * task) {
+	if (this->workers[index].tasks->popLong(task)) return true;
+	if (this->submitted.deQueueLong(task)) return true;
+	if (!this->stealing || this->workerCount == 1) return false;
+	//Visit the other workers once, starting from a random one
+	seed = seed * 1103515245 + 12345;
+	int victim = (int)((seed >> 16) % (unsigned)this->workerCount);
+	for (int i = 0; i < this->workerCount; i++, victim = (victim + 1) % this->workerCount) {
+		if (victim == index || !this->workers[victim].tasks->stealLong(task)) continue;
+		this->workers[index].stolen.fetch_add(1, memory_order_relaxed);
+		return true;
+	}
+	return false;
+}
+
+void TaskScheduler::run(int index) {
+	currentScheduler = this;
+	currentWorker = index;
+	unsigned seed = 2654435761u * (index + 1);
+	int idleRounds = 0;
+	long task;
+	while (!this->stopping.load(memory_order_acquire)) {
+		if (!this->findTask(index, seed, &task)) {
+			if (++idleRounds < IDLE_YIELDS) this_thread::yield();
+			else this_thread::sleep_for(chrono::microseconds(100));
+			continue;
+		}
+		idleRounds = 0;
+		this->runTask(task);
+		this->workers[index].executed.fetch_add(1, memory_order_relaxed);
+		this->unfinished.fetch_sub(1, memory_order_release);
+	}
+	currentScheduler = NULL;
+	currentWorker = -1;
+}
+//Endsection: TaskScheduler implementation
+#pragma endregion TaskScheduler implementation
@@ -0,0 +1,187 @@
+//Buffer library by Huynh Hoang Kha
+//This implement a work-stealing stack buffer (Chase-Lev deque) and a small thread pool scheduler built on it
+//The owner thread pushes/pops at the top without locks, any other thread steals from the bottom with a CAS
+#pragma once
+#ifndef _WORK_STEALING_BUFFER_H_
+#define _WORK_STEALING_BUFFER_H_
+#include <atomic>
+#include <functional>
+#include <thread>
+#include "MPMCQueueBuffer.h"
+
+#define WORK_STEALING_SLOT_PAYLOAD 8	//Biggest item a slot can hold, enough for every primitive (long, double)
+
+#pragma region WorkStealingStackBuffer
+/*
+Every push stores one whole item in one slot, like MPMCQueueArrayBuffer: a pop/steal takes one item back
+and fails without removing anything when the item does not have the requested size.
+Only the owner thread may call push/pop/top, it gets the newest items (LIFO, cache friendly).
+Any thread may call steal, it gets the oldest item. steal also returns false when it loses a race
+for the last items against the owner or another thief: try another victim, then come back.
+The ring grows when the owner pushes into a full one. Old rings are freed with the buffer,
+since a thief may still be reading them.
+*/
+class WorkStealingStackBuffer :public Stack<uint8_t>, public CacheAligned {
+	struct Ring {
+		atomic<uint64_t>* slots;		//Items, stored as the bytes of encodePrimity
+		atomic<uint8_t>* lengths;		//Number of bytes stored in each slot
+		long long mask;					//Number of slots - 1, a power of two
+		Ring* retired;					//The smaller ring this one replaced
+	};
+	alignas(BUFFER_CACHE_LINE_SIZE) atomic<long long> topIndex;		//Owner side: position of the next push
+	alignas(BUFFER_CACHE_LINE_SIZE) atomic<long long> bottomIndex;	//Thief side: position of the oldest item
+	alignas(BUFFER_CACHE_LINE_SIZE) atomic<Ring*> ring;
+	Endian endian;
+	static Ring* newRing(long long slotCount);
+	Ring* grow(Ring* full, long long bottom, long long top);	//Copy the items into a ring twice as big and publish it (owner only)
+public:
+	//Construct this WorkStealingStackBuffer to hold 'capacity' items before it grows, rounded up to a power of two
+	WorkStealingStackBuffer(int capacity, Endian systemEndian);
+	//Destructor: Unallocate all memory, no thread may use the buffer any more
+	virtual ~WorkStealingStackBuffer();
+	WorkStealingStackBuffer(const WorkStealingStackBuffer&) = delete;
+	WorkStealingStackBuffer& operator=(const WorkStealingStackBuffer&) = delete;
+	int getCapacity() { return (int)(this->ring.load(memory_order_acquire)->mask + 1); };	//Return the number of items the ring holds before growing
+	int getSize();									//Return the number of items stored, a snapshot only while other threads are running
+	bool isEmpty() { return this->getSize() == 0; };
+	//Block methods, 'blockSize' must be in the range [1, WORK_STEALING_SLOT_PAYLOAD]
+	bool pushBlock(const void* memPtr, int blockSize);	//Owner: store 'blockSize' bytes as one item on top (grows the ring if it is full)
+	bool popBlock(void* memPtr, int blockSize);			//Owner: move the newest item into memPtr, false if the stack is empty or the item is not 'blockSize' bytes long
+	bool topBlock(void* memPtr, int blockSize);			//Owner: copy the newest item without removing it (a thief may still take it if it is the last one)
+	bool stealBlock(void* memPtr, int blockSize);		//Any thread: move the oldest item into memPtr, false if it is empty, the item has another size or another thread got it first
+	//Templates for all stack's methods
+	template <typename T> T pop();				//Owner: return the newest primity and then remove it, throw if the stack is empty
+	template <typename T> T top();				//Owner: return the newest primity without removing it, throw if the stack is empty
+	template <typename T> bool pop(T* output);	//Owner: return the newest primity and then remove it from stack
+	template <typename T> bool top(T* output);	//Owner: return the newest primity without removing it from stack
+	template <typename T> bool push(T input);	//Owner: push a primity to stack
+	template <typename T> bool steal(T* output);	//Any thread: take the oldest primity
+	//Implement compulsory methods in the stack interface
+	uint8_t pop() { return this->pop<uint8_t>(); }
+	uint8_t top() { return this->top<uint8_t>(); }
+	bool pop(uint8_t* output) { return this->pop<uint8_t>(output); }
+	bool top(uint8_t* output) { return this->top<uint8_t>(output); }
+	bool push(uint8_t input) { return this->push<uint8_t>(input); }
+	//Stack methods for char
+	bool pushChar(char input) { return this->push(input); }
+	bool popChar(char* output) { return this->pop(output); }
+	bool stealChar(char* output) { return this->steal(output); }
+	//Stack methods for int
+	bool pushInt(int input) { return this->push(input); }
+	bool popInt(int* output) { return this->pop(output); }
+	bool stealInt(int* output) { return this->steal(output); }
+	//Stack methods for float
+	bool pushFloat(float input) { return this->push(input); }
+	bool popFloat(float* output) { return this->pop(output); }
+	bool stealFloat(float* output) { return this->steal(output); }
+	//Stack methods for long
+	bool pushLong(long input) { return this->push(input); }
+	bool popLong(long* output) { return this->pop(output); }
+	bool stealLong(long* output) { return this->steal(output); }
+	//Stack methods for double
+	bool pushDouble(double input) { return this->push(input); }
+	bool popDouble(double* output) { return this->pop(output); }
+	bool stealDouble(double* output) { return this->steal(output); }
+};
+#pragma endregion WorkStealingStackBuffer
+
+#pragma region TaskScheduler
+/*
+A fixed pool of worker threads running tasks identified by a long handle (an index, a pointer...).
+Each worker keeps its own WorkStealingStackBuffer: spawn() from inside a task pushes on the current worker's
+stack, spawn() from any other thread goes through a shared MPMCQueueArrayBuffer. An idle worker takes its
+own newest task first, then the submitted ones, then steals the oldest task of another worker.
+*/
+class TaskScheduler :public CacheAligned {
+	struct Worker {
+		WorkStealingStackBuffer* tasks;
+		thread runner;
+		atomic<long long> executed;		//Tasks run by this worker
+		atomic<long long> stolen;		//Tasks this worker stole from the others
+		char padding[BUFFER_CACHE_LINE_SIZE];	//Keep the counters of two workers off the same cache line
+	};
+	Worker* workers;
+	int workerCount;
+	MPMCQueueArrayBuffer submitted;		//Tasks spawned from outside the pool
+	function<void(long)> runTask;
+	bool stealing;
+	alignas(BUFFER_CACHE_LINE_SIZE) atomic<long long> unfinished;	//Tasks spawned and not finished yet
+	atomic<bool> stopping;
+	void run(int index);
+	bool findTask(int index, unsigned& seed, long* task);
+public:
+	//Start 'workerCount' threads (0: one per hardware thread) calling runTask for every task.
+	//With stealing false the workers only run their own and the submitted tasks (for comparisons).
+	TaskScheduler(function<void(long)> runTask, int workerCount = 0, bool stealing = true);
+	//Destructor: wait for the tasks to finish and stop the threads
+	~TaskScheduler();
+	TaskScheduler(const TaskScheduler&) = delete;
+	TaskScheduler& operator=(const TaskScheduler&) = delete;
+	void spawn(long task);		//Schedule a task, from a task (current worker's stack) or any other thread (shared queue)
+	void wait();				//Return when every spawned task has finished, may be called by any thread that is not a worker
+	int getWorkerCount() { return this->workerCount; };
+	int getCurrentWorker();		//Return the index of the calling worker, -1 outside the pool
+	long long getExecutedTasks(int worker) { return this->workers[worker].executed.load(memory_order_relaxed); };
+	long long getStolenTasks(int worker) { return this->workers[worker].stolen.load(memory_order_relaxed); };
+};
+#pragma endregion TaskScheduler
+
+#pragma region WorkStealingStackBuffer templates
+template<typename T>
+inline T WorkStealingStackBuffer::pop() {
+	T data;
+	if (!this->pop(&data)) {
+		BufferException bE(NOT_ENOUGH_DATA_TO_POP);
+		throw bE;
+	}
+	return data;
+}
+
+template<typename T>
+inline T WorkStealingStackBuffer::top() {
+	T data;
+	if (!this->top(&data)) {
+		BufferException bE(NOT_ENOUGH_DATA_TO_TOP);
+		throw bE;
+	}
+	return data;
+}
+
+template<typename T>
+inline bool WorkStealingStackBuffer::pop(T * output) {
+	static_assert(sizeof(T) <= WORK_STEALING_SLOT_PAYLOAD, "Value is too big for a WorkStealingStackBuffer slot");
+#ifndef BUFFER_COMPILE_TIME_ENDIAN
+	if (this->endian == NOT_SET) return false;	//Checked first so that no item is taken and lost
+#endif
+	uint8_t bytes[sizeof(T)];
+	return this->popBlock(bytes, sizeof(T)) && decodePrimity(bytes, output, this->endian);
+}
+
+template<typename T>
+inline bool WorkStealingStackBuffer::top(T * output) {
+	static_assert(sizeof(T) <= WORK_STEALING_SLOT_PAYLOAD, "Value is too big for a WorkStealingStackBuffer slot");
+#ifndef BUFFER_COMPILE_TIME_ENDIAN
+	if (this->endian == NOT_SET) return false;	//Checked first so that no item is taken and lost
+#endif
+	uint8_t bytes[sizeof(T)];
+	return this->topBlock(bytes, sizeof(T)) && decodePrimity(bytes, output, this->endian);
+}
+
+template<typename T>
+inline bool WorkStealingStackBuffer::push(T input) {
+	static_assert(sizeof(T) <= WORK_STEALING_SLOT_PAYLOAD, "Value is too big for a WorkStealingStackBuffer slot");
+	uint8_t bytes[sizeof(T)];
+	return encodePrimity(bytes, input, this->endian) && this->pushBlock(bytes, sizeof(T));
+}
+
+template<typename T>
+inline bool WorkStealingStackBuffer::steal(T * output) {
+	static_assert(sizeof(T) <= WORK_STEALING_SLOT_PAYLOAD, "Value is too big for a WorkStealingStackBuffer slot");
+#ifndef BUFFER_COMPILE_TIME_ENDIAN
+	if (this->endian == NOT_SET) return false;	//Checked first so that no item is taken and lost
+#endif
+	uint8_t bytes[sizeof(T)];
+	return this->stealBlock(bytes, sizeof(T)) && decodePrimity(bytes, output, this->endian);
+}
+#pragma endregion WorkStealingStackBuffer templates
+#endif // !_WORK_STEALING_BUFFER_H_
@@ -0,0 +1,115 @@
+//Buffer library by Huynh Hoang Kha
+//Tests of BlockingQueueArrayBuffer: timeouts on both sides, the consumer woken only once the batch set by setWakeBatch
+//fills up or flush() is called, and no wake call at all in a pipeline where neither side sleeps
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <thread>
+#include "../Buffer/BlockingQueueBuffer.h"
+#include "Check.h"
+using namespace std;
+
+#define PIPELINE_VALUES 100000
+
+static long long millisecondsSince(chrono::steady_clock::time_point start) {
+	return chrono::duration_cast<chrono::milliseconds>(chrono::steady_clock::now() - start).count();
+}
+
+static void testTimeouts() {
+	BlockingQueueArrayBuffer queue(8, LITTLE_ENDIAN);
+	int value = 0;
+	auto start = chrono::steady_clock::now();
+	CHECK(!queue.deQueueIntWait(&value, 10));
+	long long waited = millisecondsSince(start);
+	CHECK(waited >= 10 && waited < 1000);
+	CHECK(queue.getSleepCount() >= 1 && queue.getWakeCount() == 0);
+	//0 gives up after spinning, without sleeping
+	long long sleeps = queue.getSleepCount();
+	CHECK(!queue.deQueueIntWait(&value, 0) && queue.getSleepCount() == sleeps);
+	//The producer side times out the same way on a full queue
+	CHECK(queue.enQueueIntWait(1, 10) && queue.enQueueIntWait(2, 10));
+	start = chrono::steady_clock::now();
+	CHECK(!queue.enQueueIntWait(3, 10));
+	waited = millisecondsSince(start);
+	CHECK(waited >= 10 && waited < 1000);
+	//A block that can never fit fails at once
+	char big[9] = {};
+	start = chrono::steady_clock::now();
+	CHECK(!queue.enQueueBlockWait(big, 9, -1) && millisecondsSince(start) < 1000);
+	CHECK(queue.deQueueIntWait(&value, 10) && value == 1);
+	CHECK(queue.getWakeCount() == 0);
+}
+
+//Start a consumer thread waiting for one int, return once it is asleep
+static thread sleepingConsumer(BlockingQueueArrayBuffer& queue, atomic<bool>& got, int* value) {
+	long long sleeps = queue.getSleepCount();
+	got.store(false);
+	thread consumer([&queue, &got, value]() {
+		if (queue.deQueueIntWait(value, 5000)) got.store(true);
+	});
+	while (queue.getSleepCount() == sleeps) this_thread::yield();
+	return consumer;
+}
+
+static void testWakeBatch() {
+	BlockingQueueArrayBuffer queue(64, LITTLE_ENDIAN);
+	queue.setSpinCount(0);
+	queue.setWakeBatch(INT_MAX, 4);
+	atomic<bool> got(false);
+	int value = -1;
+	//Three values are less than the batch: the consumer keeps sleeping, the fourth wakes it
+	thread consumer = sleepingConsumer(queue, got, &value);
+	auto start = chrono::steady_clock::now();
+	for (int i = 0; i < 3; i++) CHECK(queue.enQueueInt(i));
+	this_thread::sleep_for(chrono::milliseconds(50));
+	CHECK(!got.load() && queue.getWakeCount() == 0);
+	CHECK(queue.enQueueInt(3));
+	consumer.join();
+	CHECK(got.load() && value == 0 && queue.getWakeCount() == 1 && millisecondsSince(start) < 5000);
+	for (int i = 1; i < 4; i++) CHECK(queue.deQueueInt(&value) && value == i);
+	//flush() wakes it before the batch is full
+	consumer = sleepingConsumer(queue, got, &value);
+	CHECK(queue.enQueueInt(4));
+	this_thread::sleep_for(chrono::milliseconds(50));
+	CHECK(!got.load() && queue.getWakeCount() == 1);
+	queue.flush();
+	consumer.join();
+	CHECK(got.load() && value == 4 && queue.getWakeCount() == 2);
+	//So do 'bytes' bytes, whatever the number of values
+	queue.setWakeBatch(8, 100);
+	consumer = sleepingConsumer(queue, got, &value);
+	CHECK(queue.enQueueInt(5));
+	this_thread::sleep_for(chrono::milliseconds(50));
+	CHECK(!got.load());
+	CHECK(queue.enQueueInt(6));
+	consumer.join();
+	CHECK(got.load() && value == 5 && queue.getWakeCount() == 3);
+	//Nothing stored since the last wake: flush() makes no call
+	queue.flush();
+	CHECK(queue.getWakeCount() == 3);
+}
+
+//Both sides spin instead of sleeping, so nobody is ever woken
+static void testBusyPipeline() {
+	BlockingQueueArrayBuffer queue(4096, LITTLE_ENDIAN);
+	queue.setSpinCount(INT_MAX);
+	long long sum = 0;
+	thread consumer([&queue, &sum]() {
+		long value;
+		for (long i = 0; i < PIPELINE_VALUES; i++) {
+			if (queue.deQueueLongWait(&value)) sum += value;
+		}
+	});
+	for (long i = 0; i < PIPELINE_VALUES; i++) CHECK(queue.enQueueLongWait(i));
+	queue.flush();
+	consumer.join();
+	CHECK(sum == (long long)PIPELINE_VALUES * (PIPELINE_VALUES - 1) / 2);
+	CHECK(queue.getSleepCount() == 0 && queue.getWakeCount() == 0);
+}
+
+int main() {
+	testTimeouts();
+	testWakeBatch();
+	testBusyPipeline();
+	return testResult("BlockingQueueTest");
+}
@@ -0,0 +1,348 @@
+//Buffer library by Huynh Hoang Kha
+//Tests of StackArrayBuffer, QueueArrayBuffer and their inline-storage versions: typed round-trips with buffers of both endians,
+//and the queue paths that cross the end of the ring (blocks, getSegments, find, linearize, message frames)
+#include <cstring>
+#include <string>
+#include "../Buffer/Buffer.h"
+#include "../Buffer/StaticBuffer.h"
+#include "Check.h"
+using namespace std;
+
+//Every typed method of the stack, values come back in reverse order and top does not remove them
+static void testStackRoundTrip(Endian endian) {
+	StackArrayBuffer stack(64, endian);
+	CHECK(stack.pushChar('k'));
+	CHECK(stack.pushInt(-123456789));
+	CHECK(stack.pushFloat(3.25f));
+	CHECK(stack.pushLong(-1234567890123L));
+	CHECK(stack.pushDouble(-2.5e-300));
+	CHECK(stack.getSize() == 1 + 4 + 4 + 8 + 8);
+	double d = 0;
+	CHECK(stack.topDouble(&d) && d == -2.5e-300);
+	CHECK(stack.popDouble(&d) && d == -2.5e-300);
+	long l = 0;
+	CHECK(stack.popLong(&l) && l == -1234567890123L);
+	float f = 0;
+	CHECK(stack.popFloat(&f) && f == 3.25f);
+	int i = 0;
+	CHECK(stack.popInt(&i) && i == -123456789);
+	char c = 0;
+	CHECK(stack.popChar(&c) && c == 'k');
+	CHECK(stack.isEmpty() && !stack.popChar(&c));
+	//Batched values keep their order inside the batch
+	int values[5] = { 1, -2, 3, -4, 0x7FFFFFFF }, output[5] = {};
+	CHECK(stack.pushInts(values, 5));
+	CHECK(stack.popInts(output, 5) && memcmp(values, output, sizeof(values)) == 0);
+	int tooMany[17] = {};
+	CHECK(!stack.pushInts(tooMany, 17));	//64 bytes hold 16 ints, all or none
+	CHECK(stack.isEmpty());
+}
+
+//A buffer declared with the host's endian stores big-endian (network order) bytes
+static void testWireOrder() {
+	StackArrayBuffer stack(8, HOST_ENDIAN);
+	CHECK(stack.pushInt(0x01020304));
+	const uint8_t expected[4] = { 1, 2, 3, 4 };
+	CHECK(memcmp(stack.getData().data, expected, 4) == 0);
+}
+
+//Every typed method of the queue, in a ring small enough that the values are split at its end
+static void testQueueRoundTrip(Endian endian, int capacity) {
+	QueueArrayBuffer queue(capacity, endian);
+	for (int round = 0; round < 20; round++) {
+		CHECK(queue.enQueueChar((char)('a' + round)));
+		CHECK(queue.enQueueInt(round * -1000003));
+		CHECK(queue.enQueueFloat(round + 0.5f));
+		CHECK(queue.enQueueLong(round * -100000000003L));
+		CHECK(queue.enQueueDouble(round / 3.0));
+		char c = 0;
+		int i = 0;
+		float f = 0;
+		long l = 0;
+		double d = 0;
+		CHECK(queue.deQueueChar(&c) && c == (char)('a' + round));
+		CHECK(queue.deQueueInt(&i) && i == round * -1000003);
+		CHECK(queue.deQueueFloat(&f) && f == round + 0.5f);
+		CHECK(queue.deQueueLong(&l) && l == round * -100000000003L);
+		CHECK(queue.deQueueDouble(&d) && d == round / 3.0);
+		CHECK(queue.isEmpty());
+	}
+	long values[3] = { 1, -2, 3 }, output[3] = {};
+	for (int round = 0; round < 10; round++) {
+		CHECK(queue.enQueueLongs(values, 3));
+		CHECK(queue.deQueueLongs(output, 3) && memcmp(values, output, sizeof(values)) == 0);
+	}
+	int i = 0;
+	CHECK(!queue.deQueueInt(&i));
+}
+
+//The inline-storage stack stores the same bytes as StackArrayBuffer and gives the values back in reverse order
+template <Endian endian>
+static void testStaticStack() {
+	StaticStackBuffer<21, endian> stack;
+	StackArrayBuffer reference(21, endian);
+	CHECK(stack.getCapacity() == 21 && stack.isEmpty());
+	CHECK(stack.pushChar('k') && stack.pushInt(-123456789) && stack.pushFloat(3.25f) && stack.pushLong(-1234567890123L));
+	CHECK(reference.pushChar('k') && reference.pushInt(-123456789) && reference.pushFloat(3.25f) && reference.pushLong(-1234567890123L));
+	CHECK(stack.getSize() == 17 && memcmp(stack.getData(), reference.getData().data, 17) == 0);
+	CHECK(!stack.pushDouble(1.0) && stack.pushInt(7) && !stack.pushChar('x') && stack.isFull());
+	CHECK(stack.topInt() == 7 && stack.popInt() == 7);
+	long l = 0;
+	CHECK(stack.popLong(&l) && l == -1234567890123L);
+	CHECK(stack.popFloat() == 3.25f && stack.popInt() == -123456789 && stack.popChar() == 'k');
+	CHECK(stack.isEmpty() && stack.tryPopInt().code == NOT_ENOUGH_DATA_TO_POP);
+	int thrown = NO_EXCEPTION;
+	try {
+		stack.topDouble();
+	}
+	catch (BufferException& e) {
+		thrown = e.exceptionCode;
+	}
+	CHECK(thrown == NOT_ENOUGH_DATA_TO_TOP);
+}
+
+//Every typed method of the inline-storage queue, with N a power of two (masked wrap) or not, the values split at its end
+template <int N, Endian endian>
+static void testStaticQueue() {
+	StaticQueueBuffer<N, endian> queue;
+	for (int round = 0; round < 20; round++) {
+		CHECK(queue.enQueueChar((char)('a' + round)));
+		CHECK(queue.enQueueInt(round * -1000003));
+		CHECK(queue.enQueueFloat(round + 0.5f));
+		CHECK(queue.enQueueLong(round * -100000000003L));
+		CHECK(queue.enQueueDouble(round / 3.0));
+		CHECK(queue.getSize() == 25 && !queue.enQueueLong(0));
+		char c = 0;
+		int i = 0;
+		float f = 0;
+		long l = 0;
+		double d = 0;
+		CHECK(queue.deQueueChar(&c) && c == (char)('a' + round));
+		CHECK(queue.deQueueInt(&i) && i == round * -1000003);
+		CHECK(queue.deQueueFloat(&f) && f == round + 0.5f);
+		CHECK(queue.deQueueLong(&l) && l == round * -100000000003L);
+		CHECK(queue.deQueueDouble(&d) && d == round / 3.0);
+		CHECK(queue.isEmpty());
+	}
+	//Blocks from every start position, the same bytes as QueueArrayBuffer
+	for (int start = 1; start < N; start++) {
+		QueueArrayBuffer reference(N, endian);
+		string skip(N - start, '-');
+		queue.clean();
+		CHECK(queue.enQueueBlock(skip.data(), N - start) && queue.deQueueBlock(&skip[0], N - start));
+		CHECK(reference.enQueueBlock(skip.data(), N - start) && reference.deQueueBlock(&skip[0], N - start));
+		CHECK(queue.enQueueInt(0x01020304) && queue.enQueueBlock("abcdefghij", 10));
+		CHECK(reference.enQueueInt(0x01020304) && reference.enQueueBlock("abcdefghij", 10));
+		char stored[15] = {}, expected[14] = {};
+		CHECK(queue.peekBlock(stored, 14) && reference.peekBlock(expected, 14) && memcmp(stored, expected, 14) == 0);
+		CHECK(!queue.deQueueBlock(stored, 15) && queue.deQueueBlock(stored, 14) && queue.isEmpty());
+	}
+	CHECK(queue.tryDeQueueInt().code == NOT_ENOUGH_DATA_TO_DEQUEUE);
+}
+
+//Bytes pushed and taken through the virtual interfaces reach the static buffers behind them
+static void moveThroughQueue(Queue<uint8_t>& from, Queue<uint8_t>& to) {
+	uint8_t byte;
+	while (from.deQueue(&byte)) to.enQueue(byte);
+}
+
+static void testInterfaceAdapters() {
+	StaticQueueBuffer<8, LITTLE_ENDIAN> first, second;
+	QueueInterfaceAdapter<StaticQueueBuffer<8, LITTLE_ENDIAN>> firstQueue(first), secondQueue(second);
+	char skipped[5];
+	CHECK(first.enQueueBlock("xxxxx", 5) && first.deQueueBlock(skipped, 5));
+	CHECK(first.enQueueInt(-5) && first.enQueueChar('q'));
+	moveThroughQueue(firstQueue, secondQueue);
+	int i = 0;
+	char c = 0;
+	CHECK(first.isEmpty() && second.getSize() == 5);
+	CHECK(second.deQueueInt(&i) && i == -5 && second.deQueueChar(&c) && c == 'q');
+	StaticStackBuffer<4> stack;
+	StackInterfaceAdapter<StaticStackBuffer<4>> adapter(stack);
+	Stack<uint8_t>& bytes = adapter;
+	CHECK(bytes.push(1) && bytes.push(2) && bytes.push(3) && bytes.push(4) && !bytes.push(5));
+	CHECK(stack.topInt() == 0x01020304 && bytes.pop() == 4 && bytes.top() == 3 && stack.getSize() == 3);
+}
+
+//A queue of 'capacity' bytes whose data starts 'start' bytes before the end of the array
+static void fillAcrossEnd(QueueArrayBuffer& queue, int capacity, int start, const string& text) {
+	string skip(capacity - start, '-');
+	queue.enQueueBlock(skip.data(), (int)skip.size());
+	queue.discard((int)skip.size());
+	queue.enQueueBlock(text.data(), (int)text.size());
+}
+
+static void testBlocksAcrossEnd() {
+	const string text = "0123456789abcdefghij";
+	for (int start = 1; start < 20; start++) {
+		QueueArrayBuffer queue(24, LITTLE_ENDIAN);
+		fillAcrossEnd(queue, 24, start, text);
+		CHECK(queue.getSize() == 20);
+		char peeked[20], taken[20];
+		CHECK(queue.peekBlock(peeked, 20) && memcmp(peeked, text.data(), 20) == 0);
+		CHECK(queue.getString() == text);
+		CHECK(!queue.enQueueBlock(text.data(), 5));	//4 bytes free
+		CHECK(queue.deQueueBlock(taken, 7) && memcmp(taken, text.data(), 7) == 0);
+		CHECK(queue.enQueueBlock(text.data(), 7));
+		CHECK(queue.deQueueBlock(taken, 20) && memcmp(taken, text.data() + 7, 13) == 0 && memcmp(taken + 13, text.data(), 7) == 0);
+		CHECK(queue.isEmpty() && !queue.deQueueBlock(taken, 1));
+	}
+}
+
+static void testSegments() {
+	const string text = "0123456789";
+	QueueArrayBuffer queue(16, LITTLE_ENDIAN);
+	fillAcrossEnd(queue, 16, 4, text);
+	BufferSegments segments = queue.getSegments();
+	CHECK(!segments.isContiguous() && segments.size() == 10);
+	CHECK(segments.first.size == 4 && memcmp(segments.first.data, "0123", 4) == 0);
+	CHECK(segments.second.size == 6 && memcmp(segments.second.data, "456789", 6) == 0);
+	uint32_t crc = 0;
+	CHECK(queue.peekCrc32c(10, &crc) && crc == crc32c(text.data(), 10) && crc32c(segments) == crc);
+	//Data that does not wrap comes back as one segment
+	QueueArrayBuffer flat(16, LITTLE_ENDIAN);
+	flat.enQueueBlock(text.data(), 10);
+	segments = flat.getSegments();
+	CHECK(segments.isContiguous() && segments.first.size == 10 && segments.second.data == NULL);
+}
+
+static void testFindAcrossEnd() {
+	const string text = "GET / HTTP/1.1\r\nHost: x\r\n\r\n";
+	int size = (int)text.size();
+	for (int start = 1; start < size; start++) {
+		QueueArrayBuffer queue(32, LITTLE_ENDIAN);
+		fillAcrossEnd(queue, 32, start, text);
+		CHECK(queue.find('\n') == 15);
+		CHECK(queue.find('\n', 16) == 24);
+		CHECK(queue.find('#') == -1);
+		CHECK(queue.findAny(":\r", 2) == 14);
+		CHECK(queue.find("\r\n\r\n", 4) == size - 4);
+		CHECK(queue.find("HTTP", 4) == 6);
+		CHECK(queue.find("Host", 4, 7) == 16);
+		CHECK(queue.find("\r\n\r\n", 4, size - 3) == -1);
+		//A cursor resumes where the last search stopped and stays on a match until it is taken out
+		ScanCursor cursor;
+		CHECK(queue.findNext("\r\n", 2, &cursor) == 14);
+		CHECK(queue.findNext("\r\n", 2, &cursor) == 14);
+		CHECK(queue.discard(16));
+		CHECK(queue.findNext("\r\n", 2, &cursor) == 7);
+	}
+}
+
+static void testLinearize() {
+	const string text = "abcdefghijkl";
+	for (int start = 1; start <= 12; start++) {
+		QueueArrayBuffer queue(16, LITTLE_ENDIAN);
+		fillAcrossEnd(queue, 16, start, text);
+		BufferSpan span = queue.linearize();
+		CHECK(span.size == 12 && memcmp(span.data, text.data(), 12) == 0);
+		CHECK(queue.getSegments().isContiguous());
+		//The queue keeps working from the new position
+		char taken[12];
+		CHECK(queue.enQueueBlock("mnop", 4) && queue.deQueueBlock(taken, 12) && memcmp(taken, text.data(), 12) == 0);
+		CHECK(queue.getString() == "mnop");
+	}
+}
+
+static string toString(BufferSegments segments) {
+	string text((const char*)segments.first.data, segments.first.size);
+	if (segments.second.size > 0) text.append((const char*)segments.second.data, segments.second.size);
+	return text;
+}
+
+//The bytes enQueueMessage stores for 'message'
+static string frameOf(MessageHeader header, const string& message) {
+	QueueArrayBuffer frame((int)message.size() + 8, BIG_ENDIAN);
+	frame.setMessageHeader(header);
+	frame.enQueueMessage(message.data(), (int)message.size());
+	return frame.getString();
+}
+
+//One 200 bytes message (a 2 bytes varint header) starting at every position before the end of the ring:
+//the header or the payload is split at the wrap point
+static void testMessageAcrossEnd(MessageHeader header) {
+	string message;
+	for (int i = 0; i < 200; i++) message += (char)('A' + i % 26);
+	int headerSize = header == FIXED_32_HEADER ? 4 : 2;
+	for (int start = 1; start < headerSize + 200; start++) {
+		QueueArrayBuffer queue(256, BIG_ENDIAN);
+		queue.setMessageHeader(header);
+		fillAcrossEnd(queue, 256, start, "");
+		CHECK(queue.enQueueMessage(message.data(), 200) && queue.getSize() == headerSize + 200);
+		BufferSegments payload;
+		CHECK(queue.peekMessage(&payload) && toString(payload) == message);
+		CHECK(payload.isContiguous() == (start <= headerSize));
+		char taken[200];
+		int length = -1;
+		CHECK(!queue.deQueueMessage(taken, 199, &length) && length == -1 && queue.getSize() == headerSize + 200);
+		CHECK(queue.deQueueMessage(taken, 200, &length) && length == 200 && memcmp(taken, message.data(), 200) == 0);
+		CHECK(queue.isEmpty());
+	}
+}
+
+//A frame is only seen once its last byte is stored
+static void testIncompleteMessage(MessageHeader header) {
+	string frame = frameOf(header, string(150, 'x'));
+	for (int stored = 0; stored < (int)frame.size(); stored += 7) {
+		QueueArrayBuffer queue(256, BIG_ENDIAN);
+		queue.setMessageHeader(header);
+		fillAcrossEnd(queue, 256, 100, frame.substr(0, stored));
+		BufferSegments payload;
+		char taken[150];
+		int length;
+		CHECK(!queue.peekMessage(&payload) && !queue.deQueueMessage(taken, 150, &length) && !queue.discardMessage());
+		CHECK(queue.deQueueMessages([](BufferSegments) {}) == 0 && queue.getSize() == stored);
+		CHECK(queue.enQueueBlock(frame.data() + stored, (int)frame.size() - stored));
+		CHECK(queue.peekMessage(&payload) && payload.size() == 150);
+		CHECK(queue.discardMessage() && queue.isEmpty());
+	}
+}
+
+static void testMessageBatches(MessageHeader header) {
+	QueueArrayBuffer queue(64, BIG_ENDIAN);
+	queue.setMessageHeader(header);
+	fillAcrossEnd(queue, 64, 10, "");
+	const char* messages[] = { "first", "", "third message", "4", "fifth one" };
+	for (const char* message : messages) CHECK(queue.enQueueMessage(message, (int)strlen(message)));
+	string partial = frameOf(header, "sixth");
+	CHECK(queue.enQueueBlock(partial.data(), (int)partial.size() - 1));
+	string handled;
+	CHECK(queue.deQueueMessages([&handled](BufferSegments payload) { handled += toString(payload) + "|"; }, 3) == 3);
+	CHECK(handled == "first||third message|");
+	handled.clear();
+	//The last frame is incomplete: the batch stops before it and leaves it in the queue
+	CHECK(queue.deQueueMessages([&handled](BufferSegments payload) { handled += toString(payload) + "|"; }) == 2);
+	CHECK(handled == "4|fifth one|" && queue.getSize() == (int)partial.size() - 1);
+	CHECK(queue.enQueueBlock(partial.data() + partial.size() - 1, 1));
+	CHECK(queue.deQueueMessages([&handled](BufferSegments payload) { handled += toString(payload); }, 0) == 0);
+	CHECK(queue.deQueueMessages([&handled](BufferSegments payload) { handled += toString(payload); }) == 1);
+	CHECK(handled == "4|fifth one|sixth" && queue.isEmpty());
+}
+
+int main() {
+	Endian endians[] = { LITTLE_ENDIAN, BIG_ENDIAN };
+	for (Endian endian : endians) {
+		testStackRoundTrip(endian);
+		testQueueRoundTrip(endian, 29);
+		testQueueRoundTrip(endian, 32);
+	}
+	testStaticStack<LITTLE_ENDIAN>();
+	testStaticStack<BIG_ENDIAN>();
+	testStaticQueue<29, LITTLE_ENDIAN>();
+	testStaticQueue<29, BIG_ENDIAN>();
+	testStaticQueue<32, LITTLE_ENDIAN>();
+	testStaticQueue<32, BIG_ENDIAN>();
+	testInterfaceAdapters();
+	testWireOrder();
+	testBlocksAcrossEnd();
+	testSegments();
+	testFindAcrossEnd();
+	testLinearize();
+	MessageHeader headers[] = { FIXED_32_HEADER, VARINT_HEADER };
+	for (MessageHeader header : headers) {
+		testMessageAcrossEnd(header);
+		testIncompleteMessage(header);
+		testMessageBatches(header);
+	}
+	return testResult("BufferTest");
+}
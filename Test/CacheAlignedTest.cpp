@@ -0,0 +1,35 @@
+//Buffer library by Huynh Hoang Kha
+//Tests that the classes with per-thread counters on separate cache lines get cache line aligned memory from new
+#include <cstdint>
+#include "../Buffer/BlockingQueueBuffer.h"
+#include "../Buffer/WorkStealingBuffer.h"
+#include "Check.h"
+using namespace std;
+
+static bool cacheAligned(const void* pointer) {
+	return (uintptr_t)pointer % BUFFER_CACHE_LINE_SIZE == 0;
+}
+
+//Several objects in a row, so that a heap that happens to return aligned blocks once does not hide the problem
+template <typename T, typename... Args>
+static void checkHeapAlignment(Args... args) {
+	T* objects[8];
+	for (int i = 0; i < 8; i++) {
+		objects[i] = new T(args...);
+		CHECK(cacheAligned(objects[i]));
+	}
+	for (int i = 0; i < 8; i++) delete objects[i];
+}
+
+int main() {
+	checkHeapAlignment<MPMCQueueArrayBuffer>(64, LITTLE_ENDIAN);
+	checkHeapAlignment<SPSCQueueArrayBuffer>(64, LITTLE_ENDIAN);
+	checkHeapAlignment<BlockingQueueArrayBuffer>(64, LITTLE_ENDIAN);
+	checkHeapAlignment<WorkStealingStackBuffer>(64, LITTLE_ENDIAN);
+	TaskScheduler* scheduler = new TaskScheduler([](long) {}, 2);
+	CHECK(cacheAligned(scheduler));
+	scheduler->spawn(1);
+	scheduler->wait();
+	delete scheduler;
+	return testResult("CacheAlignedTest");
+}
@@ -0,0 +1,17 @@
+//Buffer library by Huynh Hoang Kha
+//Minimal checks shared by the test executables: CHECK reports a failed condition and goes on, main returns testResult()
+#pragma once
+#ifndef _TEST_CHECK_H_
+#define _TEST_CHECK_H_
+#include <cstdio>
+
+static int testFailures = 0;
+
+#define CHECK(condition) do { if (!(condition)) { printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #condition); testFailures++; } } while (0)
+
+//Print the outcome, return the process exit status for ctest
+inline int testResult(const char* name) {
+	printf("%s: %s (%d failed checks)\n", name, testFailures == 0 ? "passed" : "FAILED", testFailures);
+	return testFailures == 0 ? 0 : 1;
+}
+#endif // !_TEST_CHECK_H_
@@ -0,0 +1,75 @@
+//Buffer library by Huynh Hoang Kha
+//Tests of CRC32C: the known answer with every implementation the CPU supports, chained calls against one call,
+//and the running checksum of a QueueArrayBuffer that wraps against the CRC32C of the bytes it stored
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include "../Buffer/Buffer.h"
+#include "Check.h"
+using namespace std;
+
+static void testKnownAnswer(Crc32cImplementation implementation) {
+	if (!setCrc32cImplementation(implementation)) return;
+	CHECK(getCrc32cImplementation() == implementation);
+	CHECK(crc32c("123456789", 9) == 0xE3069283);
+	CHECK(crc32c("", 0) == 0 && crc32c("x", 0, 1234) == 1234);
+	uint8_t zeros[32] = {};
+	CHECK(crc32c(zeros, 32) == 0x8A9136AA);		//RFC 3720 (iSCSI) test vector
+	//Every split point and every alignment gives the same value as one call
+	string text;
+	for (int i = 0; i < 300; i++) text += (char)(i * 37 + 11);
+	uint32_t whole = crc32c(text.data(), (int)text.size());
+	bool chained = true;
+	for (int split = 0; split <= (int)text.size(); split++) {
+		chained = chained && crc32c(text.data() + split, (int)text.size() - split, crc32c(text.data(), split)) == whole;
+	}
+	CHECK(chained);
+	uint32_t pieces = 0;
+	for (int offset = 0; offset < (int)text.size(); offset += 7) pieces = crc32c(text.data() + offset, min(7, (int)text.size() - offset), pieces);
+	CHECK(pieces == whole);
+}
+
+static void testImplementationsAgree() {
+	string text;
+	for (int i = 0; i < 5000; i++) text += (char)(i * 131 + (i >> 3));
+	setCrc32cImplementation(SOFTWARE_CRC32C);
+	uint32_t software[16];
+	for (int offset = 0; offset < 16; offset++) software[offset] = crc32c(text.data() + offset, (int)text.size() - 2 * offset);
+	if (!setCrc32cImplementation(SSE42_CRC32C)) return;
+	bool agree = true;
+	for (int offset = 0; offset < 16; offset++) agree = agree && crc32c(text.data() + offset, (int)text.size() - 2 * offset) == software[offset];
+	CHECK(agree);
+}
+
+//The running checksum follows the bytes as stored (the wire bytes, big endian with HOST_ENDIAN), on both sides of the wrap point
+static void testRunningChecksum() {
+	QueueArrayBuffer queue(16, HOST_ENDIAN);
+	CHECK(queue.enQueueBlock("0123456789", 10) && queue.discard(10));
+	queue.setRunningChecksum(true);
+	CHECK(queue.getRunningChecksum() == 0);
+	CHECK(queue.enQueueInt(0x01020304));
+	CHECK(queue.enQueueChar('z'));
+	CHECK(queue.enQueueBlock("abcdefghij", 10));	//From index 15 to 8: across the end
+	const uint8_t wire[15] = { 1, 2, 3, 4, 'z', 'a', 'b', 'c', 'd', 'e', 'f', 'g', 'h', 'i', 'j' };
+	CHECK(queue.getRunningChecksum() == crc32c(wire, 15));
+	CHECK(queue.getCrc32c() == crc32c(wire, 15));
+	uint32_t crc = 0;
+	CHECK(queue.peekCrc32c(7, &crc) && crc == crc32c(wire, 7));
+	//Taking bytes out does not change it, storing more continues it
+	CHECK(queue.discard(15) && queue.getRunningChecksum() == crc32c(wire, 15));
+	CHECK(queue.enQueueDouble(1.0));
+	const uint8_t more[8] = { 0x3F, 0xF0, 0, 0, 0, 0, 0, 0 };
+	CHECK(queue.getRunningChecksum() == crc32c(more, 8, crc32c(wire, 15)));
+	queue.resetRunningChecksum();
+	CHECK(queue.discard(8) && queue.enQueueBlock("123456789", 9) && queue.getRunningChecksum() == 0xE3069283);
+}
+
+int main() {
+	Crc32cImplementation best = getCrc32cImplementation();
+	testKnownAnswer(SOFTWARE_CRC32C);
+	testKnownAnswer(SSE42_CRC32C);
+	testImplementationsAgree();
+	setCrc32cImplementation(best);
+	testRunningChecksum();
+	return testResult("Crc32cTest");
+}
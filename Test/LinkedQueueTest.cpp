@@ -0,0 +1,138 @@
+//Buffer library by Huynh Hoang Kha
+//Tests of LinkedQueueBuffer: values straddling chunk boundaries, drained chunks reused and the memory held bounded
+//by the free list, the capacity limit, and random operations checked against a std::deque of the same bytes
+#include <cstring>
+#include <deque>
+#include <string>
+#include "../Buffer/LinkedQueueBuffer.h"
+#include "Check.h"
+using namespace std;
+
+#define RANDOM_OPERATIONS 20000
+
+//A chunk of 5 bytes puts every int and long across one or more boundaries
+static void testStraddle(Endian endian) {
+	LinkedQueueBuffer queue(endian, 5);
+	CHECK(queue.getChunkSize() == 5 && queue.isEmpty());
+	for (int round = 0; round < 20; round++) {
+		CHECK(queue.enQueueChar('a' + round % 26));
+		CHECK(queue.enQueueInt(round * -1000003));
+		CHECK(queue.enQueueLong(round * 12345678901L));
+		CHECK(queue.enQueueDouble(round * 0.125));
+	}
+	CHECK(queue.getSize() == 20 * (1 + 4 + 8 + 8));
+	//Offsets address the content from the head, through the chain
+	CHECK(queue.getInt(1) == 0 && queue.getInt(22) == -1000003);
+	CHECK(queue.writeLong(26, -7L) && queue.getLong(26) == -7L);
+	CHECK(queue.writeLong(26, 12345678901L));
+	CHECK(!queue.writeInt(queue.getSize() - 3, 0));
+	for (int round = 0; round < 20; round++) {
+		char c = 0;
+		int i = 0;
+		long l = 0;
+		double d = 0;
+		CHECK(queue.deQueueChar(&c) && c == 'a' + round % 26);
+		CHECK(queue.deQueueInt(&i) && i == round * -1000003);
+		CHECK(queue.deQueueLong(&l) && l == round * 12345678901L);
+		CHECK(queue.deQueueDouble(&d) && d == round * 0.125);
+	}
+	CHECK(queue.isEmpty());
+	BufferResult<int> result = queue.tryDeQueueInt();
+	CHECK(result.code == NOT_ENOUGH_DATA_TO_DEQUEUE);
+}
+
+static void testFreeList() {
+	LinkedQueueBuffer queue(LITTLE_ENDIAN, 16, INT_MAX, 2);
+	string block(160, 'x');
+	CHECK(queue.enQueueBlock(block.data(), 160) && queue.getAllocatedBytes() == 160);
+	//Ten chunks drained: one stays as the tail, two are kept, the others are freed
+	CHECK(queue.deQueueBlock(&block[0], 160) && queue.getAllocatedBytes() == 3 * 16);
+	CHECK(queue.enQueueBlock(block.data(), 48) && queue.getAllocatedBytes() == 3 * 16);
+	CHECK(queue.deQueueBlock(&block[0], 48));
+	//A backlog that stays small holds a bounded number of chunks however much goes through it
+	bool bounded = true;
+	for (int i = 0; i < 1000; i++) {
+		bounded = bounded && queue.enQueueBlock(block.data(), 37) && queue.getAllocatedBytes() <= (4 + 2) * 16;
+		bounded = bounded && queue.deQueueBlock(&block[0], 37) && queue.getAllocatedBytes() <= (4 + 2) * 16;
+	}
+	CHECK(bounded);
+	CHECK(queue.enQueueBlock(block.data(), 100));
+	queue.clean();
+	CHECK(queue.isEmpty() && queue.getAllocatedBytes() == 2 * 16);
+}
+
+static void testCapacity() {
+	LinkedQueueBuffer queue(LITTLE_ENDIAN, 8, 20);
+	char block[21] = {};
+	CHECK(!queue.enQueueBlock(block, 21) && queue.isEmpty());
+	CHECK(queue.enQueueBlock(block, 18));
+	CHECK(!queue.enQueueInt(1) && !queue.enQueueLong(1) && queue.getSize() == 18);	//All or nothing
+	CHECK(queue.enQueueChar('a') && queue.enQueueChar('b') && !queue.enQueueChar('c'));
+	CHECK(queue.deQueueBlock(block, 4) && queue.enQueueInt(7) && queue.getSize() == 20);
+	int thrown = NO_EXCEPTION;
+	try {
+		queue[20];
+	}
+	catch (BufferException& e) {
+		thrown = e.exceptionCode;
+	}
+	CHECK(thrown == OUT_OF_RANGE_INDEX);
+	thrown = NO_EXCEPTION;
+	try {
+		LinkedQueueBuffer invalid(LITTLE_ENDIAN, 0);
+	}
+	catch (BufferException& e) {
+		thrown = e.exceptionCode;
+	}
+	CHECK(thrown == INVALID_CHUNK_SIZE);
+}
+
+//Blocks of random sizes in and out, byte access and peeks, the content always equal to the model's
+static void testAgainstDeque() {
+	LinkedQueueBuffer queue(LITTLE_ENDIAN, 7, 500, 1);
+	deque<uint8_t> model;
+	unsigned seed = 2024;
+	uint8_t block[64];
+	bool same = true;
+	for (int step = 0; step < RANDOM_OPERATIONS && same; step++) {
+		seed = seed * 1103515245 + 12345;
+		int size = (int)((seed >> 16) % 40);
+		switch ((seed >> 8) % 5) {
+		case 0:
+		case 1:
+			for (int i = 0; i < size; i++) block[i] = (uint8_t)(seed + i * 31);
+			same = queue.enQueueBlock(block, size) == ((int)model.size() + size <= 500);
+			if (same && (int)model.size() + size <= 500) model.insert(model.end(), block, block + size);
+			break;
+		case 2:
+			same = queue.deQueueBlock(block, size) == (size <= (int)model.size());
+			for (int i = 0; same && i < size && size <= (int)model.size(); i++) same = block[i] == model[i];
+			if (size <= (int)model.size()) model.erase(model.begin(), model.begin() + size);
+			break;
+		case 3:
+			if (!model.empty()) {
+				int index = (int)(seed % model.size());
+				same = queue[index] == model[index];
+				queue[index] = model[index] = (uint8_t)step;
+			}
+			break;
+		default:
+			uint8_t byte = 0;
+			same = queue.deQueue(&byte) == !model.empty() && (model.empty() || byte == model.front());
+			if (!model.empty()) model.pop_front();
+		}
+		same = same && queue.getSize() == (int)model.size();
+		if (same && step % 100 == 0) same = queue.getString() == string(model.begin(), model.end());
+	}
+	CHECK(same);
+	CHECK(queue.getAllocatedBytes() <= (500 / 7 + 2 + 1) * 7);
+}
+
+int main() {
+	testStraddle(LITTLE_ENDIAN);
+	testStraddle(BIG_ENDIAN);
+	testFreeList();
+	testCapacity();
+	testAgainstDeque();
+	return testResult("LinkedQueueTest");
+}
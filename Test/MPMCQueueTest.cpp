@@ -0,0 +1,82 @@
+//Buffer library by Huynh Hoang Kha
+//Tests of MPMCQueueArrayBuffer: capacity limits, values of mixed sizes at the head (peekLength, discardFirst)
+//and every value delivered exactly once with several producers and consumers
+#include <thread>
+#include <vector>
+#include "../Buffer/Buffer.h"
+#include "../Buffer/MPMCQueueBuffer.h"
+#include "Check.h"
+using namespace std;
+
+static bool throwsCode(int capacity, int code) {
+	try {
+		MPMCQueueArrayBuffer queue(capacity, LITTLE_ENDIAN);
+	}
+	catch (BufferException& bE) {
+		return bE.getCode() == code;
+	}
+	return false;
+}
+
+static void testCapacity() {
+	MPMCQueueArrayBuffer queue(5, LITTLE_ENDIAN);
+	CHECK(queue.getCapacity() == 8);
+	CHECK(throwsCode(-1, NEGATIVE_CAPACITY));
+	CHECK(throwsCode(MPMC_MAX_CAPACITY + 1, CAPACITY_TOO_LARGE));
+	CHECK(throwsCode(0x7FFFFFFF, CAPACITY_TOO_LARGE));
+}
+
+//A value of the wrong size stays at the head until it is taken with its own size or discarded
+static void testMixedSizes() {
+	MPMCQueueArrayBuffer queue(4, LITTLE_ENDIAN);
+	CHECK(queue.peekLength() == -1 && !queue.discardFirst());
+	CHECK(queue.enQueueDouble(1.5));
+	CHECK(queue.enQueueInt(7));
+	CHECK(queue.enQueueChar('z'));
+	int i = 0;
+	CHECK(!queue.deQueueInt(&i) && queue.getSize() == 3);
+	CHECK(queue.peekLength() == (int)sizeof(double));
+	CHECK(queue.discardFirst() && queue.getSize() == 2);
+	CHECK(queue.peekLength() == (int)sizeof(int));
+	CHECK(queue.deQueueInt(&i) && i == 7);
+	char c = 0;
+	CHECK(queue.peekLength() == 1 && queue.deQueueChar(&c) && c == 'z');
+	CHECK(queue.isEmpty() && queue.peekLength() == -1);
+	//The slots freed by discardFirst are reused on the next lap
+	for (int k = 0; k < 4; k++) CHECK(queue.enQueueInt(k));
+	CHECK(queue.isFull() && !queue.enQueueInt(4));
+	for (int k = 0; k < 4; k++) CHECK(queue.discardFirst());
+	CHECK(queue.isEmpty());
+}
+
+static void testManyThreads() {
+	const int producers = 4, consumers = 4, perProducer = 50000;
+	MPMCQueueArrayBuffer queue(64, LITTLE_ENDIAN);
+	vector<int> seen(producers * perProducer, 0);
+	vector<thread> threads;
+	for (int p = 0; p < producers; p++) {
+		threads.emplace_back([&queue, p]() {
+			for (int k = 0; k < perProducer; k++) while (!queue.enQueueInt(p * perProducer + k)) this_thread::yield();
+		});
+	}
+	for (int c = 0; c < consumers; c++) {
+		threads.emplace_back([&queue, &seen]() {
+			int value;
+			for (int k = 0; k < producers * perProducer / consumers; k++) {
+				while (!queue.deQueueInt(&value)) this_thread::yield();
+				seen[value]++;
+			}
+		});
+	}
+	for (thread& t : threads) t.join();
+	bool once = true;
+	for (int count : seen) once = once && count == 1;
+	CHECK(once && queue.isEmpty());
+}
+
+int main() {
+	testCapacity();
+	testMixedSizes();
+	testManyThreads();
+	return testResult("MPMCQueueTest");
+}
@@ -0,0 +1,116 @@
+//Buffer library by Huynh Hoang Kha
+//Tests of MappedFileBuffer (POSIX systems): typed reads of a mapped temporary file, writes refused by a read-only
+//mapping, writes of a shared mapping found in the file after sync, and windows not aligned on a page moved by remap
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <unistd.h>
+#include "../Buffer/MappedFileBuffer.h"
+#include "Check.h"
+using namespace std;
+
+static string path;
+static int pageSize;
+
+static string readFile() {
+	ifstream file(path.c_str(), ios::binary);
+	ostringstream content;
+	content << file.rdbuf();
+	return content.str();
+}
+
+//Three pages and a bit of known bytes, with big-endian values at 0, 8 and one page + 3
+static string writeFile() {
+	string content(3 * pageSize + 100, '\0');
+	for (int i = 0; i < (int)content.size(); i++) content[i] = (char)(i * 7 + 1);
+	content.replace(0, 4, "\x01\x02\x03\x04", 4);
+	content.replace(8, 8, "\x3F\xF0\x00\x00\x00\x00\x00\x00", 8);
+	content.replace(pageSize + 3, 4, "\x11\x22\x33\x44", 4);
+	ofstream file(path.c_str(), ios::binary | ios::trunc);
+	file << content;
+	return content;
+}
+
+template <typename Action>
+static int exceptionOf(Action action) {
+	try {
+		action();
+	}
+	catch (BufferException& e) {
+		return e.exceptionCode;
+	}
+	return NO_EXCEPTION;
+}
+
+//A buffer declared with the host's endian reads the big-endian bytes of the file
+static void testReadOnly() {
+	string content = writeFile();
+	MappedFileBuffer file(path.c_str(), READ_ONLY_MAPPING, HOST_ENDIAN, true);
+	CHECK(file.getSize() == (int)content.size() && file.getFileSize() == (long long)content.size());
+	CHECK(file.getInt(0) == 0x01020304 && file.getDouble(8) == 1.0);
+	CHECK(file.getString() == content);
+	CHECK(file.advise(SEQUENTIAL_ACCESS) && file.advise(NORMAL_ACCESS));
+	//Nothing is written, nothing changes in the file
+	CHECK(file.isReadOnly());
+	CHECK(!file.writeInt(0, 5) && !file.writePrimity(8, 2.0) && !file.writeLong(16, 1L));
+	CHECK(!file.reserve(file.getCapacity() + 1) && file.getInt(0) == 0x01020304);
+	CHECK(exceptionOf([&file]() { file.clean(); }) == READ_ONLY_BUFFER && file.getSize() == (int)content.size());
+	CHECK(file.sync() && readFile() == content);
+}
+
+static void testSharedWrites() {
+	string content = writeFile();
+	MappedFileBuffer file(path.c_str(), SHARED_WRITABLE_MAPPING, HOST_ENDIAN);
+	CHECK(!file.isReadOnly());
+	CHECK(file.writeInt(4, 0x0A0B0C0D) && file.writeDouble(16, -2.0));
+	CHECK(!file.writeInt(file.getCapacity() - 3, 0));		//A mapping does not grow
+	CHECK(file.sync());
+	content.replace(4, 4, "\x0A\x0B\x0C\x0D", 4);
+	content.replace(16, 8, "\xC0\x00\x00\x00\x00\x00\x00\x00", 8);
+	CHECK(readFile() == content);
+	//Another mapping of the same file sees the bytes
+	MappedFileBuffer reader(path.c_str(), READ_ONLY_MAPPING, HOST_ENDIAN);
+	CHECK(reader.getInt(4) == 0x0A0B0C0D && reader.getDouble(16) == -2.0);
+	CHECK(file.sync(false));
+}
+
+//Windows start inside a page: the bytes before them are mapped but not part of the buffer
+static void testWindows() {
+	string content = writeFile();
+	MappedFileBuffer file(path.c_str(), SHARED_WRITABLE_MAPPING, HOST_ENDIAN, false, pageSize + 3, 100);
+	CHECK(file.getSize() == 100 && file.getCapacity() == 100);
+	CHECK(file.getInt(0) == 0x11223344 && file[4] == (uint8_t)content[pageSize + 7]);
+	CHECK(file.getString() == content.substr(pageSize + 3, 100));
+	//Across the boundary of two pages, then past the end of the file
+	CHECK(file.remap(2 * pageSize - 2, 10) && file.getString() == content.substr(2 * pageSize - 2, 10));
+	CHECK(file.writeInt(0, 0x55667788) && file.sync());
+	content.replace(2 * pageSize - 2, 4, "\x55\x66\x77\x88", 4);
+	CHECK(readFile() == content);
+	CHECK(!file.remap(3 * pageSize, 101) && !file.remap(-1, 10));
+	CHECK(file.remap(0, 0) && file.isEmpty());
+	CHECK(file.remap(3 * pageSize + 96, 4) && file.getString() == content.substr(3 * pageSize + 96));
+	//Length -1 maps up to the end of the file
+	MappedFileBuffer tail(path.c_str(), READ_ONLY_MAPPING, HOST_ENDIAN, false, 2 * pageSize + 1);
+	CHECK(tail.getSize() == pageSize + 99 && tail.getString() == content.substr(2 * pageSize + 1));
+	CHECK(exceptionOf([]() { MappedFileBuffer missing((path + ".missing").c_str(), READ_ONLY_MAPPING, HOST_ENDIAN); }) == FILE_OPEN_FAILED);
+	CHECK(exceptionOf([]() { MappedFileBuffer beyond(path.c_str(), READ_ONLY_MAPPING, HOST_ENDIAN, false, 0, 4 * pageSize); }) == FILE_MAP_FAILED);
+}
+
+int main() {
+	char temporary[] = "/tmp/MappedFileTestXXXXXX";
+	int descriptor = mkstemp(temporary);
+	if (descriptor < 0) {
+		printf("Cannot create a temporary file\n");
+		return 1;
+	}
+	close(descriptor);
+	path = temporary;
+	pageSize = (int)sysconf(_SC_PAGESIZE);
+	testReadOnly();
+	testSharedWrites();
+	testWindows();
+	unlink(path.c_str());
+	return testResult("MappedFileTest");
+}
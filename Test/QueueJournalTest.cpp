@@ -0,0 +1,185 @@
+//Buffer library by Huynh Hoang Kha
+//Tests of QueueJournal (POSIX systems): replay after a snapshot, torn and corrupted tail records cut off,
+//a journal newer than its snapshot rejected and a crash between the snapshot rename and the journal restart.
+//A crash is a copy of the files taken while the live journal is still open, recovered under another name.
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <unistd.h>
+#include "../Buffer/QueueJournal.h"
+#include "Check.h"
+using namespace std;
+
+static string directory;
+
+static string pathOf(const string& name) { return directory + "/" + name; }
+
+static string readFile(const string& path) {
+	ifstream file(path.c_str(), ios::binary);
+	ostringstream content;
+	content << file.rdbuf();
+	return content.str();
+}
+
+static void writeFile(const string& path, const string& content) {
+	ofstream file(path.c_str(), ios::binary | ios::trunc);
+	file << content;
+}
+
+static void removeFiles(const string& name) {
+	unlink((pathOf(name) + ".journal").c_str());
+	unlink((pathOf(name) + ".snapshot").c_str());
+}
+
+//What a crash would leave: the files of 'from' as they are now, copied to 'to'
+static void crashCopy(const string& from, const string& to) {
+	removeFiles(to);
+	const char* extensions[] = { ".journal", ".snapshot" };
+	for (const char* extension : extensions) {
+		if (access((pathOf(from) + extension).c_str(), F_OK) == 0) writeFile(pathOf(to) + extension, readFile(pathOf(from) + extension));
+	}
+}
+
+//Recover 'name' into a fresh queue, return false if recover does
+static bool recoverInto(const string& name, QueueArrayBuffer& queue, long long* consumed) {
+	QueueJournal journal(pathOf(name).c_str(), 0);
+	if (!journal.recover(&queue)) return false;
+	*consumed = journal.getConsumedPosition();
+	return true;
+}
+
+static void testReplayAfterSnapshot() {
+	removeFiles("live");
+	QueueArrayBuffer queue(64, LITTLE_ENDIAN);
+	QueueJournal journal(pathOf("live").c_str(), 0);
+	CHECK(journal.recover(&queue) && queue.isEmpty());
+	CHECK(queue.enQueueBlock("abc", 3) && journal.commit());
+	CHECK(journal.snapshot());
+	char c;
+	CHECK(queue.enQueueBlock("def", 3) && queue.deQueueChar(&c) && c == 'a');
+	CHECK(journal.commit());
+	CHECK(queue.enQueueBlock("ghi", 3));	//Not committed: lost in the crash
+	crashCopy("live", "crash");
+	QueueArrayBuffer recovered(64, LITTLE_ENDIAN);
+	long long consumed = -1;
+	CHECK(recoverInto("crash", recovered, &consumed));
+	CHECK(recovered.getString() == "bcdef" && consumed == 1);
+	//The recovered journal keeps recording after its last record
+	{
+		QueueJournal again(pathOf("crash").c_str(), 0);
+		CHECK(again.recover(&recovered) && recovered.getString() == "bcdef");
+		CHECK(recovered.enQueueBlock("xy", 2) && recovered.deQueueChar(&c) && again.commit());
+	}
+	QueueArrayBuffer reopened(64, LITTLE_ENDIAN);
+	CHECK(recoverInto("crash", reopened, &consumed));
+	CHECK(reopened.getString() == "cdefxy" && consumed == 2);
+	journal.detach();
+}
+
+//Three committed records, then the last one damaged in the copy: recovery stops at the second
+static void testDamagedTail() {
+	removeFiles("live");
+	QueueArrayBuffer queue(64, LITTLE_ENDIAN);
+	QueueJournal journal(pathOf("live").c_str(), 0);
+	CHECK(journal.recover(&queue));
+	CHECK(queue.enQueueBlock("first-", 6) && journal.commit());
+	char taken[6];
+	CHECK(queue.enQueueBlock("second", 6) && queue.deQueueBlock(taken, 6) && journal.commit());
+	CHECK(queue.enQueueBlock("third!", 6) && journal.commit());
+	crashCopy("live", "crash");
+	string full = readFile(pathOf("crash") + ".journal");
+	long long consumed = -1;
+	//Torn: the record was only partly written
+	for (int cut = 1; cut < 22; cut += 5) {
+		crashCopy("live", "crash");
+		writeFile(pathOf("crash") + ".journal", full.substr(0, full.size() - cut));
+		QueueArrayBuffer recovered(64, LITTLE_ENDIAN);
+		CHECK(recoverInto("crash", recovered, &consumed));
+		CHECK(recovered.getString() == "second" && consumed == 6);
+	}
+	//Corrupted: complete but its CRC does not match
+	crashCopy("live", "crash");
+	string corrupted = full;
+	corrupted[corrupted.size() - 6] ^= 0x20;
+	writeFile(pathOf("crash") + ".journal", corrupted);
+	QueueArrayBuffer recovered(64, LITTLE_ENDIAN);
+	CHECK(recoverInto("crash", recovered, &consumed));
+	CHECK(recovered.getString() == "second" && consumed == 6);
+	//The damaged record is cut off, the next commit follows the second one
+	{
+		QueueJournal again(pathOf("crash").c_str(), 0);
+		CHECK(again.recover(&recovered) && recovered.enQueueBlock("fourth", 6) && again.commit());
+		CHECK(readFile(pathOf("crash") + ".journal").size() == full.size());
+	}
+	QueueArrayBuffer reopened(64, LITTLE_ENDIAN);
+	CHECK(recoverInto("crash", reopened, &consumed));
+	CHECK(reopened.getString() == "secondfourth" && consumed == 6);
+	journal.detach();
+}
+
+//A journal restarted by a later snapshot does not follow an older snapshot: the bytes in between are missing
+static void testJournalNewerThanSnapshot() {
+	removeFiles("live");
+	QueueArrayBuffer queue(64, LITTLE_ENDIAN);
+	QueueJournal journal(pathOf("live").c_str(), 0);
+	CHECK(journal.recover(&queue));
+	CHECK(queue.enQueueBlock("abc", 3) && journal.snapshot());
+	string oldSnapshot = readFile(pathOf("live") + ".snapshot");
+	CHECK(queue.enQueueBlock("def", 3) && journal.snapshot());
+	CHECK(queue.enQueueBlock("ghi", 3) && journal.commit());
+	crashCopy("live", "crash");
+	writeFile(pathOf("crash") + ".snapshot", oldSnapshot);
+	QueueArrayBuffer recovered(64, LITTLE_ENDIAN);
+	long long consumed;
+	CHECK(!recoverInto("crash", recovered, &consumed));
+	journal.detach();
+}
+
+//snapshot() renames the new file, then restarts the journal: a crash in between leaves the new snapshot and the old journal
+static void testCrashBeforeJournalRestart() {
+	removeFiles("live");
+	QueueArrayBuffer queue(64, LITTLE_ENDIAN);
+	QueueJournal journal(pathOf("live").c_str(), 0);
+	CHECK(journal.recover(&queue));
+	CHECK(queue.enQueueBlock("abcdef", 6) && journal.commit());
+	char taken[2];
+	CHECK(queue.deQueueBlock(taken, 2));				//Consumed after the last commit, only the snapshot has it
+	CHECK(queue.enQueueBlock("gh", 2));					//Appended after the last commit, only the snapshot has it
+	string oldJournal = readFile(pathOf("live") + ".journal");
+	CHECK(journal.snapshot());
+	crashCopy("live", "crash");
+	writeFile(pathOf("crash") + ".journal", oldJournal);
+	QueueArrayBuffer recovered(64, LITTLE_ENDIAN);
+	long long consumed = -1;
+	CHECK(recoverInto("crash", recovered, &consumed));
+	CHECK(recovered.getString() == "cdefgh" && consumed == 2);
+	//Same crash with everything committed before the snapshot: the journal ends where the snapshot does
+	CHECK(queue.deQueueBlock(taken, 2) && journal.commit());
+	oldJournal = readFile(pathOf("live") + ".journal");
+	CHECK(journal.snapshot());
+	crashCopy("live", "crash");
+	writeFile(pathOf("crash") + ".journal", oldJournal);
+	QueueArrayBuffer again(64, LITTLE_ENDIAN);
+	CHECK(recoverInto("crash", again, &consumed));
+	CHECK(again.getString() == "efgh" && consumed == 4);
+	journal.detach();
+}
+
+int main() {
+	char temporary[] = "/tmp/QueueJournalTestXXXXXX";
+	if (mkdtemp(temporary) == NULL) {
+		printf("Cannot create a temporary directory\n");
+		return 1;
+	}
+	directory = temporary;
+	testReplayAfterSnapshot();
+	testDamagedTail();
+	testJournalNewerThanSnapshot();
+	testCrashBeforeJournalRestart();
+	removeFiles("live");
+	removeFiles("crash");
+	rmdir(directory.c_str());
+	return testResult("QueueJournalTest");
+}
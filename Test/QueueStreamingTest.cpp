@@ -0,0 +1,147 @@
+//Buffer library by Huynh Hoang Kha
+//Tests of QueueArrayBuffer::readFrom/writeTo on non-blocking pipes and socketpairs (POSIX systems):
+//EAGAIN passed back as -1, 0 at end of file, ENOBUFS on a full queue, transfers split at the wrap point and partial ones
+#include <cerrno>
+#include <cstring>
+#include <string>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include "../Buffer/Buffer.h"
+#include "Check.h"
+using namespace std;
+
+static void setNonBlocking(int fileDescriptor) {
+	fcntl(fileDescriptor, F_SETFL, fcntl(fileDescriptor, F_GETFL) | O_NONBLOCK);
+}
+
+static bool wouldBlock() {
+	return errno == EAGAIN || errno == EWOULDBLOCK;
+}
+
+//Everything the descriptor has ready, it must be non-blocking
+static string drain(int fileDescriptor) {
+	string data;
+	char chunk[65536];
+	ssize_t got;
+	while ((got = read(fileDescriptor, chunk, sizeof(chunk))) > 0) data.append(chunk, got);
+	return data;
+}
+
+static string pattern(int size, int seed) {
+	string data(size, '\0');
+	for (int i = 0; i < size; i++) data[i] = (char)('a' + (i * 7 + seed) % 26);
+	return data;
+}
+
+//An empty queue of 'capacity' bytes whose next byte goes 'tailRoom' bytes before the end of the array
+static void placeTail(QueueArrayBuffer& queue, int capacity, int tailRoom) {
+	string skip(capacity - tailRoom, '-');
+	queue.enQueueBlock(skip.data(), (int)skip.size());
+	queue.discard((int)skip.size());
+}
+
+static void testNothingReady() {
+	int ends[2];
+	CHECK(pipe(ends) == 0);
+	setNonBlocking(ends[0]);
+	setNonBlocking(ends[1]);
+	QueueArrayBuffer queue(16, LITTLE_ENDIAN);
+	errno = 0;
+	CHECK(queue.readFrom(ends[0]) == -1 && wouldBlock());
+	CHECK(queue.isEmpty());
+	//An empty queue has nothing to write, that is not an error
+	CHECK(queue.writeTo(ends[1]) == 0);
+	//End of file once the writer is closed and the data is read
+	CHECK(write(ends[1], "abc", 3) == 3);
+	close(ends[1]);
+	CHECK(queue.readFrom(ends[0]) == 3 && queue.getString() == "abc");
+	CHECK(queue.readFrom(ends[0]) == 0 && queue.getSize() == 3);
+	close(ends[0]);
+}
+
+static void testFullQueue() {
+	int ends[2];
+	CHECK(socketpair(AF_UNIX, SOCK_STREAM, 0, ends) == 0);
+	setNonBlocking(ends[0]);
+	QueueArrayBuffer queue(8, LITTLE_ENDIAN);
+	CHECK(queue.enQueueBlock("01234567", 8));
+	CHECK(write(ends[1], "x", 1) == 1);
+	errno = 0;
+	CHECK(queue.readFrom(ends[0]) == -1 && errno == ENOBUFS);
+	CHECK(queue.getString() == "01234567");
+	close(ends[0]);
+	close(ends[1]);
+}
+
+//readv fills the end of the array then its start, writev sends both parts in order
+static void testSplitAtWrapPoint() {
+	int ends[2];
+	CHECK(socketpair(AF_UNIX, SOCK_STREAM, 0, ends) == 0);
+	setNonBlocking(ends[0]);
+	setNonBlocking(ends[1]);
+	for (int tailRoom = 1; tailRoom < 10; tailRoom++) {
+		QueueArrayBuffer queue(16, LITTLE_ENDIAN);
+		placeTail(queue, 16, tailRoom);
+		string data = pattern(10, tailRoom);
+		CHECK(write(ends[1], data.data(), 10) == 10);
+		CHECK(queue.readFrom(ends[0]) == 10);
+		BufferSegments segments = queue.getSegments();
+		CHECK(segments.first.size == tailRoom && segments.second.size == 10 - tailRoom);
+		CHECK(queue.getString() == data);
+		CHECK(queue.writeTo(ends[0]) == 10 && queue.isEmpty());
+		CHECK(drain(ends[1]) == data);
+	}
+	//More data than free space: only the free bytes are read, on both sides of the wrap point, the rest stays in the socket
+	QueueArrayBuffer queue(16, LITTLE_ENDIAN);
+	placeTail(queue, 16, 12);
+	CHECK(queue.enQueueBlock("ABCDEF", 6));
+	string data = pattern(20, 3);
+	CHECK(write(ends[1], data.data(), 20) == 20);
+	CHECK(queue.readFrom(ends[0]) == 10);
+	CHECK(queue.isFull() && queue.getString() == "ABCDEF" + data.substr(0, 10));
+	errno = 0;
+	CHECK(queue.readFrom(ends[0]) == -1 && errno == ENOBUFS);
+	CHECK(queue.discard(16));
+	CHECK(queue.readFrom(ends[0]) == 10 && queue.getString() == data.substr(10));
+	close(ends[0]);
+	close(ends[1]);
+}
+
+//A wrapped queue bigger than the socket buffer: writev sends part of it, then -1/EAGAIN until the peer reads
+static void testPartialWrite() {
+	int ends[2];
+	CHECK(socketpair(AF_UNIX, SOCK_STREAM, 0, ends) == 0);
+	setNonBlocking(ends[0]);
+	setNonBlocking(ends[1]);
+	const int capacity = 1 << 22;
+	QueueArrayBuffer queue(capacity, LITTLE_ENDIAN);
+	placeTail(queue, capacity, 5000);
+	string data = pattern(capacity - 100, 11);
+	CHECK(queue.enQueueBlock(data.data(), (int)data.size()));
+	int first = queue.writeTo(ends[0]);
+	CHECK(first > 5000 && first < (int)data.size());	//Across the wrap point, not all of it
+	CHECK(queue.getSize() == (int)data.size() - first);
+	int more;
+	while ((more = queue.writeTo(ends[0])) > 0) first += more;
+	CHECK(more == -1 && wouldBlock());
+	string received = drain(ends[1]);
+	CHECK((int)received.size() == first && received == data.substr(0, first));
+	//Alternate until the queue is empty, the peer gets the whole stream in order
+	while (!queue.isEmpty()) {
+		int sent = queue.writeTo(ends[0]);
+		CHECK(sent > 0 || (sent == -1 && wouldBlock()));
+		received += drain(ends[1]);
+	}
+	CHECK(received == data);
+	close(ends[0]);
+	close(ends[1]);
+}
+
+int main() {
+	testNothingReady();
+	testFullQueue();
+	testSplitAtWrapPoint();
+	testPartialWrite();
+	return testResult("QueueStreamingTest");
+}
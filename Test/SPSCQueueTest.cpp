@@ -0,0 +1,81 @@
+//Buffer library by Huynh Hoang Kha
+//Tests of SPSCQueueArrayBuffer: full/empty bounds, values split at the wrap point of a capacity that is not
+//a multiple of their size, and one producer thread against one consumer thread keeping order and count
+#include <cstring>
+#include <thread>
+#include "../Buffer/SPSCQueueBuffer.h"
+#include "Check.h"
+using namespace std;
+
+#define STREAM_VALUES 1000000
+
+static void testBounds() {
+	SPSCQueueArrayBuffer queue(10, LITTLE_ENDIAN);
+	CHECK(queue.isEmpty() && !queue.isFull() && queue.getCapacity() == 10);
+	int i = 0;
+	CHECK(!queue.deQueueInt(&i));
+	CHECK(queue.enQueueInt(1) && queue.enQueueInt(2));
+	CHECK(!queue.enQueueInt(3) && queue.getSize() == 8);	//2 bytes free, all or nothing
+	CHECK(queue.enQueueChar('a') && queue.enQueueChar('b'));
+	CHECK(queue.isFull() && !queue.enQueueChar('c'));
+	char peeked[10];
+	CHECK(queue.peekBlock(peeked, 10) && queue.getSize() == 10);
+	CHECK(!queue.peekBlock(peeked, 11));
+	CHECK(queue.deQueueInt(&i) && i == 1 && !queue.isFull());
+	CHECK(queue.deQueueInt(&i) && i == 2);
+	char c = 0;
+	CHECK(queue.deQueueChar(&c) && c == 'a' && queue.deQueueChar(&c) && c == 'b');
+	CHECK(queue.isEmpty() && !queue.deQueueChar(&c));
+	CHECK(queue.enQueueInt(3));
+	queue.clean();
+	CHECK(queue.isEmpty());
+}
+
+//A capacity of 13 bytes shifts every lap by one byte against 4 and 8 byte values, so they keep landing across the end
+static void testSplitAtWrapPoint() {
+	Endian endians[] = { LITTLE_ENDIAN, BIG_ENDIAN };
+	for (Endian endian : endians) {
+		SPSCQueueArrayBuffer queue(13, endian);
+		for (int round = 0; round < 50; round++) {
+			int i = 0;
+			double d = 0;
+			CHECK(queue.enQueueInt(round * -7919) && queue.enQueueDouble(round * 0.25));
+			CHECK(queue.getSize() == 12);
+			CHECK(queue.deQueueInt(&i) && i == round * -7919);
+			CHECK(queue.deQueueDouble(&d) && d == round * 0.25);
+			char c;
+			CHECK(queue.enQueueChar('x') && queue.deQueueChar(&c) && c == 'x');
+		}
+		CHECK(queue.isEmpty());
+	}
+}
+
+//The producer spins on a full ring and the consumer on an empty one: every long arrives once, in order
+static void testProducerConsumer() {
+	SPSCQueueArrayBuffer queue(61, LITTLE_ENDIAN);
+	thread producer([&queue]() {
+		for (long value = 0; value < STREAM_VALUES; value++) {
+			while (!queue.enQueueLong(value)) this_thread::yield();
+		}
+	});
+	long expected = 0, value;
+	bool ordered = true;
+	while (expected < STREAM_VALUES) {
+		if (!queue.deQueueLong(&value)) {
+			this_thread::yield();
+			continue;
+		}
+		ordered = ordered && value == expected;
+		expected++;
+	}
+	producer.join();
+	CHECK(ordered && expected == STREAM_VALUES);
+	CHECK(queue.isEmpty() && !queue.deQueueLong(&value));
+}
+
+int main() {
+	testBounds();
+	testSplitAtWrapPoint();
+	testProducerConsumer();
+	return testResult("SPSCQueueTest");
+}
@@ -0,0 +1,110 @@
+//Buffer library by Huynh Hoang Kha
+//Tests of the varint and zigzag helpers and of the varint methods of the buffers: sizes at the 7-bit boundaries,
+//the extreme signed values, truncated varints rejected, the reversed stack layout and batched decoding across the wrap point
+#include <cstring>
+#include <string>
+#include <vector>
+#include "../Buffer/Buffer.h"
+#include "Check.h"
+using namespace std;
+
+static bool encodesTo(uint64_t value, const vector<uint8_t>& expected) {
+	uint8_t bytes[VARINT_MAX_BYTES];
+	int size = encodeVarint(value, bytes);
+	uint64_t decoded = 0;
+	return size == (int)expected.size() && varintSize(value) == size && memcmp(bytes, expected.data(), size) == 0
+		&& decodeVarint(bytes, size, &decoded) == size && decoded == value;
+}
+
+static void testEncoding() {
+	CHECK(encodesTo(0, { 0x00 }));
+	CHECK(encodesTo(127, { 0x7F }));
+	CHECK(encodesTo(128, { 0x80, 0x01 }));
+	CHECK(encodesTo(300, { 0xAC, 0x02 }));
+	CHECK(encodesTo(UINT64_MAX, { 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x01 }));
+	CHECK(zigzagEncode(0) == 0 && zigzagEncode(-1) == 1 && zigzagEncode(1) == 2 && zigzagEncode(-2) == 3);
+	CHECK(zigzagEncode(INT64_MAX) == UINT64_MAX - 1 && zigzagEncode(INT64_MIN) == UINT64_MAX);
+	CHECK(zigzagDecode(UINT64_MAX - 1) == INT64_MAX && zigzagDecode(UINT64_MAX) == INT64_MIN);
+	//Truncated: the last byte still has its high bit set. Too long: more than 10 bytes
+	const uint8_t truncated[3] = { 0x80, 0xFF, 0x80 };
+	uint8_t tooLong[11];
+	memset(tooLong, 0x80, 11);
+	uint64_t value;
+	CHECK(decodeVarint(truncated, 3, &value) == 0 && decodeVarint(truncated, 0, &value) == 0);
+	CHECK(decodeVarint(tooLong, 11, &value) == 0);
+}
+
+static void testQueueVarints() {
+	QueueArrayBuffer queue(64, LITTLE_ENDIAN);
+	const uint64_t values[] = { 0, 127, 128, UINT64_MAX, 1ULL << 63, 16383, 16384 };
+	for (uint64_t v : values) CHECK(queue.enQueueVarint(v));
+	CHECK(queue.getSize() == 1 + 1 + 2 + 10 + 10 + 2 + 3);
+	uint64_t value;
+	for (uint64_t v : values) CHECK(queue.deQueueVarint(&value) && value == v);
+	const int64_t signedValues[] = { 0, -1, 1, -64, 64, INT64_MIN, INT64_MAX };
+	for (int64_t v : signedValues) CHECK(queue.enQueueZigzag(v));
+	CHECK(queue.getSize() == 1 + 1 + 1 + 1 + 2 + 10 + 10);
+	int64_t signedValue;
+	for (int64_t v : signedValues) CHECK(queue.deQueueZigzag(&signedValue) && signedValue == v);
+	//A truncated varint stays in the queue until its last byte comes
+	CHECK(queue.enQueueBlock("\x80\x80", 2));
+	CHECK(!queue.deQueueVarint(&value) && queue.getSize() == 2);
+	CHECK(queue.deQueueVarints(&value, 1) == 0 && queue.getSize() == 2);
+	CHECK(queue.enQueueBlock("\x01", 1) && queue.deQueueVarint(&value) && value == 1 << 14 && queue.isEmpty());
+}
+
+//The bytes are pushed in reverse order: the last (most significant) group at the bottom, the first on top
+static void testStackVarints() {
+	StackArrayBuffer stack(64, LITTLE_ENDIAN);
+	CHECK(stack.pushVarint(300));
+	const uint8_t reversed[2] = { 0x02, 0xAC };
+	CHECK(stack.getSize() == 2 && memcmp(stack.getData().data, reversed, 2) == 0);
+	const uint64_t values[] = { 0, 127, 128, UINT64_MAX, 16384 };
+	for (uint64_t v : values) CHECK(stack.pushVarint(v));
+	CHECK(stack.pushZigzag(INT64_MIN) && stack.pushZigzag(INT64_MAX) && stack.pushZigzag(-1));
+	int64_t signedValue;
+	CHECK(stack.topZigzag(&signedValue) && signedValue == -1);
+	CHECK(stack.popZigzag(&signedValue) && signedValue == -1);
+	CHECK(stack.popZigzag(&signedValue) && signedValue == INT64_MAX);
+	CHECK(stack.popZigzag(&signedValue) && signedValue == INT64_MIN);
+	uint64_t value;
+	for (int i = 4; i >= 0; i--) CHECK(stack.popVarint(&value) && value == values[i]);
+	CHECK(stack.popVarint(&value) && value == 300 && stack.isEmpty());
+	CHECK(!stack.popVarint(&value));
+	//A top byte with the high bit set and nothing under it is not a varint
+	CHECK(stack.pushChar((char)0x80));
+	CHECK(!stack.topVarint(&value) && !stack.popVarint(&value) && stack.getSize() == 1);
+}
+
+//Runs of 1-byte varints (the 8 at a time path) and longer ones, starting at every position before the end of the ring
+static void testBatchAcrossEnd() {
+	vector<uint64_t> values;
+	for (int i = 0; i < 12; i++) values.push_back(i);
+	values.push_back(300);
+	values.push_back(UINT64_MAX);
+	for (int i = 0; i < 9; i++) values.push_back(100 + i);
+	values.push_back(1ULL << 40);
+	int bytes = 0;
+	for (uint64_t v : values) bytes += varintSize(v);
+	for (int start = 1; start <= bytes; start++) {
+		QueueArrayBuffer queue(64, LITTLE_ENDIAN);
+		string skip(64 - start, '-');
+		queue.enQueueBlock(skip.data(), (int)skip.size());
+		queue.discard((int)skip.size());
+		for (uint64_t v : values) queue.enQueueVarint(v);
+		CHECK(queue.getSize() == bytes);
+		uint64_t output[64];
+		int first = queue.deQueueVarints(output, 5);
+		int rest = queue.deQueueVarints(output + first, 64);
+		CHECK(first == 5 && first + rest == (int)values.size() && queue.isEmpty());
+		CHECK(memcmp(output, values.data(), values.size() * sizeof(uint64_t)) == 0);
+	}
+}
+
+int main() {
+	testEncoding();
+	testQueueVarints();
+	testStackVarints();
+	testBatchAcrossEnd();
+	return testResult("VarintTest");
+}
@@ -0,0 +1,123 @@
+//Buffer library by Huynh Hoang Kha
+//Tests of WorkStealingStackBuffer and TaskScheduler: the owner pushing and popping against several thieves
+//on a ring that keeps growing, every item taken exactly once, items of another size blocking both ends,
+//and every spawned task run once whether it comes from outside the pool or from another task
+#include <atomic>
+#include <thread>
+#include <vector>
+#include "../Buffer/WorkStealingBuffer.h"
+#include "Check.h"
+using namespace std;
+
+#define STRESS_ITEMS 2000000
+#define STRESS_THIEVES 3
+
+static void testGrowth() {
+	WorkStealingStackBuffer stack(2, LITTLE_ENDIAN);
+	CHECK(stack.getCapacity() == 2);
+	for (int i = 0; i < 1000; i++) CHECK(stack.pushInt(i));
+	CHECK(stack.getCapacity() == 1024 && stack.getSize() == 1000);
+	int value = -1;
+	CHECK(stack.stealInt(&value) && value == 0);	//Thieves get the oldest
+	CHECK(stack.popInt(&value) && value == 999);	//The owner gets the newest
+	CHECK(stack.top<int>() == 998 && stack.getSize() == 998);
+}
+
+//An item is only taken with its own size, from either end
+static void testSizeMismatch() {
+	WorkStealingStackBuffer stack(4, LITTLE_ENDIAN);
+	CHECK(stack.pushChar('a'));		//Oldest: the thieves' end
+	CHECK(stack.pushInt(5));		//Newest: the owner's end
+	char c = 0;
+	int i = 0;
+	CHECK(!stack.popChar(&c) && !stack.stealInt(&i) && stack.getSize() == 2);
+	CHECK(stack.stealChar(&c) && c == 'a');
+	CHECK(stack.popInt(&i) && i == 5);
+	//The last item, seen from both ends
+	CHECK(stack.pushDouble(0.5));
+	double d = 0;
+	CHECK(!stack.stealInt(&i) && !stack.popInt(&i) && stack.getSize() == 1);
+	CHECK(stack.stealDouble(&d) && d == 0.5 && stack.isEmpty());
+	CHECK(!stack.popDouble(&d) && !stack.stealDouble(&d));
+}
+
+//The owner pushes in bursts from a small ring and pops some back while the thieves steal, every item comes out once
+static void testOwnerAgainstThieves() {
+	WorkStealingStackBuffer stack(4, LITTLE_ENDIAN);
+	atomic<bool> pushing(true);
+	vector<vector<int>> taken(STRESS_THIEVES + 1);
+	vector<thread> thieves;
+	for (int t = 1; t <= STRESS_THIEVES; t++) {
+		thieves.emplace_back([&stack, &pushing, &taken, t]() {
+			int value;
+			while (pushing.load(memory_order_acquire) || !stack.isEmpty()) {
+				if (stack.stealInt(&value)) taken[t].push_back(value);
+			}
+		});
+	}
+	unsigned seed = 12345;
+	int value;
+	for (int next = 0; next < STRESS_ITEMS;) {
+		seed = seed * 1103515245 + 12345;
+		int burst = 1 + (int)((seed >> 16) % 64);
+		for (int k = 0; k < burst && next < STRESS_ITEMS; k++) stack.pushInt(next++);
+		for (int k = 0; k < burst / 2; k++) if (stack.popInt(&value)) taken[0].push_back(value);
+	}
+	while (!stack.isEmpty()) if (stack.popInt(&value)) taken[0].push_back(value);
+	pushing.store(false, memory_order_release);
+	for (thread& thief : thieves) thief.join();
+	vector<int> count(STRESS_ITEMS, 0);
+	long long total = 0, stolen = 0;
+	for (int t = 0; t <= STRESS_THIEVES; t++) {
+		for (int item : taken[t]) count[item]++;
+		total += taken[t].size();
+		if (t > 0) stolen += taken[t].size();
+	}
+	bool once = true;
+	for (int c : count) once = once && c == 1;
+	CHECK(once && total == STRESS_ITEMS);
+	CHECK(stolen > 0 && stack.getCapacity() > 4);
+}
+
+//Tasks spawned from outside the pool, each splitting into two until it counts 1
+static void testScheduler() {
+	atomic<long long> sum(0), leaves(0);
+	TaskScheduler* scheduler = NULL;
+	TaskScheduler pool([&](long task) {
+		if (task >= 0) {
+			sum.fetch_add(task, memory_order_relaxed);
+			return;
+		}
+		//A negative task -n splits n leaves between two child tasks spawned on the current worker
+		long n = -task;
+		if (n == 1) {
+			leaves.fetch_add(1, memory_order_relaxed);
+			return;
+		}
+		scheduler->spawn(-(n / 2));
+		scheduler->spawn(-(n - n / 2));
+	}, 4);
+	scheduler = &pool;
+	for (long task = 0; task <= 10000; task++) pool.spawn(task);
+	pool.spawn(-100000);
+	pool.wait();
+	CHECK(sum.load() == 10000LL * 10001 / 2);
+	CHECK(leaves.load() == 100000);
+	long long executed = 0;
+	for (int i = 0; i < pool.getWorkerCount(); i++) executed += pool.getExecutedTasks(i);
+	CHECK(executed == 10001 + 2 * 100000 - 1);
+	CHECK(pool.getCurrentWorker() == -1);
+	//The pool can be reused after wait()
+	sum.store(0);
+	for (long task = 1; task <= 100; task++) pool.spawn(task);
+	pool.wait();
+	CHECK(sum.load() == 5050);
+}
+
+int main() {
+	testGrowth();
+	testSizeMismatch();
+	testOwnerAgainstThieves();
+	testScheduler();
+	return testResult("WorkStealingTest");
+}